@@ -0,0 +1,500 @@
+/*
+ * benchXrds.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Benchmark driver for xrds2gps functions; NOT part of xrds2gps. Linked with
+ * all xrds2gps objects except xrds2gps.o - we define the globals here.
+ * Run against mockOverpass, see "make bench" in makefile.
+ *
+ * For each pair count a synthetic input file is written, then each mode runs
+ * in its own child process - so peak RSS is per run:
+ *   input  : read input file with mapped line iterator into XRDS_BATCH
+ *   parse  : parseCurlXrdsData() on canned response, one per pair
+ *   serial : getXrdsGps() one query at a time, one easy handle
+ *   multi  : curlGetXrdsDL() with jobs queries in flight
+ *   batch  : batchGetXrdsDL() one query for all pairs
+ *   streets: streetGetXrdsDL() street node ids then common nodes coordinates
+ *   grid   : gridGetXrdsDL() one query for each side of the pairs
+ *   crossings: crossingsGetXrdsDL() all crossings of each first street
+ * Reported: seconds, pairs per second, p50 / p99 latency where each pair is
+ * timed on its own (parse, serial) and peak RSS.
+ *
+ * usage: benchXrds [-u url] [-n count[,count...]] [-j jobs] [-s rows]
+ *                  [-m mode[,mode...]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <math.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <curl/curl.h>
+
+#include "overpass-c.h"
+#include "op_string.h"
+#include "fileio.h"
+#include "curl_func.h"
+#include "resolve.h"
+#include "streetQuery.h"
+#include "util.h"
+#include "ztError.h"
+
+// globals xrds2gps.c defines
+const char *prog_name = "benchXrds";
+FILE *rawDataFP = NULL;
+
+#define BENCH_URL "http://127.0.0.1:8089/api/interpreter"
+#define BENCH_COUNTS "10,100,1000,10000"
+#define BENCH_MODES "input,parse,serial,multi,batch,streets,grid,crossings"
+#define BENCH_BBOX "33.444272,-112.076683,33.5582762,-112.0433807"
+
+typedef struct BENCH_RESULT_ {
+
+	int		status;		// ztSuccess or error from run
+	int		pairs;
+	double	seconds;
+	double	p50, p99;	// milliseconds, negative when not timed per pair
+	long		peakRSS;	// kilobytes
+
+} BENCH_RESULT;
+
+static double nowSeconds (void){
+
+	struct timespec	ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmpDouble (const void *a, const void *b){
+
+	double	x = *(const double *) a, y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+/* percentiles(): sets p50 and p99 in milliseconds from seconds array */
+static void percentiles (BENCH_RESULT *res, double *times, int num){
+
+	if (num < 1)
+
+		return;
+
+	qsort (times, num, sizeof(double), cmpDouble);
+
+	res->p50 = times[(num - 1) / 2] * 1000.0;
+	res->p99 = times[(int) ceil (num * 0.99) - 1] * 1000.0;
+}
+
+/* writeInput(): writes synthetic input file with num pairs; streets are
+ * taken from a square grid so batch query has few distinct names.
+ * Returns file name - caller frees - or NULL.
+ ************************************************************************/
+static char *writeInput (int num){
+
+	char		*name = strdup ("/tmp/benchXrds.XXXXXX");
+	FILE		*filePtr;
+	int		fd;
+	int		width = (int) ceil (sqrt (num));
+	int		iCount;
+
+	fd = mkstemp (name);
+	if (fd < 0 || ! (filePtr = fdopen (fd, "w"))){
+		perror ("writeInput()");
+		free (name);
+		return NULL;
+	}
+
+	fprintf (filePtr, "# benchXrds synthetic input, %d pairs\n%s\n\n", num, BENCH_BBOX);
+
+	for (iCount = 0; iCount < num; iCount++)
+
+		fprintf (filePtr, "North %d Street, East %d Road\n",
+				    iCount % width, iCount / width);
+
+	fclose (filePtr);
+
+	return name;
+}
+
+/* loadInput(): reads input file into batch and list, as xrds2gps does */
+static int loadInput (DL_LIST *xrdsDL, XRDS_BATCH **batch, BBOX *bbox, char *filename){
+
+	MAPPED_FILE	mapped;
+	LINE_VIEW	view;
+	XROADS		*xrds;
+	int			numLines;
+	int			result;
+
+	result = openMappedFile (&mapped, filename);
+	if (result != ztSuccess)
+
+		return result;
+
+	if ( ! nextLineView (&mapped, &view) || parseBboxView (bbox, &view) != ztSuccess){
+		closeMappedFile (&mapped);
+		return ztMissFormatFile;
+	}
+
+	numLines = mappedLineCount (&mapped);
+	*batch = initialXrdsBatch (numLines, mapped.size + 2 * numLines);
+	if ( ! *batch ){
+		closeMappedFile (&mapped);
+		return ztMemoryAllocate;
+	}
+
+	while (nextLineView (&mapped, &view)){
+
+		result = xrdsParseView (&xrds, *batch, &view);
+		if (result == ztSuccess)
+			result = insertNextDL (xrdsDL, DL_TAIL(xrdsDL), xrds);
+
+		if (result != ztSuccess)
+			break;
+	}
+
+	closeMappedFile (&mapped);
+
+	return result;
+}
+
+/* cannedAnswer(): response like mockOverpass sends for one pair */
+static int cannedAnswer (MEMORY_STRUCT *mem, int rows){
+
+	char		line[64];
+	int		iCount;
+	int		result;
+
+	result = initialMemory (mem, 0);
+	if (result != ztSuccess)
+
+		return result;
+
+	appendMemory (mem, "@lat\t@lon\t@count\n", 17);
+
+	for (iCount = 0; iCount < rows; iCount++){
+
+		snprintf (line, sizeof(line), "33.5%05d\t-112.07%04d\t\n", iCount, iCount);
+		appendMemory (mem, line, strlen (line));
+	}
+
+	snprintf (line, sizeof(line), "\t\t%d\n", rows);
+
+	return appendMemory (mem, line, strlen (line));
+}
+
+/* benchCrossings(): crossingsGetXrdsDL() for distinct first streets of the
+ * pairs in xrdsDL; crossings found are dropped. */
+static int benchCrossings (DL_LIST *xrdsDL, BBOX *bbox, CURLU *url){
+
+	DL_LIST		crossDL;
+	DL_ELEM		*elem;
+	XRDS_BATCH	*crossBatch = NULL;
+	char			**streets;
+	int			numStreets = 0;
+	int			iCount;
+	int			result;
+
+	streets = (char **) malloc (sizeof(char *) * DL_SIZE(xrdsDL));
+	if ( ! streets )
+
+		return ztMemoryAllocate;
+
+	for (elem = DL_HEAD(xrdsDL); elem; elem = DL_NEXT(elem)){
+
+		for (iCount = 0; iCount < numStreets; iCount++)
+
+			if (strcmp (streets[iCount], ((XROADS *) DL_DATA(elem))->firstRD) == 0)
+
+				break;
+
+		if (iCount == numStreets)
+			streets[numStreets++] = ((XROADS *) DL_DATA(elem))->firstRD;
+	}
+
+	initialDL (&crossDL, NULL, NULL);
+
+	result = crossingsGetXrdsDL (&crossBatch, &crossDL, streets, numStreets, bbox, url);
+
+	destroyDL (&crossDL);
+	if (crossBatch)
+		zapXrdsBatch ((void **) &crossBatch);
+
+	free (streets);
+
+	return result;
+}
+
+/* runMode(): runs one mode over the pairs in input file, fills res */
+static void runMode (BENCH_RESULT *res, char *mode, char *filename,
+		                       char *urlStr, int jobs, int rows){
+
+	DL_LIST			xrdsDL;
+	DL_ELEM			*elem;
+	XRDS_BATCH		*batch = NULL;
+	BBOX				bbox;
+	CURLU			*url = NULL;
+	CURL				*handle;
+	MEMORY_STRUCT	canned;
+	double			*times = NULL;
+	double			start, t0;
+	int				num = 0;
+	struct rusage	usage;
+	STREET_CACHE		streets;
+	QUERY_SCHEDULE	schedule;
+
+	memset (res, 0, sizeof(BENCH_RESULT));
+	res->p50 = res->p99 = -1.0;
+
+	initialDL (&xrdsDL, NULL, NULL);
+
+	start = nowSeconds ();
+
+	res->status = loadInput (&xrdsDL, &batch, &bbox, filename);
+	res->pairs = DL_SIZE(&xrdsDL);
+
+	if (res->status != ztSuccess || strcmp (mode, "input") == 0)
+
+		goto done;
+
+	times = (double *) malloc (sizeof(double) * (res->pairs + 1));
+
+	if (strcmp (mode, "parse") == 0){
+
+		res->status = cannedAnswer (&canned, rows);
+
+		start = nowSeconds ();
+
+		for (elem = DL_HEAD(&xrdsDL); elem && res->status == ztSuccess; elem = DL_NEXT(elem)){
+
+			t0 = nowSeconds ();
+			res->status = parseCurlXrdsData ((XROADS *) DL_DATA(elem), &canned);
+			times[num++] = nowSeconds () - t0;
+		}
+
+		zapMemory (&canned);
+		goto done;
+	}
+
+	res->status = initialSession ();
+	if (res->status != ztSuccess)
+
+		goto done;
+
+	url = curl_url ();
+	if ( ! url || curl_url_set (url, CURLUPART_URL, urlStr, 0) != CURLUE_OK){
+		res->status = ztInvalidArg;
+		goto done;
+	}
+
+	start = nowSeconds ();
+
+	if (strcmp (mode, "serial") == 0){
+
+		handle = initialQuery (url);
+		if ( ! handle ){
+			res->status = ztGotNull;
+			goto done;
+		}
+
+		for (elem = DL_HEAD(&xrdsDL); elem && res->status == ztSuccess; elem = DL_NEXT(elem)){
+
+			t0 = nowSeconds ();
+			res->status = getXrdsGps ((XROADS *) DL_DATA(elem), &bbox, url, handle);
+			times[num++] = nowSeconds () - t0;
+		}
+
+		closeQuery (handle);
+	}
+
+	else if (strcmp (mode, "multi") == 0){
+
+		schedule.jobs = jobs;
+		schedule.rate = 0.0;
+		schedule.pool = NULL;
+		schedule.hedge = 0;
+		schedule.deadline = 0.0;
+		schedule.adaptive = 0;
+		res->status = curlGetXrdsDL (&xrdsDL, &bbox, url, &schedule, NULL, NULL);
+	}
+
+	else if (strcmp (mode, "batch") == 0)
+
+		res->status = batchGetXrdsDL (&xrdsDL, &bbox, url, NULL, NULL);
+
+	else if (strcmp (mode, "streets") == 0){
+
+		initialStreetCache (&streets);
+		res->status = streetGetXrdsDL (&xrdsDL, &bbox, url, &streets, NULL, NULL);
+		zapStreetCache (&streets);
+	}
+
+	else if (strcmp (mode, "grid") == 0)
+
+		res->status = gridGetXrdsDL (&xrdsDL, &bbox, url, NULL, NULL);
+
+	else if (strcmp (mode, "crossings") == 0)
+
+		res->status = benchCrossings (&xrdsDL, &bbox, url);
+
+	else
+
+		res->status = ztInvalidArg;
+
+done:
+
+	res->seconds = nowSeconds () - start;
+
+	percentiles (res, times, num);
+
+	getrusage (RUSAGE_SELF, &usage);
+	res->peakRSS = usage.ru_maxrss;
+
+	if (url)
+		curl_url_cleanup (url);
+
+	if (times)
+		free (times);
+
+	destroyDL (&xrdsDL);
+	if (batch)
+		zapXrdsBatch ((void **) &batch);
+
+	return;
+}
+
+/* forkMode(): runs mode in child process, its output goes to /dev/null */
+static int forkMode (BENCH_RESULT *res, char *mode, char *filename,
+		                       char *urlStr, int jobs, int rows){
+
+	int		fds[2];
+	pid_t	pid;
+	int		devNull;
+	ssize_t	got;
+
+	if (pipe (fds) != 0)
+
+		return ztFatalError;
+
+	fflush (stdout);
+
+	pid = fork ();
+	if (pid < 0)
+
+		return ztFatalError;
+
+	if (pid == 0){
+
+		close (fds[0]);
+
+		devNull = open ("/dev/null", O_WRONLY);
+		dup2 (devNull, STDOUT_FILENO);
+		dup2 (devNull, STDERR_FILENO);
+
+		runMode (res, mode, filename, urlStr, jobs, rows);
+
+		got = write (fds[1], res, sizeof(BENCH_RESULT));
+		_exit (got == sizeof(BENCH_RESULT) ? 0 : 1);
+	}
+
+	close (fds[1]);
+	got = read (fds[0], res, sizeof(BENCH_RESULT));
+	close (fds[0]);
+	waitpid (pid, NULL, 0);
+
+	return (got == sizeof(BENCH_RESULT)) ? ztSuccess : ztFatalError;
+}
+
+int main (int argc, char *argv[]){
+
+	char				*urlStr = BENCH_URL;
+	char				*counts = strdup (BENCH_COUNTS);
+	char				*modes = strdup (BENCH_MODES);
+	int				jobs = 8;
+	int				rows = 2;
+	int				opt;
+	char				*countPtr, *modePtr;
+	char				*countSave, *modeSave;
+	char				*modeList;
+	char				*filename;
+	char				p50[16], p99[16];
+	int				num;
+	BENCH_RESULT		res;
+
+	while ((opt = getopt (argc, argv, "u:n:j:s:m:")) != -1){
+
+		switch (opt){
+
+		case 'u': urlStr = optarg; break;
+		case 'n': free (counts); counts = strdup (optarg); break;
+		case 'j': jobs = atoi (optarg); break;
+		case 's': rows = atoi (optarg); break;
+		case 'm': free (modes); modes = strdup (optarg); break;
+		default:
+			fprintf (stderr, "usage: %s [-u url] [-n count[,count...]] [-j jobs] "
+					    "[-s rows] [-m mode[,mode...]]\n", argv[0]);
+			return ztInvalidUsage;
+		}
+	}
+
+	printf ("server: %s  jobs: %d  rows: %d\n\n", urlStr, jobs, rows);
+	printf ("%-9s %8s %10s %12s %9s %9s %10s\n",
+			  "mode", "pairs", "seconds", "pairs/sec", "p50 ms", "p99 ms", "peak KB");
+
+	for (countPtr = strtok_r (counts, ",", &countSave); countPtr;
+		 countPtr = strtok_r (NULL, ",", &countSave)){
+
+		num = atoi (countPtr);
+		if (num < 1)
+
+			continue;
+
+		filename = writeInput (num);
+		if ( ! filename )
+
+			return ztCreateFileErr;
+
+		modeList = strdup (modes);
+
+		for (modePtr = strtok_r (modeList, ",", &modeSave); modePtr;
+			 modePtr = strtok_r (NULL, ",", &modeSave)){
+
+			if (forkMode (&res, modePtr, filename, urlStr, jobs, rows) != ztSuccess){
+				printf ("%-9s %8d  failed to run\n", modePtr, num);
+				continue;
+			}
+
+			if (res.status != ztSuccess){
+				printf ("%-9s %8d  error: %s\n", modePtr, num, code2Msg (res.status));
+				continue;
+			}
+
+			strcpy (p50, "-");
+			strcpy (p99, "-");
+			if (res.p50 >= 0){
+				snprintf (p50, sizeof(p50), "%.3f", res.p50);
+				snprintf (p99, sizeof(p99), "%.3f", res.p99);
+			}
+
+			printf ("%-9s %8d %10.3f %12.0f %9s %9s %10ld\n", modePtr, res.pairs,
+					  res.seconds, res.seconds > 0 ? res.pairs / res.seconds : 0.0,
+					  p50, p99, res.peakRSS);
+		}
+
+		free (modeList);
+		unlink (filename);
+		free (filename);
+	}
+
+	free (counts);
+	free (modes);
+
+	return ztSuccess;
+}
@@ -0,0 +1,490 @@
+/*
+ * mockOverpass.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Stand in Overpass server for benchmarks; NOT part of xrds2gps.
+ * Answers every POST with canned CSV in the "@lat @lon @count" format our
+ * cross roads query asks for: rows of nodes then a count row, one group per
+ * "out count" in the query - so batch queries work too. Street node ids
+ * queries ("out ids") get rows of ids - every street has the same ids, so
+ * all pairs cross - grid queries ("node(w);out;") get the same ids with
+ * coordinates, node coordinates queries ("node(id:...)") get a row for
+ * each id asked and crossings queries ("foreach") get rows crossing ways
+ * with one shared node each. Street names queries ("out:csv(name)") get
+ * names in example input file and in benchXrds synthetic input. GET answers with an /api/status like text. One thread
+ * per connection, keep alive.
+ * With a rate limit, queries over that many in flight get HTTP 429 and the
+ * status page shows the slots free now; with -g latency grows with load as
+ * on an overloaded server.
+ *
+ * usage: mockOverpass [-p port] [-l latencyMs] [-s rows] [-r rateLimit] [-g]
+ *   -p port to listen on, default 8089 on 127.0.0.1
+ *   -l latency added to each answer in milliseconds, default 0
+ *   -s node rows per answer group - response size - default 2
+ *   -r query slots, reported by status page, default 0 (no limit)
+ *   -g latency is multiplied by queries in flight
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define MOCK_PORT 8089
+#define REQUEST_MAX (16 * 1024 * 1024)
+
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+static int	latencyMs = 0;
+static int	numRows = 2;
+static int	rateLimit = 0;
+static int	growLatency = 0;
+static int	inFlight = 0;
+
+static pthread_mutex_t	slotsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char	*csvHeader = "@lat\t@lon\t@count\n";
+static const char	*busyAnswer = "Rate limit reached; too many queries in flight.\n";
+
+/* sendAll(): writes whole buffer to socket, returns 0 or -1 */
+static int sendAll (int sock, const char *buf, size_t len){
+
+	ssize_t	sent;
+
+	while (len){
+
+		sent = send (sock, buf, len, MSG_NOSIGNAL);
+		if (sent <= 0)
+
+			return -1;
+
+		buf += sent;
+		len -= sent;
+	}
+
+	return 0;
+}
+
+/* countGroups(): number of "out count" statements in query, at least one */
+static int countGroups (const char *query){
+
+	const char	*ptr = query;
+	int			count = 0;
+
+	while ((ptr = strstr (ptr, "out count"))){
+		count++;
+		ptr++;
+	}
+
+	return count ? count : 1;
+}
+
+/* csvAnswer(): builds answer body for query, caller frees */
+static char *csvAnswer (const char *query, size_t *length){
+
+	int		groups = countGroups (query);
+	size_t	size = strlen (csvHeader) + (size_t) groups * (numRows * 32 + 16) + 1;
+	char		*body;
+	char		*ptr;
+	int		group, row;
+
+	body = (char *) malloc (size);
+	if ( ! body )
+
+		return NULL;
+
+	ptr = body;
+	ptr += sprintf (ptr, "%s", csvHeader);
+
+	for (group = 0; group < groups; group++){
+
+		for (row = 0; row < numRows; row++)
+
+			ptr += sprintf (ptr, "33.5%05d\t-112.07%04d\t\n",
+					                (group * 10 + row) % 100000, row % 10000);
+
+		ptr += sprintf (ptr, "\t\t%d\n", numRows);
+	}
+
+	*length = ptr - body;
+
+	return body;
+}
+
+/* idsAnswer(): answer body for street node ids query - with coordinates
+ * for grid query when withGps is set - caller frees */
+static char *idsAnswer (const char *query, size_t *length, int withGps){
+
+	int		groups = countGroups (query);
+	size_t	size = 32 + (size_t) groups * (numRows * 48 + 16) + 1;
+	char		*body;
+	char		*ptr;
+	int		group, row;
+
+	body = (char *) malloc (size);
+	if ( ! body )
+
+		return NULL;
+
+	ptr = body;
+	ptr += sprintf (ptr, withGps ? "@id\t@lat\t@lon\t@count\n" : "@id\t@count\n");
+
+	for (group = 0; group < groups; group++){
+
+		for (row = 0; row < numRows; row++)
+
+			if (withGps)
+				ptr += sprintf (ptr, "%d\t33.5%05d\t-112.07%04d\t\n",
+						           1000 + row, (1000 + row) % 100000, (1000 + row) % 10000);
+			else
+				ptr += sprintf (ptr, "%d\t\n", 1000 + row);
+
+		ptr += sprintf (ptr, withGps ? "\t\t\t%d\n" : "\t%d\n", numRows);
+	}
+
+	*length = ptr - body;
+
+	return body;
+}
+
+/* crossingsAnswer(): answer body for street crossings query, caller frees */
+static char *crossingsAnswer (const char *query, size_t *length){
+
+	int		groups = countGroups (query);
+	size_t	size = 64 + (size_t) groups * (numRows * 96 + 32) + 1;
+	char		*body;
+	char		*ptr;
+	int		group, row;
+
+	body = (char *) malloc (size);
+	if ( ! body )
+
+		return NULL;
+
+	ptr = body;
+	ptr += sprintf (ptr, "@type\t@id\tname\t@lat\t@lon\t@count\n");
+
+	for (group = 0; group < groups; group++){
+
+		for (row = 0; row < numRows; row++){
+
+			ptr += sprintf (ptr, "way\t%d\tCross Street %d\t\t\t\n", 2000 + row, row);
+			ptr += sprintf (ptr, "node\t%d\t\t33.5%05d\t-112.07%04d\t\n",
+					           1000 + row, (group * 10 + row) % 100000, row % 10000);
+		}
+
+		ptr += sprintf (ptr, "count\t\t\t\t\t1\n");
+	}
+
+	*length = ptr - body;
+
+	return body;
+}
+
+/* street names in example input file "xrds2gps.infile" */
+static const char	*exampleNames[] = {
+		"North Central Avenue", "North 7Th Street", "North 16Th Street",
+		"East Butler Drive", "East Northern Avenue", "East Orangewood Avenue",
+		"East Glendale Avenue", "East Maryland Avenue", "East Glenn Drive", NULL};
+
+/* synthetic input uses "North n Street" and "East n Road" below this */
+#define MOCK_GRID_NAMES 1000
+
+/* namesAnswer(): answer body for street names query, caller frees; each
+ * name is given twice as for a street made of two ways */
+static char *namesAnswer (size_t *length){
+
+	size_t	size = 8 + 2 * (MOCK_GRID_NAMES * 2 * 32 + 10 * 32);
+	char		*body;
+	char		*ptr;
+	int		iCount, copy;
+
+	body = (char *) malloc (size);
+	if ( ! body )
+
+		return NULL;
+
+	ptr = body;
+	ptr += sprintf (ptr, "name\n");
+
+	for (copy = 0; copy < 2; copy++){
+
+		for (iCount = 0; exampleNames[iCount]; iCount++)
+			ptr += sprintf (ptr, "%s\n", exampleNames[iCount]);
+
+		for (iCount = 0; iCount < MOCK_GRID_NAMES; iCount++)
+			ptr += sprintf (ptr, "North %d Street\nEast %d Road\n", iCount, iCount);
+	}
+
+	*length = ptr - body;
+
+	return body;
+}
+
+/* nodesAnswer(): answer body for node coordinates query, caller frees */
+static char *nodesAnswer (const char *query, size_t *length){
+
+	const char	*ptr = strstr (query, "node(id:") + 8;
+	const char	*comma;
+	size_t		size = 32;
+	char			*body;
+	char			*out;
+	long long	id;
+
+	for (comma = ptr; (comma = strchr (comma, ',')); comma++)
+		size += 48;
+
+	body = (char *) malloc (size + 48);
+	if ( ! body )
+
+		return NULL;
+
+	out = body;
+	out += sprintf (out, "@id\t@lat\t@lon\n");
+
+	while (*ptr >= '0' && *ptr <= '9'){
+
+		id = strtoll (ptr, (char **) &ptr, 10);
+		out += sprintf (out, "%lld\t33.5%05lld\t-112.07%04lld\n",
+				           id, id % 100000, id % 10000);
+
+		if (*ptr == ',')
+			ptr++;
+	}
+
+	*length = out - body;
+
+	return body;
+}
+
+/* headerValue(): returns integer value of header name in request head, or -1 */
+static long headerValue (const char *head, const char *name){
+
+	const char	*ptr = head;
+	size_t		nameLen = strlen (name);
+
+	while ((ptr = strchr (ptr, '\n'))){
+
+		ptr++;
+		if (strncasecmp (ptr, name, nameLen) == 0 && ptr[nameLen] == ':')
+
+			return strtol (ptr + nameLen + 1, NULL, 10);
+	}
+
+	return -1;
+}
+
+/* serveConnection(): thread function, answers requests until peer closes */
+static void *serveConnection (void *arg){
+
+	int		sock = (int) (long) arg;
+	char		*buf;
+	size_t	have = 0;
+	char		*headEnd;
+	size_t	headLen, bodyLen;
+	long		contentLength;
+	ssize_t	got;
+	char		status[256];
+	char		reply[512];
+	char		*body;
+	size_t	length;
+	int		isGet;
+	int		busy, load;
+	long		delayMs;
+
+	buf = (char *) malloc (REQUEST_MAX + 1);
+	if ( ! buf ){
+		close (sock);
+		return NULL;
+	}
+
+	while (1){
+
+		/* read request head */
+		while ( ! (buf[have] = '\0', headEnd = strstr (buf, "\r\n\r\n")) ){
+
+			if (have == REQUEST_MAX)
+
+				goto done;
+
+			got = recv (sock, buf + have, REQUEST_MAX - have, 0);
+			if (got <= 0)
+
+				goto done;
+
+			have += got;
+		}
+
+		headLen = headEnd + 4 - buf;
+		isGet = (strncmp (buf, "GET ", 4) == 0);
+		contentLength = headerValue (buf, "Content-Length");
+		bodyLen = contentLength > 0 ? (size_t) contentLength : 0;
+
+		if (headLen + bodyLen > REQUEST_MAX)
+
+			goto done;
+
+		/* read request body */
+		while (have < headLen + bodyLen){
+
+			got = recv (sock, buf + have, REQUEST_MAX - have, 0);
+			if (got <= 0)
+
+				goto done;
+
+			have += got;
+		}
+
+		/* take a query slot; over rate limit is busy */
+		pthread_mutex_lock (&slotsLock);
+		busy = ! isGet && rateLimit && inFlight >= rateLimit;
+		if ( ! isGet && ! busy )
+			inFlight++;
+		load = inFlight;
+		pthread_mutex_unlock (&slotsLock);
+
+		delayMs = growLatency && ! isGet ? (long) latencyMs * load : latencyMs;
+
+		if (delayMs && ! busy){
+
+			struct timespec	ts = {delayMs / 1000, (delayMs % 1000) * 1000000L};
+			nanosleep (&ts, NULL);
+		}
+
+		if (isGet){
+
+			length = snprintf (status, sizeof(status),
+					                  "Connected as: 1\nCurrent time: now\n"
+					                  "Rate limit: %d\n%d slots available now.\n",
+					                  rateLimit, rateLimit ? MAX(rateLimit - load, 0) : 0);
+			body = status;
+		}
+		else if (busy){
+
+			length = strlen (busyAnswer);
+			body = (char *) busyAnswer;
+		}
+		else {
+
+			buf[headLen + bodyLen] = '\0';
+
+			if (strstr (buf + headLen, "out:csv(name)"))
+				body = namesAnswer (&length);
+			else if (strstr (buf + headLen, "foreach"))
+				body = crossingsAnswer (buf + headLen, &length);
+			else if (strstr (buf + headLen, "node(id:"))
+				body = nodesAnswer (buf + headLen, &length);
+			else if (strstr (buf + headLen, "out ids"))
+				body = idsAnswer (buf + headLen, &length, 0);
+			else if (strstr (buf + headLen, "node(w);out;"))
+				body = idsAnswer (buf + headLen, &length, 1);
+			else
+				body = csvAnswer (buf + headLen, &length);
+			/* slot is free once answer is made */
+			pthread_mutex_lock (&slotsLock);
+			inFlight--;
+			pthread_mutex_unlock (&slotsLock);
+
+			if ( ! body )
+
+				goto done;
+		}
+
+		snprintf (reply, sizeof(reply),
+				     "HTTP/1.1 %s\r\nContent-Type: text/%s\r\n"
+				     "Content-Length: %zu\r\n\r\n", busy ? "429 Too Many Requests" : "200 OK",
+				     (isGet || busy) ? "plain" : "csv", length);
+
+		if (sendAll (sock, reply, strlen (reply)) != 0 || sendAll (sock, body, length) != 0){
+
+			if (body != status && body != busyAnswer)
+				free (body);
+			goto done;
+		}
+
+		if (body != status && body != busyAnswer)
+			free (body);
+
+		/* keep what we have of next request */
+		memmove (buf, buf + headLen + bodyLen, have - headLen - bodyLen);
+		have -= headLen + bodyLen;
+	}
+
+done:
+
+	free (buf);
+	close (sock);
+
+	return NULL;
+}
+
+int main (int argc, char *argv[]){
+
+	int					opt;
+	int					port = MOCK_PORT;
+	int					listenSock, sock;
+	int					one = 1;
+	struct sockaddr_in	addr;
+	pthread_t			thread;
+
+	while ((opt = getopt (argc, argv, "p:l:s:r:g")) != -1){
+
+		switch (opt){
+
+		case 'p': port = atoi (optarg); break;
+		case 'l': latencyMs = atoi (optarg); break;
+		case 's': numRows = atoi (optarg); break;
+		case 'r': rateLimit = atoi (optarg); break;
+		case 'g': growLatency = 1; break;
+		default:
+			fprintf (stderr, "usage: %s [-p port] [-l latencyMs] [-s rows] [-r rateLimit] [-g]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (numRows < 0)
+		numRows = 0;
+
+	signal (SIGPIPE, SIG_IGN);
+
+	listenSock = socket (AF_INET, SOCK_STREAM, 0);
+	setsockopt (listenSock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset (&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons (port);
+	addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+	if (bind (listenSock, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+		listen (listenSock, 256) != 0){
+		perror ("mockOverpass: bind/listen");
+		return 1;
+	}
+
+	fprintf (stderr, "mockOverpass: listening on 127.0.0.1:%d latency %d ms, %d rows\n",
+			    port, latencyMs, numRows);
+
+	while ((sock = accept (listenSock, NULL, NULL)) >= 0){
+
+		setsockopt (sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+		if (pthread_create (&thread, NULL, serveConnection, (void *) (long) sock) != 0){
+			close (sock);
+			continue;
+		}
+
+		pthread_detach (thread);
+	}
+
+	return 0;
+}
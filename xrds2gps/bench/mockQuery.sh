@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# mockQuery.sh
+#
+#  Created on: Oct 17, 2026
+#      Author: wael
+#
+# Stand in for local query program osm3s_query to try the --exec option;
+# NOT part of xrds2gps. Reads query on stdin, answers with canned CSV in the
+# "@lat @lon @count" format our cross roads query asks for: two nodes and
+# count row. Query with "FAIL" in a street name exits with error, one not
+# asking for count gets an error message - as the server does.
+#
+# usage: xrds2gps --exec bench/mockQuery.sh inputFile
+
+query=$(cat)
+
+case "$query" in
+	*FAIL*)
+		echo "mockQuery.sh: failing as asked" >&2
+		exit 2 ;;
+	*"out count"*)
+		;;
+	*)
+		echo "runtime error: query not understood"
+		exit 0 ;;
+esac
+
+printf '@lat\t@lon\t@count\n'
+printf '33.5000000\t-112.0700000\t\n'
+printf '33.5000010\t-112.0700010\t\n'
+printf '\t\t2\n'
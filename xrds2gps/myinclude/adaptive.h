@@ -0,0 +1,70 @@
+/*
+ * adaptive.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef ADAPTIVE_H_
+#define ADAPTIVE_H_
+
+#include <curl/curl.h>
+
+#include "curl_func.h"
+#include "endpoint.h"
+
+/* most queries in flight for --adaptive when --jobs is not given */
+#define ADAPT_DEFAULT_JOBS 16
+
+/* average latency over this times base latency is server overload */
+#define ADAPT_LATENCY_FACTOR 2.0
+
+/* base latency is lowest average latency over this many last good queries;
+ * query cost varies with the pair, so one fast answer must not set it for
+ * the whole run */
+#define ADAPT_BASE_WINDOW 64
+
+/* weight of newest good query in average latency */
+#define ADAPT_EWMA_WEIGHT 0.2
+
+/* good queries before latency is taken as a signal */
+#define ADAPT_MIN_SAMPLES 5
+
+/* least time between two server status page checks */
+#define ADAPT_PROBE_MS 10000
+
+/* adaptive concurrency: queries in flight allowed - limit - go up by one
+ * for each limit good queries and are cut in half on overload, no more than
+ * once for the queries in flight when it was seen. Server slots from its
+ * status page - when it has one - cap the limit.
+ ************************************************************************/
+typedef struct ADAPTIVE_ {
+
+	double		limit;		// fraction is additive increase in progress
+	int			ceiling;		// jobs, or server slots when fewer
+	int			jobs;
+	int			serverSlots;	// zero when unknown or no limit
+	int			hasStatus;	// a server has status page
+	double		baseLatency;	// lowest avgLatency in window, ms
+	double		avgLatency;	// EWMA of good query latency, ms
+	double		window[ADAPT_BASE_WINDOW];	// last avgLatency values
+	int			numSamples;
+	double		holdUntil;	// nowMs() time; no cut before
+	double		nextProbe;
+	int			numIncrease;
+	int			numDecrease;
+
+	ENDPOINT_POOL	*pool;		// or NULL for srvrURL
+	CURLU		*srvrURL;
+
+} ADAPTIVE;
+
+void initialAdaptive (ADAPTIVE *adapt, int jobs, ENDPOINT_POOL *pool, CURLU *srvrURL);
+
+int adaptiveLimit (ADAPTIVE *adapt);
+
+void adaptiveDone (ADAPTIVE *adapt, QUERY_FAILURE failure, double latency);
+
+void printAdaptive (ADAPTIVE *adapt);
+
+#endif /* ADAPTIVE_H_ */
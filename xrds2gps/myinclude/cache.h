@@ -0,0 +1,75 @@
+/*
+ * cache.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "overpass-c.h"
+
+/* cache file name, placed in program output directory */
+#define CACHE_FILE_NAME "xrds2gps.cache"
+
+/* default time to live for cached results in days */
+#define CACHE_TTL_DAYS 30
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+/* initial number of entries in table - always a power of two */
+#define CACHE_INITIAL_SIZE 1024
+
+#define CACHE_PENDING ((time_t) 0)
+#define CACHE_FAILED ((time_t) 1)
+
+/* one cached result; key of zero marks an empty entry. In memory only table
+ * (memo), stamp of CACHE_PENDING marks a result being queried now and stamp
+ * of CACHE_FAILED a query given up on. */
+typedef struct CACHE_ENTRY_ {
+
+	uint64_t	key;
+	time_t	stamp;
+	int		nodesNum;
+	GPS		nodes[MAX_NODES];
+	GPS		midGps;
+
+} CACHE_ENTRY;
+
+/* open addressing hash table of CACHE_ENTRY, optionally backed by a file */
+typedef struct XRDS_CACHE_ {
+
+	CACHE_ENTRY	*entries;
+	int			capacity;
+	int			count;
+	time_t		ttl;		// seconds, zero for no expiry
+	FILE			*filePtr;	// append file, NULL for memory only cache
+
+} XRDS_CACHE;
+
+int initialCache (XRDS_CACHE *cache, int capacity, time_t ttl);
+
+int openCacheFile (XRDS_CACHE *cache, char *filename);
+
+void closeCache (XRDS_CACHE *cache);
+
+uint64_t queryKey (const char *query);
+
+uint64_t pairKey (XROADS *xrds, BBOX *bbox);
+
+int cachePending (XRDS_CACHE *cache, uint64_t key);
+
+int cacheFailed (XRDS_CACHE *cache, uint64_t key);
+
+CACHE_ENTRY * cacheLookup (XRDS_CACHE *cache, uint64_t key);
+
+int cacheStore (XRDS_CACHE *cache, uint64_t key, XROADS *xrds);
+
+void cache2Xrds (XROADS *dest, CACHE_ENTRY *entry);
+
+#endif /* CACHE_H_ */
@@ -0,0 +1,47 @@
+/*
+ * coord.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef COORD_H_
+#define COORD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "overpass-c.h"
+
+/* OSM stores coordinates as integer degrees * 10^7, we print 7 decimals */
+#define COORD_DECIMALS	7
+
+/* longest coordinate text without padding: "-180.0000000" */
+#define COORD_TEXT_MAX	12
+
+/* how formatGps() lays out one GPS: prefix lon middle lat suffix, with
+ * longitude and latitude right aligned in width (0 for none) - same as
+ * printf("%*.7f") of degrees. separator goes between GPS in formatGpsArray().
+ */
+typedef struct COORD_FORMAT_ {
+
+	const char	*prefix;
+	int			lonWidth;
+	const char	*middle;
+	int			latWidth;
+	const char	*suffix;
+	const char	*separator;
+
+} COORD_FORMAT;
+
+int formatCoordE7 (char *dest, int32_t e7, int width);
+
+int formatGps (char *dest, size_t size, GPS *gps, const COORD_FORMAT *format);
+
+int formatGpsArray (char *dest, size_t size, GPS **gpsArray, int count,
+		             const COORD_FORMAT *format);
+
+int scanCoordE7 (int32_t *e7, const char *str, size_t length);
+
+void gpsCentroid (GPS *dest, GPS **gpsArray, int count);
+
+#endif /* COORD_H_ */
@@ -25,17 +25,76 @@
 
 
 // structure from examples/getinmemory.c - added  typedef
+/* receive buffer; memory grows by doubling capacity and is reused between
+ * queries with resetMemory(), memory is always '\0' terminated.
+ * Each easy handle from initialQuery() owns one, see queryMemory().
+ *************************************************************************/
 typedef struct MEMORY_STRUCT_  {
 
 	char		*memory;
-	size_t	size;
+	size_t	size;		// bytes in memory
+	size_t	capacity;	// bytes allocated
 } MEMORY_STRUCT;
 
+#define MEMORY_INITIAL_SIZE (16 * 1024)
+
+#define MEMORY_BYTES(mem) ((mem)->memory)
+
+#define MEMORY_LENGTH(mem) ((mem)->size)
+
+#define MEMORY_CAPACITY(mem) ((mem)->capacity)
+
+/* how many times a query is tried before we give up on it */
+#define	NUM_TRIES	3
+
+/* retry backoff: delay doubles with each try starting at base, up to max;
+ * server asking us to slow down (HTTP 429) starts at a longer base.
+ * Actual delay is jittered - see retryDelayMs().
+ */
+#define RETRY_BASE_MS		500
+#define RETRY_LIMIT_BASE_MS	2000
+#define RETRY_MAX_MS		30000
+
+/* default limit on time for one query, set with setQueryTimeout(); a bit
+ * over Overpass default [timeout:180] for the server to answer first. */
+#define QUERY_TIMEOUT_SECONDS	300
+
+/* most we take for --timeout */
+#define MAX_QUERY_SECONDS	3600
+
+/* limit on time for getServerStatus() */
+#define STATUS_TIMEOUT_MS	5000
+
+/* query outcome, see queryFailure(); all failures but QUERY_REJECTED are
+ * worth another try after a delay.
+ **************************************************************************/
+typedef enum QUERY_FAILURE_ {
+
+	QUERY_OK = 0,
+	QUERY_TRANSPORT,	// no connection, reset, timed out
+	QUERY_RATE_LIMIT,	// HTTP 429 Too Many Requests
+	QUERY_GATEWAY,	// HTTP 504 Gateway Timeout or other 5xx
+	QUERY_BAD_ANSWER,	// not our data; Overpass HTML error page
+	QUERY_REJECTED,	// other HTTP 4xx, query itself is bad
+	QUERY_CANCELLED	// stopped by us; other copy answered, run is late
+
+} QUERY_FAILURE;
+
 typedef enum HTTP_METHOD_ {
 
 	Get = 1, Post
 }HTTP_METHOD;
 
+int initialMemory (MEMORY_STRUCT *mem, size_t capacity);
+
+int growMemory (MEMORY_STRUCT *mem, size_t needed);
+
+int appendMemory (MEMORY_STRUCT *mem, const char *bytes, size_t length);
+
+void resetMemory (MEMORY_STRUCT *mem);
+
+void zapMemory (MEMORY_STRUCT *mem);
+
 int initialSession(void);
 
 void closeSession(void);
@@ -46,6 +105,32 @@ CURL * initialQuery (CURLU *serverUrl);
 
 CURLcode queryBasicOptions (CURL *qH, CURLU *serverUrl);
 
-int performQuery (MEMORY_STRUCT *answer, char *query, CURLU *srvrURL, CURL *qh);
+MEMORY_STRUCT * queryMemory (CURL *qh);
+
+void closeQuery (CURL *qh);
+
+int prepareQueryWrite (char *query, CURL *qh,
+		                          curl_write_callback writeFunc, void *writeData);
+
+int prepareQuery (MEMORY_STRUCT *answer, char *query, CURL *qh);
+
+int performQueryWrite (char *query, CURLU *srvrURL, CURL *qh,
+		                            curl_write_callback writeFunc, void *writeData);
+
+int performQuery (MEMORY_STRUCT *answer, char *query, char *header, CURLU *srvrURL, CURL *qh);
+
+QUERY_FAILURE queryFailure (CURL *qh, CURLcode result);
+
+const char * failureName (QUERY_FAILURE failure);
+
+long retryDelayMs (QUERY_FAILURE failure, int tries);
+
+void pauseMs (long ms);
+
+void setQueryTimeout (long ms);
+
+long getQueryTimeout (void);
+
+int getServerStatus (CURLU *srvrURL, int *rateLimit, int *available);
 
 #endif /* CURL_FUNC_H_ */
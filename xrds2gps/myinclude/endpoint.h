@@ -0,0 +1,81 @@
+/*
+ * endpoint.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef ENDPOINT_H_
+#define ENDPOINT_H_
+
+#include <curl/curl.h>
+
+#include "curl_func.h"
+
+/* most servers we balance queries over */
+#define MAX_ENDPOINTS 16
+
+/* failed queries in a row - no connection or server error - to eject */
+#define EJECT_FAILURES 3
+
+/* ejected endpoint connection is checked again after this long; a probe
+ * gets as long to connect */
+#define PROBE_INTERVAL_MS 5000
+
+/* one Overpass server; all endpoints are expected to have the same data */
+typedef struct ENDPOINT_ {
+
+	char		*server;		// URL as given
+	CURLU	*url;
+	char		*host;		// for checkURL()
+	char		*port;
+	int		healthy;		// zero when ejected
+	int		outstanding;	// queries in flight now
+	int		failures;		// failed queries in a row
+	long		numQueries;
+	long		numFailed;
+	double	nextProbe;	// nowMs() time, for ejected endpoint
+	int		probeFailures;	// failed probes in a row
+	CURL		*probe;		// probe in multi handle now, or NULL
+
+} ENDPOINT;
+
+typedef struct ENDPOINT_POOL_ {
+
+	ENDPOINT	endpoint[MAX_ENDPOINTS];
+	int		count;
+	int		next;		// round robin start among equals
+
+} ENDPOINT_POOL;
+
+void initialEndpointPool (ENDPOINT_POOL *pool);
+
+int addEndpoint (ENDPOINT_POOL *pool, char *server);
+
+int readEndpointFile (ENDPOINT_POOL *pool, char *filename);
+
+int checkEndpoints (ENDPOINT_POOL *pool);
+
+int startProbes (ENDPOINT_POOL *pool, CURLM *multiHandle);
+
+int probeDone (ENDPOINT_POOL *pool, CURLM *multiHandle, CURL *handle, CURLcode result);
+
+void stopProbes (ENDPOINT_POOL *pool, CURLM *multiHandle);
+
+int numHealthy (ENDPOINT_POOL *pool);
+
+double nextProbeMs (ENDPOINT_POOL *pool, double now);
+
+int isPoolDown (ENDPOINT_POOL *pool);
+
+ENDPOINT * pickEndpoint (ENDPOINT_POOL *pool, ENDPOINT *avoid);
+
+void endpointDone (ENDPOINT_POOL *pool, ENDPOINT *endpoint, QUERY_FAILURE failure);
+
+CURLU * endpointURL (ENDPOINT_POOL *pool);
+
+void printEndpoints (ENDPOINT_POOL *pool);
+
+void zapEndpointPool (ENDPOINT_POOL *pool);
+
+#endif /* ENDPOINT_H_ */
@@ -0,0 +1,48 @@
+/*
+ * execQuery.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef EXECQUERY_H_
+#define EXECQUERY_H_
+
+#include <sys/types.h>
+
+#include "overpass-c.h"
+#include "curl_func.h"
+#include "op_string.h"
+#include "multiQuery.h"
+#include "dList.h"
+#include "util.h"
+
+/* read size from child stdout */
+#define EXEC_READ_SIZE (16 * 1024)
+
+/* one query running in a child process of local query program - as in
+ * osm3s_query - query is written to its stdin, answer read from its stdout
+ * and fed to parser. Query string is in arena, reset for each new query.
+ ************************************************************************/
+typedef struct EXEC_SLOT_ {
+
+	pid_t			pid;
+	int				toChild;		// -1 once query is written
+	int				fromChild;	// -1 at end of answer
+	char				*query;
+	size_t			length;
+	size_t			written;
+	ARENA			arena;
+	XRDS_PARSER		parser;
+	MEMORY_STRUCT	raw;			// with raw data file only
+	XROADS			*xrds;
+	int				index;		// position of xrds in input list
+	double			started;		// nowMs() time child was started
+	int				busy;
+
+} EXEC_SLOT;
+
+int execGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, char *execPath,
+		            QUERY_SCHEDULE *schedule, XRDS_DONE_FUNC done, void *doneData);
+
+#endif /* EXECQUERY_H_ */
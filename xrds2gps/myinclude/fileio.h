@@ -10,6 +10,7 @@
 
 #include <limits.h>
 #include "dList.h"
+#include "util.h"
 
 typedef struct LINE_INFO_ {
 	char		*string;
@@ -20,7 +21,29 @@ typedef struct LINE_INFO_ {
 	#define LONG_LINE PATH_MAX
 #endif
 
-int file2List (DL_LIST *list, char *filename);
+/* input file mapped into memory, read with nextLineView() */
+typedef struct MAPPED_FILE_ {
+	char		*data;		// NULL for empty file
+	size_t	size;
+	size_t	offset;		// start of next line
+	int		lineNum;	// lines read so far
+} MAPPED_FILE;
+
+/* one line in MAPPED_FILE: NOT zero terminated, no line feed, leading
+ * space and tab dropped; good until closeMappedFile(). */
+typedef struct LINE_VIEW_ {
+	const char	*ptr;
+	size_t		len;
+	int			lineNum;	// original line number in file
+} LINE_VIEW;
+
+int file2List (DL_LIST *list, char *filename, ARENA *arena);
+
+int openMappedFile (MAPPED_FILE *mapped, char *filename);
+int nextLineView (MAPPED_FILE *mapped, LINE_VIEW *view);
+int mappedLineCount (MAPPED_FILE *mapped);
+void closeMappedFile (MAPPED_FILE *mapped);
+int lineView2Str (char *dest, size_t size, LINE_VIEW *view);
 void printLineInfo(LINE_INFO *lineInfo);
 void printFileList(DL_LIST *list);
 void zapLineInfo(void **data);
@@ -0,0 +1,100 @@
+/*
+ * multiQuery.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef MULTIQUERY_H_
+#define MULTIQUERY_H_
+
+#include "curl_func.h"
+#include "overpass-c.h"
+#include "op_string.h"
+#include "dList.h"
+#include "endpoint.h"
+
+/* limit on number of queries we keep in flight */
+#define MAX_JOBS 64
+
+/* most queries started per second we allow for --rate */
+#define MAX_RATE 1000
+
+/* hedging: a copy of a query still running at observed p95 latency goes
+ * to another server; p95 is taken from last HEDGE_SAMPLES good queries
+ * once there are HEDGE_MIN_SAMPLES of them. */
+#define HEDGE_SAMPLES		128
+#define HEDGE_MIN_SAMPLES	20
+
+/* how queries are sent: jobs in flight at once, start rate in queries
+ * per second paced by a token bucket - zero for no pacing - and servers to
+ * balance queries over; with no pool all queries go to one server URL.
+ * With hedge set a slow query gets a copy, see multiGetXrdsDL(). Run
+ * deadline is nowMs() time for all to be done by, zero for none. With
+ * adaptive set jobs is the most in flight, see adaptive.c.
+ ************************************************************************/
+typedef struct QUERY_SCHEDULE_ {
+
+	int			jobs;
+	double		rate;
+	ENDPOINT_POOL	*pool;	// or NULL
+	int			hedge;
+	double		deadline;
+	int			adaptive;
+
+} QUERY_SCHEDULE;
+
+/* latency of last good queries in milliseconds and their p95, zero until
+ * HEDGE_MIN_SAMPLES are in. */
+typedef struct LATENCY_RING_ {
+
+	double	sample[HEDGE_SAMPLES];
+	int		count;
+	int		next;
+	double	p95;
+
+} LATENCY_RING;
+
+/* one in flight query; easy handle is reused for the whole list, parser,
+ * xrds and index change with each query. Query string is in arena, which is
+ * reset for each new query. A hedge - copy of query running in twin slot -
+ * is parsed into shadow and copied to input XROADS only if it wins.
+ ************************************************************************/
+typedef struct QUERY_SLOT_ {
+
+	CURL				*handle;
+	XRDS_PARSER		parser;
+	ARENA			arena;
+	char				*query;
+	XROADS			*xrds;
+	int				index;	// position of xrds in input list
+	ENDPOINT			*endpoint;	// server for this query, NULL without pool
+	double			started;	// nowMs() time query was sent
+	struct QUERY_SLOT_	*twin;	// other slot on same XROADS, or NULL
+	int				hedge;
+	XROADS			shadow;
+	POINT			shadowPoint;
+	GPS				shadowGps[MAX_NODES + 1];	// nodes, then mid-point
+	int				busy;
+
+} QUERY_SLOT;
+
+/* XROADS waiting for a slot by index in input list: input order first,
+ * a failed query goes back at the end. readyAt and tries are by index;
+ * readyAt is in milliseconds on monotonic clock, query waits until then.
+ ************************************************************************/
+typedef struct WAIT_QUEUE_ {
+
+	int		*index;		// circular, size entries
+	int		head;
+	int		count;
+	int		size;
+	double	*readyAt;
+	int		*tries;
+
+} WAIT_QUEUE;
+
+int multiGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL,
+		             QUERY_SCHEDULE *schedule, XRDS_DONE_FUNC done, void *doneData);
+
+#endif /* MULTIQUERY_H_ */
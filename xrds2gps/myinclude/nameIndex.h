@@ -0,0 +1,39 @@
+/*
+ * nameIndex.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef NAMEINDEX_H_
+#define NAMEINDEX_H_
+
+#include <curl/curl.h>
+
+#include "overpass-c.h"
+#include "util.h"
+
+/* most near match suggestions given for an unknown street name */
+#define MAX_SUGGESTIONS 3
+
+/* street names in one bbox, from namesFillTemplate() query */
+typedef struct NAME_INDEX_ {
+
+	char		**names;		// distinct, sorted
+	char		**lowerNames;	// same order, lower case
+	int		count;
+	BBOX		bbox;		// names are for this bbox when loaded
+	int		loaded;
+	ARENA	arena;		// name strings
+
+} NAME_INDEX;
+
+void initialNameIndex (NAME_INDEX *index);
+
+void zapNameIndex (NAME_INDEX *index);
+
+int loadNameIndex (NAME_INDEX *index, BBOX *bbox, CURLU *srvrURL);
+
+int checkXrdsNames (NAME_INDEX *index, XROADS *xrds);
+
+#endif /* NAMEINDEX_H_ */
@@ -0,0 +1,41 @@
+/*
+ * nodeSet.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef NODESET_H_
+#define NODESET_H_
+
+#include <stdint.h>
+
+/* NODE_SET: growing array of OSM node ids - or indexes into a node table.
+ * Set is sorted with no repeats after sortNodeSet(); intersectNodeSets()
+ * expects both sets sorted.
+ */
+typedef struct NODE_SET_ {
+
+	int64_t	*ids;
+	int		count;
+	int		capacity;
+
+} NODE_SET;
+
+#define NODE_SET_INITIAL_SIZE 64
+
+int initialNodeSet (NODE_SET *set, int capacity);
+
+int addNodeSet (NODE_SET *set, int64_t id);
+
+int appendNodeSet (NODE_SET *dest, NODE_SET *src);
+
+void sortNodeSet (NODE_SET *set);
+
+int findNodeSet (NODE_SET *set, int64_t id);
+
+int intersectNodeSets (NODE_SET *dest, NODE_SET *first, NODE_SET *second);
+
+void zapNodeSet (NODE_SET *set);
+
+#endif /* NODESET_H_ */
@@ -10,28 +10,78 @@
 
 #include "overpass-c.h"
 #include "dList.h"
+#include "fileio.h"
+
+/* longest response line XRDS_PARSER takes; GPS lines are < 32 characters */
+#define PARSER_LINE_LENGTH 128
+
+/* buffer size for one WKT point string, see formatGpsWKT() */
+#define WKT_POINT_SIZE 48
+
+/* bytes kept from response start to show server error messages */
+#define PARSER_KEEP_LENGTH 1024
+
+/* streaming cross roads response parser; see op_string.c */
+typedef struct XRDS_PARSER_ {
+
+	XROADS			*xrds;
+	char				line[PARSER_LINE_LENGTH]; // partial line between chunks
+	int				lineLength;
+	int				lineNum;
+	int				numRows;	// node lines seen
+	int				numCount;	// value from count line, -1 until seen
+	int				error;		// first error, ztSuccess while good
+	char				keep[PARSER_KEEP_LENGTH];
+	int				keepLength;
+	MEMORY_STRUCT	*raw;		// full response copy, NULL for none
+
+} XRDS_PARSER;
 
 int parseBbox(BBOX *bbox, char *string);
 
+int parseNames(char **first, char **second, char *str);
+
 int xrdsParseNames(XROADS *dest, char *str);
 
+int parseBboxView(BBOX *bbox, LINE_VIEW *view);
+
+int xrdsParseView(XROADS **dest, XRDS_BATCH *batch, LINE_VIEW *view);
+
+int gridParseFile (XRDS_BATCH **batch, DL_LIST *xrdsDL, MAPPED_FILE *mapped);
+
+int namesParseFile (char ***names, int *numNames, ARENA *arena, MAPPED_FILE *mapped);
+
 int parseCurlXrdsData (XROADS *xrds, void *data);
 
+void initialXrdsParser (XRDS_PARSER *parser, XROADS *xrds, MEMORY_STRUCT *raw);
+
+int feedXrdsParser (XRDS_PARSER *parser, const char *bytes, size_t length);
+
+int finishXrdsParser (XRDS_PARSER *parser);
+
+size_t xrdsParserWrite (char *contents, size_t size, size_t nmemb, void *userp);
+
 int parseWgetXrdsFile (XROADS *dst, void *filename);
 
 int parseXrdsResult (XROADS *dstXrds, DL_LIST *srcDL);
 
+int parseBatchXrdsData (DL_LIST *xrdsDL, void *data);
+
 int response2LineDL (DL_LIST *dstDL, char *response);
 
 int parseGPS (GPS *dst, char *str);
 
+int parseGPSView (GPS *dst, const char *line, size_t length);
+
 void printXrds (XROADS *xrds);
 
 void writeXrds (FILE *file, void *data);
 
-char *gps2WKT (GPS *gps);
+int formatGpsWKT (char *dest, size_t size, GPS *gps);
+
+char *gps2WKT (GPS *gps, ARENA *arena);
 
-int xrds2WKT (char **dst, XROADS *xrds);
+int xrds2WKT (char **dst, XROADS *xrds, ARENA *arena);
 
 void writeString2FP (FILE *to, void *str);
 
@@ -39,10 +89,10 @@ void printXrds(XROADS *xrds);
 
 void printXrdsDL (DL_LIST *srcDL);
 
-int formatBboxWKT (char **dest, BBOX *bbox);
+int formatBboxWKT (char **dest, BBOX *bbox, ARENA *arena);
 
 int bbox2Rectangle(RECTANGLE *destRect, BBOX *bbox);
 
-int formatRectWKT (char **dest, RECTANGLE *rect);
+int formatRectWKT (char **dest, RECTANGLE *rect, ARENA *arena);
 
 #endif /* OP_STRING_H_ */
@@ -0,0 +1,54 @@
+/*
+ * osmFile.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef OSMFILE_H_
+#define OSMFILE_H_
+
+#include <stdint.h>
+
+#include "overpass-c.h"
+#include "nodeSet.h"
+#include "dList.h"
+#include "util.h"
+
+/* one node from OSM file; table is sorted by id */
+typedef struct OSM_NODE_ {
+
+	int64_t	id;
+	GPS		gps;
+
+} OSM_NODE;
+
+/* all highway ways - but 'service' - with the same name make one street;
+ * nodes are indexes into node table, sorted with no repeats. */
+typedef struct OSM_STREET_ {
+
+	char		*name;
+	char		*lowerName;	// for case insensitive match
+	NODE_SET	nodes;
+
+} OSM_STREET;
+
+/* what we keep from local OSM extract to resolve XROADS without a server */
+typedef struct OSM_DATA_ {
+
+	OSM_NODE		*nodes;
+	int			numNodes;
+	OSM_STREET	*streets;	// sorted by name
+	int			numStreets;
+	ARENA		names;		// street names
+
+} OSM_DATA;
+
+int loadOsmFile (OSM_DATA *osm, char *filename);
+
+int osmGetXrdsDL (OSM_DATA *osm, DL_LIST *xrdsDL, BBOX *bbox,
+		           XRDS_DONE_FUNC done, void *doneData);
+
+void zapOsmData (OSM_DATA *osm);
+
+#endif /* OSMFILE_H_ */
@@ -9,7 +9,10 @@
 #define OVERPASS_C_H_
 
 #include <stdio.h>
+#include <stdint.h>
 #include "curl_func.h"
+#include "dList.h"
+#include "util.h"
 
 /* LONGITUDE_OK(i) and LATITUDE_OK(i) are both
  *  macros to validate longitude and latitude values in the
@@ -20,6 +23,17 @@
 #define LONGITUDE_OK(i) (((i) > -113.0 && (i) < -111.0))
 #define LATITUDE_OK(i) (((i) > 32.8 && (i) < 33.95))
 
+/* coordinates are kept as OSM does: integer degrees * 10^7 in int32, with
+ * conversion to and from double degrees at the edges only. */
+#define E7_SCALE	10000000
+
+#define E7_TO_DEGREES(e7)	((double) (e7) / E7_SCALE)
+#define DEGREES_TO_E7(deg)	((int32_t) ((deg) * E7_SCALE + ((deg) < 0 ? -0.5 : 0.5)))
+
+/* same ranges as LONGITUDE_OK() and LATITUDE_OK() for fixed point values */
+#define LONGITUDE_E7_OK(i) (((i) > -1130000000 && (i) < -1110000000))
+#define LATITUDE_E7_OK(i) (((i) > 328000000 && (i) < 339500000))
+
 /* exported variable for raw data file pointer, when set by client raw query
  * result from overpass server is written to that open file.
  *************************************************************************/
@@ -28,8 +42,8 @@ extern FILE *rawDataFP;
 /* type definitions */
 typedef struct GPS_ {
 
-	double 	longitude,
-					latitude;
+	int32_t	lonE7,	// longitude degrees * 10^7
+			latE7;	// latitude degrees * 10^7
 } GPS;
 
 typedef struct HB_ { // hundred block number
@@ -57,6 +71,18 @@ typedef struct BBOX_ {
 /* limit number of GPS nodes we store */
 #define MAX_NODES 8
 
+/* XROADS status: pending until GPS members are filled from server, cache
+ * or memo - nodesNum may still be zero (not found) once resolved. Failed
+ * is for query given up on after NUM_TRIES tries; nodesNum is zero. */
+#define XRDS_PENDING		0
+#define XRDS_RESOLVED	1
+#define XRDS_FAILED		2
+
+/* XROADS exact bits: name is canonical - from street name dictionary - and
+ * server matches it exactly instead of with case insensitive regexp. */
+#define XRDS_EXACT_FIRST		1
+#define XRDS_EXACT_SECOND	2
+
 typedef struct XROADS_ {
 
 	char		*firstRD, *secondRD;
@@ -64,9 +90,35 @@ typedef struct XROADS_ {
 	int		nodesNum;
 	GPS		*nodesGPS[MAX_NODES];
 	GPS		*midGps;
+	int		status;
+	int		exact;	// XRDS_EXACT_ bits
 
 } XROADS;
 
+/* called by query engines as each XROADS is done, in completion order */
+typedef void (*XRDS_DONE_FUNC) (XROADS *xrds, void *data);
+
+/* XRDS_BATCH: storage for all XROADS from one input file in few contiguous
+ * arrays; XROADS pointer members point into the arrays and names into the
+ * names arena. Each XROADS gets MAX_NODES nodes starting at its index times
+ * MAX_NODES. Batch is sized once, so pointers stay good for its life; XROADS
+ * from a batch are NOT freed with zapXrds(), lists holding them are set with
+ * NULL destroy and the batch is freed as a whole with zapXrdsBatch().
+ *************************************************************************/
+typedef struct XRDS_BATCH_ {
+
+	XROADS	*xrds;
+	POINT	*points;
+	GPS		*nodes;		// capacity * MAX_NODES
+	GPS		*midGps;
+	char		*names;		// names arena, zero terminated strings
+	size_t	namesSize;
+	size_t	namesUsed;
+	int		capacity;
+	int		count;
+
+} XRDS_BATCH;
+
 #define MAX_SRC_LENGTH  65
 #define MAX_ID_LENGTH  17
 
@@ -92,14 +144,33 @@ int cpyXrds (XROADS *dest, XROADS *src);
 
 void zapXrds (void **xrds);
 
-char* xrdsFillTemplate (XROADS *xrds, BBOX *bbox);
+XRDS_BATCH * initialXrdsBatch (int capacity, size_t namesSize);
+
+XROADS * batchNewXrds (XRDS_BATCH *batch, char *firstRd, char *secondRd);
+
+void zapXrdsBatch (void **batch);
+
+char* xrdsFillTemplate (XROADS *xrds, BBOX *bbox, ARENA *arena);
 
 int isOkResponse (char *response, char *header);
 
 int namesFillTemplate(char **dst, BBOX *bbox);
 
+int batchFillTemplate (char **dst, DL_LIST *xrdsDL, BBOX *bbox);
+
+int streetsFillTemplate (char **dst, char **streets, int *exact, int numStreets,
+		                   BBOX *bbox, int withGps);
+
+int nodesFillTemplate (char **dst, int64_t *ids, int numIds);
+
+int crossingsFillTemplate (char **dst, char **streets, int numStreets, BBOX *bbox);
+
+int getBatchXrdsGps (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL, CURL *curlHandle);
+
 int isBbox(BBOX *bbox);
 
 int getXrdsGps (XROADS *xrds, BBOX *bbox, CURLU *srvrURL, CURL *myCurlHandle);
 
+void xrdsWriteRawData (XROADS *xrds, MEMORY_STRUCT *answer);
+
 #endif /* OVERPASS_C_H_ */
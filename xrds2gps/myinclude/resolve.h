@@ -0,0 +1,46 @@
+/*
+ * resolve.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef RESOLVE_H_
+#define RESOLVE_H_
+
+#include <curl/curl.h>
+#include "dList.h"
+#include "overpass-c.h"
+#include "cache.h"
+#include "osmFile.h"
+#include "streetQuery.h"
+#include "nameIndex.h"
+#include "multiQuery.h"
+
+/* how cross roads are resolved; set from command line */
+typedef struct RESOLVE_OPTIONS_ {
+
+	QUERY_SCHEDULE	schedule;	// queries in flight and rate
+	int			batchMode;	// one query per input file
+	XRDS_CACHE	*cache;		// NULL when cache is not used
+	int			refresh;	// ignore cached results, store new ones
+	XRDS_CACHE	*memo;		// results from this run, memory only
+	XRDS_DONE_FUNC	done;	// called as each XROADS is resolved, or NULL
+	void			*doneData;
+	OSM_DATA		*osm;		// local OSM file instead of server, or NULL
+	STREET_CACHE	*streets;	// query by street node ids, or NULL
+	int			gridMode;	// grid input, two queries per list
+	NAME_INDEX	*names;		// street name dictionary, or NULL
+	char			*execPath;	// local query program instead of server, or NULL
+
+} RESOLVE_OPTIONS;
+
+int curlGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *url,
+		            QUERY_SCHEDULE *schedule, XRDS_DONE_FUNC done, void *doneData);
+
+int batchGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *url,
+		             XRDS_DONE_FUNC done, void *doneData);
+
+int resolveXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *url, RESOLVE_OPTIONS *options);
+
+#endif /* RESOLVE_H_ */
@@ -0,0 +1,109 @@
+/*
+ * sink.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef SINK_H_
+#define SINK_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "dList.h"
+#include "overpass-c.h"
+#include "curl_func.h"
+
+/* stdio buffer size for each output file */
+#define SINK_BUFFER_SIZE (64 * 1024)
+
+#define MAX_SINKS 8
+
+/* what a sink writes for each XROADS - or for each bounding box */
+typedef enum SINK_KIND_ {
+
+	SINK_TEXT = 1,	// writeXrds() text
+	SINK_CSV,		// one CSV row per XROADS, header line first
+	SINK_NDJSON,		// one JSON object per line per XROADS
+	SINK_BINARY,		// fixed size little endian records, see below
+	SINK_WKT,		// one WKT point per node
+	SINK_MIDGPS,	// one WKT point per XROADS found, its midGps
+	SINK_BBOX		// one WKT polygon per input file bounding box
+
+} SINK_KIND;
+
+/* Binary output layout - all integers little endian, coordinates are
+ * degrees * 10^7 as int32:
+ *
+ *   header, BIN_HEADER_SIZE bytes:
+ *     char magic[8]      "XRDSBIN2" - last character is layout version
+ *     uint32 recordSize  BIN_RECORD_SIZE
+ *     uint32 maxNodes    MAX_NODES
+ *     uint32 count       number of records
+ *     uint32 reserved    zero
+ *     uint64 namesOffset file offset of names section
+ *
+ *   count records, BIN_RECORD_SIZE bytes each:
+ *     uint32 firstName   offset of first street name in names section
+ *     uint32 secondName  offset of second street name in names section
+ *     int32  nodesNum
+ *     uint32 status      XRDS_RESOLVED (1) - found when nodesNum is more
+ *                        than zero, else not found - or XRDS_FAILED (2),
+ *                        query given up on; nodesNum is zero then
+ *     int32  midLongitude, midLatitude    zero when nodesNum is zero
+ *     int32  nodes[MAX_NODES][2]          longitude, latitude; unused are zero
+ *
+ *   names section: zero terminated street names.
+ *
+ * Record i is at BIN_HEADER_SIZE + i * BIN_RECORD_SIZE, so file can be
+ * mapped and indexed directly. Header count and namesOffset are written
+ * when sink is closed; the file must be seekable - not stdout.
+ */
+#define BIN_MAGIC			"XRDSBIN2"
+#define BIN_HEADER_SIZE	32
+#define BIN_RECORD_SIZE	(24 + MAX_NODES * 8)
+
+typedef struct XRDS_SINK_ {
+
+	SINK_KIND		kind;
+	FILE				*filePtr;
+	char				*buffer;	// stdio buffer, NULL for stdout
+	uint32_t			count;	// records written, binary only
+	MEMORY_STRUCT	names;	// names section, binary only
+	int				error;	// first error code from a write, ztSuccess
+
+} XRDS_SINK;
+
+/* every enabled output; each XROADS is written once to all of them */
+typedef struct OUTPUT_SINKS_ {
+
+	XRDS_SINK	sink[MAX_SINKS];
+	int			num;
+
+} OUTPUT_SINKS;
+
+/* releases resolved XROADS to sinks in list order as they complete */
+typedef struct XRDS_EMITTER_ {
+
+	OUTPUT_SINKS	*sinks;
+	DL_ELEM		*frontier;	// first XROADS not written yet
+
+} XRDS_EMITTER;
+
+void initialSinks (OUTPUT_SINKS *sinks);
+
+SINK_KIND sinkKind (const char *name);
+
+int addSink (OUTPUT_SINKS *sinks, SINK_KIND kind, FILE *filePtr);
+
+void sinkXrds (OUTPUT_SINKS *sinks, XROADS *xrds);
+
+int sinkBbox (OUTPUT_SINKS *sinks, BBOX *bbox);
+
+int closeSinks (OUTPUT_SINKS *sinks);
+
+void startEmitter (XRDS_EMITTER *emitter, OUTPUT_SINKS *sinks, DL_LIST *xrdsDL);
+
+void emitDone (XROADS *xrds, void *data);
+
+#endif /* SINK_H_ */
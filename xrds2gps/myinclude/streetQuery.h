@@ -0,0 +1,48 @@
+/*
+ * streetQuery.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ */
+
+#ifndef STREETQUERY_H_
+#define STREETQUERY_H_
+
+#include <stdint.h>
+#include <curl/curl.h>
+
+#include "overpass-c.h"
+#include "nodeSet.h"
+#include "dList.h"
+
+/* node ids for one street name in one bbox */
+typedef struct STREET_ENTRY_ {
+
+	uint64_t	key;	// queryKey() of bbox and name
+	NODE_SET	ids;	// sorted
+
+} STREET_ENTRY;
+
+/* street node id sets fetched in this run, memory only */
+typedef struct STREET_CACHE_ {
+
+	STREET_ENTRY	*entries;
+	int			count;
+	int			capacity;
+
+} STREET_CACHE;
+
+void initialStreetCache (STREET_CACHE *streets);
+
+void zapStreetCache (STREET_CACHE *streets);
+
+int streetGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL, STREET_CACHE *streets,
+		              XRDS_DONE_FUNC done, void *doneData);
+
+int gridGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL,
+		            XRDS_DONE_FUNC done, void *doneData);
+
+int crossingsGetXrdsDL (XRDS_BATCH **batch, DL_LIST *xrdsDL, char **streets, int numStreets,
+		                 BBOX *bbox, CURLU *srvrURL);
+
+#endif /* STREETQUERY_H_ */
@@ -13,6 +13,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 #include "dList.h"
 
@@ -58,6 +59,29 @@
  * with such characters are ignored. w.h 12/18/2018 added COMMENT_SET.
  */
 
+/* ARENA: bump pointer allocator for short lived memory; allocations are not
+ * freed one by one, the whole arena is released with resetArena() or
+ * zapArena(). Functions taking (ARENA *) fall back to malloc() when passed
+ * NULL, then caller frees as before.
+ *************************************************************************/
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN 16
+
+typedef struct ARENA_BLOCK_ {
+
+	struct ARENA_BLOCK_	*next;
+	size_t				size;	// usable bytes after header
+	size_t				used;
+
+} ARENA_BLOCK;
+
+typedef struct ARENA_ {
+
+	ARENA_BLOCK	*head;		// block in use, older blocks follow
+	size_t		blockSize;
+
+} ARENA;
+
 /* This is from: WRITING SOLID CODE by Steve Maguire
  * ASSERTARGS: is my function arguments assertion macro. If ARGS_ASSERT is
  * defined it expands to call AssertArgs() function with function name, file
@@ -124,6 +148,8 @@ int mySpawn (char *prgName, char **argLst);
 
 int spawnWait (char *prog, char **argsList);
 
+pid_t spawnPipes (char *prgName, char **argLst, int *toChild, int *fromChild);
+
 int myGetDirDL (DL_LIST *dstDL, char *dir);
 
 void zapString(void **data);
@@ -136,6 +162,18 @@ int stringToLower (char **dest, char *str);
 
 int mkOutputFile (char **dest, char *givenName, char *rootDir);
 
+void initialArena (ARENA *arena, size_t blockSize);
+
+void *arenaAlloc (ARENA *arena, size_t size);
+
+char *arenaStrdup (ARENA *arena, const char *str);
+
+void resetArena (ARENA *arena);
+
+void zapArena (ARENA *arena);
+
 FILE* openOutputFile (char *filename);
 
+double nowMs (void);
+
 #endif /* UTIL_H_ */
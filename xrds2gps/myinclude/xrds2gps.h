@@ -6,6 +6,8 @@
 #include <curl/curl.h>
 #include "fileio.h" // this includes dList.h on top
 #include "overpass-c.h"
+#include "cache.h"
+#include "resolve.h"
 #include "ztError.h"
 
 // functions prototype
@@ -13,14 +15,8 @@ void shortUsage (FILE *toFP, ztExitCodeType exitCode);
 
 void printHelp(FILE *toStream);
 
-int curlGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *url);
-
 int getXrdsDL(DL_LIST *xrdsDL, BBOX *bbox, char *server, char *outDir);
 
-int xrds2WKT_DL (DL_LIST *dstDL, DL_LIST *srcDL);
-
-int midGps2WKT_DL (DL_LIST *destList, DL_LIST *xrdsList);
-
 /* it is a mistake to tag a slash at the end of the URL */
 
 /* overpass server, use only one! */
@@ -31,8 +27,6 @@ int midGps2WKT_DL (DL_LIST *destList, DL_LIST *xrdsList);
 //#define	SERVICE_URL		"http://lazyant.local/api/interpreter"
 //#define	SERVICE_URL		"http://lazyant/api/interpreter"
 
-#define	NUM_TRIES	3
-
 // exported globals
 extern const char *prog_name;
 
@@ -0,0 +1,254 @@
+/*
+ * adaptive.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Adaptive concurrency for multiGetXrdsDL(): Overpass gives each client a
+ * number of query slots and slows down sharply once overloaded, so no fixed
+ * --jobs number fits all servers. Queries in flight start at the slots the
+ * server says are free on its /api/status page - one without a limit - and are
+ * adjusted with AIMD: one more for each round of good queries, half on rate
+ * limit, server error, no answer or average latency over ADAPT_LATENCY_FACTOR
+ * times the lowest average over the last ADAPT_BASE_WINDOW good queries. Server slots - checked again on rate limit - and --jobs
+ * cap the number. Each change is printed with its reason.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <curl/curl.h>
+
+#include "adaptive.h"
+#include "curl_func.h"
+#include "util.h"
+#include "ztError.h"
+
+/* probeSlots(): reads status page of each healthy server - or srvrURL - and
+ * sets server slots and ceiling from their rate limits; a server with no
+ * limit or no status page leaves us with no server limit. Returns queries
+ * to start with: slots free now, one for each server without a limit; -1
+ * when no server has status page.
+ */
+static int probeSlots (ADAPTIVE *adapt){
+
+	ENDPOINT	*endpoint;
+	CURLU	*url;
+	int		rateLimit, available;
+	int		totalLimit = 0, totalAvailable = 0;
+	int		numStatus = 0, noLimit = 0;
+	int		iCount, count;
+
+	count = adapt->pool ? adapt->pool->count : 1;
+
+	for (iCount = 0; iCount < count; iCount++){
+
+		if (adapt->pool){
+
+			endpoint = &adapt->pool->endpoint[iCount];
+			if ( ! endpoint->healthy )
+
+				continue;
+
+			url = endpoint->url;
+		}
+		else
+			url = adapt->srvrURL;
+
+		if (getServerStatus (url, &rateLimit, &available) != ztSuccess)
+			rateLimit = available = 0;
+		else
+			numStatus++;
+
+		totalLimit += rateLimit;
+		totalAvailable += rateLimit ? available : 1;
+		noLimit |= (rateLimit == 0);
+	}
+
+	adapt->nextProbe = nowMs () + ADAPT_PROBE_MS;
+
+	if (numStatus == 0)
+
+		return -1;
+
+	adapt->hasStatus = 1;
+
+	if (noLimit)
+		totalLimit = 0;
+
+	if (totalLimit != adapt->serverSlots){
+
+		if (totalLimit)
+			printf ("probeSlots(): Server status gives [ %d ] query slots, [ %d ] free now.\n",
+					   totalLimit, totalAvailable);
+		else
+			printf ("probeSlots(): Server status gives no query slot limit.\n");
+	}
+
+	adapt->serverSlots = totalLimit;
+	adapt->ceiling = totalLimit ? MIN(adapt->jobs, totalLimit) : adapt->jobs;
+
+	return totalAvailable;
+}
+
+/* setLimit(): sets queries in flight to limit - kept in [1 - ceiling] - and
+ * prints change with reason when whole number changes.
+ */
+static void setLimit (ADAPTIVE *adapt, double limit, const char *reason){
+
+	int		before = (int) adapt->limit;
+
+	adapt->limit = MAX(1.0, MIN(limit, (double) adapt->ceiling));
+
+	if ((int) adapt->limit == before)
+
+		return;
+
+	if ((int) adapt->limit > before)
+		adapt->numIncrease++;
+	else
+		adapt->numDecrease++;
+
+	printf ("setLimit(): Queries in flight [ %d ] -> [ %d ]: %s.\n",
+			   before, (int) adapt->limit, reason);
+
+	return;
+}
+
+/* cutLimit(): halves queries in flight for overload reason; queries sent
+ * before the cut finish over about two latencies, their failures are the
+ * same overload and do not cut again.
+ */
+static void cutLimit (ADAPTIVE *adapt, const char *reason){
+
+	double	now = nowMs ();
+
+	if (now < adapt->holdUntil)
+
+		return;
+
+	setLimit (adapt, adapt->limit / 2, reason);
+
+	adapt->holdUntil = now + (adapt->avgLatency > 0 ? 2 * adapt->avgLatency : 1000.0);
+
+	return;
+}
+
+/* initialAdaptive(): sets adapt for at most jobs queries in flight on pool
+ * servers - or srvrURL when pool is NULL - and checks server slots.
+ *************************************************************************/
+void initialAdaptive (ADAPTIVE *adapt, int jobs, ENDPOINT_POOL *pool, CURLU *srvrURL){
+
+	int		available;
+
+	ASSERTARGS (adapt && jobs > 0 && (pool || srvrURL));
+
+	memset (adapt, 0, sizeof(ADAPTIVE));
+
+	adapt->jobs = jobs;
+	adapt->ceiling = jobs;
+	adapt->pool = pool;
+	adapt->srvrURL = srvrURL;
+
+	available = probeSlots (adapt);
+
+	adapt->limit = (available > 0) ? MIN(available, adapt->ceiling) : 1;
+
+	printf ("initialAdaptive(): Starting with [ %d ] queries in flight, at most [ %d ]%s.\n",
+			   (int) adapt->limit, adapt->ceiling,
+			   ! adapt->hasStatus ? "; no server status page, using latency and errors" :
+			   adapt->serverSlots ? "" : "; no server slot limit");
+
+	return;
+}
+
+/* adaptiveLimit(): queries allowed in flight now */
+int adaptiveLimit (ADAPTIVE *adapt){
+
+	ASSERTARGS (adapt);
+
+	return (int) adapt->limit;
+}
+
+/* adaptiveDone(): takes query outcome failure and its latency in ms - for
+ * good query - into account. Bad answer, rejected or cancelled query says
+ * nothing about server load.
+ *************************************************************************/
+void adaptiveDone (ADAPTIVE *adapt, QUERY_FAILURE failure, double latency){
+
+	char		reason[128];
+	int		iCount;
+
+	ASSERTARGS (adapt);
+
+	switch (failure){
+
+	case QUERY_OK:
+
+		adapt->numSamples++;
+
+		if (adapt->numSamples == 1)
+			adapt->avgLatency = latency;
+		else
+			adapt->avgLatency += ADAPT_EWMA_WEIGHT * (latency - adapt->avgLatency);
+
+		/* base is windowed minimum of average; it goes up again once a
+		 * fast stretch leaves the window */
+		adapt->window[(adapt->numSamples - 1) % ADAPT_BASE_WINDOW] = adapt->avgLatency;
+
+		adapt->baseLatency = adapt->avgLatency;
+		for (iCount = 0; iCount < MIN(adapt->numSamples, ADAPT_BASE_WINDOW); iCount++)
+			adapt->baseLatency = MIN(adapt->baseLatency, adapt->window[iCount]);
+
+		if (adapt->numSamples >= ADAPT_MIN_SAMPLES &&
+			adapt->avgLatency > ADAPT_LATENCY_FACTOR * adapt->baseLatency){
+
+			snprintf (reason, sizeof(reason), "latency %.0f ms is over %.1f times base %.0f ms",
+					     adapt->avgLatency, ADAPT_LATENCY_FACTOR, adapt->baseLatency);
+			cutLimit (adapt, reason);
+			break;
+		}
+
+		snprintf (reason, sizeof(reason), "queries good at %.0f ms", adapt->avgLatency);
+		setLimit (adapt, adapt->limit + 1.0 / adapt->limit, reason);
+		break;
+
+	case QUERY_RATE_LIMIT:
+
+		cutLimit (adapt, "server rate limit (HTTP 429)");
+
+		if (adapt->hasStatus && nowMs () >= adapt->nextProbe){
+
+			probeSlots (adapt);
+			setLimit (adapt, adapt->limit, "fewer server slots");
+		}
+		break;
+
+	case QUERY_GATEWAY:
+
+		cutLimit (adapt, "server error (HTTP 5xx)");
+		break;
+
+	case QUERY_TRANSPORT:
+
+		cutLimit (adapt, "no answer from server");
+		break;
+
+	default:
+		break;
+	}
+
+	return;
+}
+
+/* printAdaptive(): prints where adaptive concurrency ended */
+void printAdaptive (ADAPTIVE *adapt){
+
+	ASSERTARGS (adapt);
+
+	printf ("printAdaptive(): Ended with [ %d ] queries in flight; [ %d ] increases, [ %d ] decreases, "
+			   "base latency [ %.0f ] ms.\n", (int) adapt->limit, adapt->numIncrease,
+			   adapt->numDecrease, adapt->baseLatency);
+
+	return;
+}
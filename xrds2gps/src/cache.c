@@ -0,0 +1,525 @@
+/*
+ * cache.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Cross roads result cache. Results are kept in an open addressing hash
+ * table keyed by a hash of the normalized query string. When a cache file is
+ * opened, it is loaded into the table and each new result is appended to it;
+ * the file is a text file with one result per line:
+ *
+ *   key stamp nodesNum lat lon [lat lon ...] midLat midLon
+ *
+ * with key in hex and stamp in seconds since the Epoch. Later lines replace
+ * earlier lines with the same key, old (expired) lines are dropped when the
+ * file is loaded.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <strings.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include "cache.h"
+#include "overpass-c.h"
+#include "coord.h"
+#include "util.h"
+#include "ztError.h"
+
+/* initialCache(): allocates table for capacity entries - rounded up to a
+ * power of two - sets ttl in seconds. Memory only until openCacheFile().
+ *************************************************************************/
+int initialCache (XRDS_CACHE *cache, int capacity, time_t ttl){
+
+	int	size = 16;
+
+	ASSERTARGS (cache);
+
+	while (size < capacity)
+
+		size *= 2;
+
+	memset (cache, 0, sizeof(XRDS_CACHE));
+
+	cache->entries = (CACHE_ENTRY *) calloc (size, sizeof(CACHE_ENTRY));
+	if ( ! cache->entries ){
+		fprintf(stderr, "initialCache(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	cache->capacity = size;
+	cache->ttl = ttl;
+
+	return ztSuccess;
+}
+
+/* findSlot(): returns entry for key, or empty entry where key goes */
+static CACHE_ENTRY * findSlot (XRDS_CACHE *cache, uint64_t key){
+
+	int	index;
+	int	mask = cache->capacity - 1;
+
+	index = (int) (key & mask);
+
+	while (cache->entries[index].key && cache->entries[index].key != key)
+
+		index = (index + 1) & mask;
+
+	return &cache->entries[index];
+}
+
+/* growCache(): doubles table size, rehashing entries */
+static int growCache (XRDS_CACHE *cache){
+
+	CACHE_ENTRY	*oldEntries = cache->entries;
+	int			oldCapacity = cache->capacity;
+	int			iCount;
+
+	cache->entries = (CACHE_ENTRY *) calloc (oldCapacity * 2, sizeof(CACHE_ENTRY));
+	if ( ! cache->entries ){
+		fprintf(stderr, "growCache(): Error allocating memory.\n");
+		cache->entries = oldEntries;
+		return ztMemoryAllocate;
+	}
+
+	cache->capacity = oldCapacity * 2;
+
+	for (iCount = 0; iCount < oldCapacity; iCount++)
+
+		if (oldEntries[iCount].key)
+
+			*findSlot (cache, oldEntries[iCount].key) = oldEntries[iCount];
+
+	free (oldEntries);
+
+	return ztSuccess;
+}
+
+/* putEntry(): puts entry in table replacing entry with same key */
+static int putEntry (XRDS_CACHE *cache, CACHE_ENTRY *entry){
+
+	CACHE_ENTRY	*slot;
+	int			result;
+
+	/* keep load factor under one half */
+	if ((cache->count + 1) * 2 > cache->capacity){
+
+		result = growCache (cache);
+		if (result != ztSuccess)
+
+			return result;
+	}
+
+	slot = findSlot (cache, entry->key);
+	if (slot->key == 0)
+		cache->count++;
+
+	*slot = *entry;
+
+	return ztSuccess;
+}
+
+static int isExpired (XRDS_CACHE *cache, CACHE_ENTRY *entry, time_t now){
+
+	return (cache->ttl > 0 && (now - entry->stamp) > cache->ttl);
+}
+
+/* writeEntry(): writes one entry line to filePtr */
+static void writeEntry (FILE *filePtr, CACHE_ENTRY *entry){
+
+	char		buffer[(MAX_NODES + 1) * 2 * (COORD_TEXT_MAX + 1) + 2];
+	char		*ptr = buffer;
+	int		iCount;
+
+	fprintf (filePtr, "%016" PRIx64 " %ld %d", entry->key,
+			    (long) entry->stamp, entry->nodesNum);
+
+	/* lat lon pairs then mid-point, all " %.7f" */
+	for (iCount = 0; iCount <= entry->nodesNum; iCount++){
+
+		GPS	*gps = (iCount < entry->nodesNum) ? &entry->nodes[iCount] : &entry->midGps;
+
+		*ptr++ = ' ';
+		ptr += formatCoordE7 (ptr, gps->latE7, 0);
+		*ptr++ = ' ';
+		ptr += formatCoordE7 (ptr, gps->lonE7, 0);
+	}
+
+	*ptr++ = '\n';
+
+	fwrite (buffer, 1, ptr - buffer, filePtr);
+
+	return;
+}
+
+/* parseEntry(): parses one cache file line into entry.
+ * Return: ztSuccess or ztParseError.
+ *************************************************************************/
+static int parseEntry (CACHE_ENTRY *entry, char *line){
+
+	char		*ptr = line;
+	char		*endPtr;
+	int		iCount;
+	int32_t	*value;
+
+	memset (entry, 0, sizeof(CACHE_ENTRY));
+
+	entry->key = (uint64_t) strtoull (ptr, &endPtr, 16);
+	if (endPtr == ptr || entry->key == 0)
+
+		return ztParseError;
+
+	ptr = endPtr;
+	entry->stamp = (time_t) strtol (ptr, &endPtr, 10);
+	if (endPtr == ptr)
+
+		return ztParseError;
+
+	ptr = endPtr;
+	entry->nodesNum = (int) strtol (ptr, &endPtr, 10);
+	if (endPtr == ptr || entry->nodesNum < 0 || entry->nodesNum > MAX_NODES)
+
+		return ztParseError;
+
+	/* node pairs then midGps; latitude first on each pair, values are read
+	 * by scanCoordE7() - fixed point, space delimited */
+	for (iCount = 0; iCount < 2 * (entry->nodesNum + 1); iCount++){
+
+		if (iCount / 2 < entry->nodesNum)
+			value = IS_EVEN(iCount) ? &entry->nodes[iCount / 2].latE7
+					                    : &entry->nodes[iCount / 2].lonE7;
+		else
+			value = IS_EVEN(iCount) ? &entry->midGps.latE7 : &entry->midGps.lonE7;
+
+		ptr = endPtr;
+		while (*ptr == ' ')
+			ptr++;
+
+		for (endPtr = ptr; *endPtr && *endPtr != ' ' && *endPtr != '\n'; endPtr++)
+			;
+
+		if (scanCoordE7 (value, ptr, endPtr - ptr) != ztSuccess)
+
+			return ztParseError;
+	}
+
+	return ztSuccess;
+}
+
+/* rewriteCacheFile(): writes live entries to filename replacing old file */
+static int rewriteCacheFile (XRDS_CACHE *cache, char *filename){
+
+	char		tmpName[PATH_MAX];
+	FILE		*filePtr;
+	int		iCount;
+
+	snprintf (tmpName, PATH_MAX, "%s.tmp", filename);
+
+	filePtr = fopen (tmpName, "w");
+	if ( ! filePtr ){
+		fprintf(stderr, "rewriteCacheFile(): Error creating file: <%s>: %s\n",
+				    tmpName, strerror(errno));
+		return ztCreateFileErr;
+	}
+
+	for (iCount = 0; iCount < cache->capacity; iCount++)
+
+		if (cache->entries[iCount].key)
+
+			writeEntry (filePtr, &cache->entries[iCount]);
+
+	if (fclose (filePtr) != 0 || rename (tmpName, filename) != 0){
+		fprintf(stderr, "rewriteCacheFile(): Error writing file: <%s>: %s\n",
+				    filename, strerror(errno));
+		remove (tmpName);
+		return ztWriteError;
+	}
+
+	return ztSuccess;
+}
+
+/* openCacheFile(): loads cache file filename into cache - skipping expired
+ * and bad lines - then opens it for appending new results. Missing file is
+ * not an error, it is created. File is compacted when it has lines we did
+ * not keep.
+ * Return: ztSuccess, ztOpenFileError or ztMemoryAllocate.
+ *************************************************************************/
+int openCacheFile (XRDS_CACHE *cache, char *filename){
+
+	FILE			*filePtr;
+	char			line[LONG_LINE];
+	CACHE_ENTRY	entry;
+	int			numLines = 0;
+	int			result;
+	time_t		now = time(NULL);
+
+	ASSERTARGS (cache && cache->entries && filename);
+
+	filePtr = fopen (filename, "r");
+	if (filePtr){
+
+		while (fgets (line, LONG_LINE, filePtr)){
+
+			numLines++;
+
+			if (parseEntry (&entry, line) != ztSuccess || isExpired (cache, &entry, now))
+
+				continue;
+
+			result = putEntry (cache, &entry);
+			if (result != ztSuccess){
+				fclose (filePtr);
+				return result;
+			}
+		}
+
+		fclose (filePtr);
+
+		if (numLines > cache->count)
+
+			rewriteCacheFile (cache, filename); // on failure old file still works
+	}
+
+	cache->filePtr = fopen (filename, "a");
+	if ( ! cache->filePtr ){
+		fprintf(stderr, "openCacheFile(): Error opening cache file: <%s>: %s\n",
+				    filename, strerror(errno));
+		return ztOpenFileError;
+	}
+
+	return ztSuccess;
+}
+
+/* closeCache(): closes cache file if open, frees table */
+void closeCache (XRDS_CACHE *cache){
+
+	ASSERTARGS (cache);
+
+	if (cache->filePtr)
+		fclose (cache->filePtr);
+
+	if (cache->entries)
+		free (cache->entries);
+
+	memset (cache, 0, sizeof(XRDS_CACHE));
+
+	return;
+}
+
+/* queryKey(): 64 bit FNV-1a hash of query string normalized; case folded and
+ * white space runs made one space, leading and trailing white space dropped.
+ * Our queries match names case insensitive, so case does not change result.
+ * Zero is never returned; it marks empty entry.
+ *************************************************************************/
+uint64_t queryKey (const char *query){
+
+	uint64_t		hash = 14695981039346656037ULL;
+	const unsigned char	*ptr;
+	int			pendingSpace = 0;
+
+	ASSERTARGS (query);
+
+	for (ptr = (const unsigned char *) query; *ptr; ptr++){
+
+		if (isspace(*ptr)){
+			pendingSpace = 1;
+			continue;
+		}
+
+		if (pendingSpace && hash != 14695981039346656037ULL){
+			hash ^= ' ';
+			hash *= 1099511628211ULL;
+		}
+		pendingSpace = 0;
+
+		hash ^= (uint64_t) tolower(*ptr);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash ? hash : 1;
+}
+
+/* hashName(): adds name to FNV-1a hash: case folded, leading and trailing
+ * white space dropped, inner white space runs made one space.
+ *************************************************************************/
+static uint64_t hashName (uint64_t hash, const char *name){
+
+	const unsigned char	*ptr;
+	int			pendingSpace = 0;
+	int			started = 0;
+
+	for (ptr = (const unsigned char *) name; *ptr; ptr++){
+
+		if (isspace(*ptr)){
+			pendingSpace = 1;
+			continue;
+		}
+
+		if (pendingSpace && started){
+			hash ^= ' ';
+			hash *= 1099511628211ULL;
+		}
+		pendingSpace = 0;
+		started = 1;
+
+		hash ^= (uint64_t) tolower(*ptr);
+		hash *= 1099511628211ULL;
+	}
+
+	/* end of name marker; "ab" + "c" must differ from "a" + "bc" */
+	hash ^= 0xff;
+	hash *= 1099511628211ULL;
+
+	return hash;
+}
+
+/* pairKey(): 64 bit hash for cross roads in bbox independent of street names
+ * order, case and white space; "A, B" and " b ,a" give the same key since
+ * they have the same common nodes. Zero is never returned.
+ *************************************************************************/
+uint64_t pairKey (XROADS *xrds, BBOX *bbox){
+
+	uint64_t	hash = 14695981039346656037ULL;
+	char		bboxBuf[128];
+	char		*ptr = bboxBuf;
+	char		*first, *second;
+
+	ASSERTARGS (xrds && bbox && xrds->firstRD && xrds->secondRD);
+
+	/* "%.7f,%.7f,%.7f,%.7f" of sw lat, sw lon, ne lat, ne lon */
+	ptr += formatCoordE7 (ptr, bbox->sw.gps.latE7, 0);
+	*ptr++ = ',';
+	ptr += formatCoordE7 (ptr, bbox->sw.gps.lonE7, 0);
+	*ptr++ = ',';
+	ptr += formatCoordE7 (ptr, bbox->ne.gps.latE7, 0);
+	*ptr++ = ',';
+	formatCoordE7 (ptr, bbox->ne.gps.lonE7, 0);
+
+	hash = hashName (hash, bboxBuf);
+
+	/* hash names in one fixed order; names are white space clean here */
+	first = xrds->firstRD;
+	second = xrds->secondRD;
+	if (strcasecmp (first, second) > 0){
+		first = xrds->secondRD;
+		second = xrds->firstRD;
+	}
+
+	hash = hashName (hash, first);
+	hash = hashName (hash, second);
+
+	return hash ? hash : 1;
+}
+
+/* cachePending(): marks key as being queried now in memory only cache; the
+ * entry is replaced by cacheStore() when the result is in.
+ *************************************************************************/
+int cachePending (XRDS_CACHE *cache, uint64_t key){
+
+	CACHE_ENTRY	entry;
+
+	ASSERTARGS (cache && key);
+
+	memset (&entry, 0, sizeof(CACHE_ENTRY));
+	entry.key = key;
+	entry.stamp = CACHE_PENDING;
+
+	return putEntry (cache, &entry);
+}
+
+/* cacheFailed(): marks key as failed in memory only cache; a pending
+ * query given up on. Lookup gives the entry, caller decides what to do.
+ *************************************************************************/
+int cacheFailed (XRDS_CACHE *cache, uint64_t key){
+
+	CACHE_ENTRY	entry;
+
+	ASSERTARGS (cache && key);
+
+	memset (&entry, 0, sizeof(CACHE_ENTRY));
+	entry.key = key;
+	entry.stamp = CACHE_FAILED;
+
+	return putEntry (cache, &entry);
+}
+
+/* cacheLookup(): returns live entry for key or NULL */
+CACHE_ENTRY * cacheLookup (XRDS_CACHE *cache, uint64_t key){
+
+	CACHE_ENTRY	*entry;
+
+	ASSERTARGS (cache && cache->entries);
+
+	entry = findSlot (cache, key);
+	if (entry->key == 0 || isExpired (cache, entry, time(NULL)))
+
+		return NULL;
+
+	return entry;
+}
+
+/* cacheStore(): stores result in xrds under key, appends it to cache file
+ * when one is open.
+ *************************************************************************/
+int cacheStore (XRDS_CACHE *cache, uint64_t key, XROADS *xrds){
+
+	CACHE_ENTRY	entry;
+	int			iCount;
+	int			result;
+
+	ASSERTARGS (cache && xrds && key);
+
+	memset (&entry, 0, sizeof(CACHE_ENTRY));
+
+	entry.key = key;
+	entry.stamp = time(NULL);
+	entry.nodesNum = MIN(xrds->nodesNum, MAX_NODES);
+
+	for (iCount = 0; iCount < entry.nodesNum; iCount++)
+
+		entry.nodes[iCount] = *(xrds->nodesGPS[iCount]);
+
+	if (entry.nodesNum)
+		entry.midGps = *(xrds->midGps);
+
+	result = putEntry (cache, &entry);
+	if (result != ztSuccess)
+
+		return result;
+
+	if (cache->filePtr){
+
+		writeEntry (cache->filePtr, &entry);
+		fflush (cache->filePtr);
+	}
+
+	return ztSuccess;
+}
+
+/* cache2Xrds(): fills dest result members from cache entry */
+void cache2Xrds (XROADS *dest, CACHE_ENTRY *entry){
+
+	int	iCount;
+
+	ASSERTARGS (dest && entry);
+
+	dest->nodesNum = entry->nodesNum;
+
+	for (iCount = 0; iCount < entry->nodesNum; iCount++)
+
+		*(dest->nodesGPS[iCount]) = entry->nodes[iCount];
+
+	if (entry->nodesNum){
+
+		*(dest->midGps) = entry->midGps;
+		dest->point->gps = entry->midGps;
+	}
+
+	dest->status = XRDS_RESOLVED;
+
+	return;
+}
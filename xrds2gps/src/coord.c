@@ -0,0 +1,258 @@
+/*
+ * coord.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Coordinate to text without printf(): GPS values are integer degrees * 10^7
+ * - OSM own precision - so digits are made with integer math right into
+ * caller buffer. Output is the same as "%*.7f" of degrees; nothing is
+ * allocated.
+ * The other way, scanCoordE7() reads decimal degrees text into the same
+ * fixed point value with integer math only - no strtod().
+ */
+
+#include <string.h>
+
+#include "coord.h"
+#include "util.h"
+#include "ztError.h"
+
+/* formatCoordE7(): writes fixed point e7 - degrees * 10^7 - with 7 decimals
+ * into dest right aligned in width characters, then a terminating zero. dest
+ * must have room for MAX(width, COORD_TEXT_MAX) + 1 characters.
+ * Returns length written.
+ */
+int formatCoordE7 (char *dest, int32_t e7, int width){
+
+	char				digits[COORD_TEXT_MAX + 8];
+	char				*ptr = digits + sizeof(digits);
+	long long		value = e7;
+	int				negative = (e7 < 0);
+	int				iCount;
+	int				length;
+
+	ASSERTARGS (dest);
+
+	if (negative)
+		value = -value;
+
+	/* digits are made backward: 7 decimals, point, integer part */
+	for (iCount = 0; iCount < COORD_DECIMALS; iCount++){
+		*--ptr = '0' + (value % 10);
+		value /= 10;
+	}
+
+	*--ptr = '.';
+
+	do {
+		*--ptr = '0' + (value % 10);
+		value /= 10;
+	} while (value);
+
+	if (negative)
+		*--ptr = '-';
+
+	length = digits + sizeof(digits) - ptr;
+
+	if (width > length){
+		memset (dest, ' ', width - length);
+		dest += width - length;
+	}
+
+	memcpy (dest, ptr, length);
+	dest[length] = '\0';
+
+	return MAX(width, length);
+}
+
+/* formatGps(): writes gps as set in format into dest of size bytes.
+ * Returns length written or -1 when dest is too small; dest is always
+ * zero terminated.
+ */
+int formatGps (char *dest, size_t size, GPS *gps, const COORD_FORMAT *format){
+
+	const char	*prefix, *middle, *suffix;
+	size_t		prefixLen, middleLen, suffixLen;
+	size_t		needed;
+	char			*ptr = dest;
+
+	ASSERTARGS (dest && size && gps && format);
+
+	prefix = format->prefix ? format->prefix : "";
+	middle = format->middle ? format->middle : "";
+	suffix = format->suffix ? format->suffix : "";
+
+	prefixLen = strlen (prefix);
+	middleLen = strlen (middle);
+	suffixLen = strlen (suffix);
+
+	needed = prefixLen + middleLen + suffixLen + 1 +
+			   MAX(format->lonWidth, COORD_TEXT_MAX) + MAX(format->latWidth, COORD_TEXT_MAX);
+
+	if (needed > size){
+		dest[0] = '\0';
+		return -1;
+	}
+
+	memcpy (ptr, prefix, prefixLen);
+	ptr += prefixLen;
+
+	ptr += formatCoordE7 (ptr, gps->lonE7, format->lonWidth);
+
+	memcpy (ptr, middle, middleLen);
+	ptr += middleLen;
+
+	ptr += formatCoordE7 (ptr, gps->latE7, format->latWidth);
+
+	memcpy (ptr, suffix, suffixLen);
+	ptr += suffixLen;
+
+	*ptr = '\0';
+
+	return ptr - dest;
+}
+
+/* formatGpsArray(): batch formatGps() for count GPS in gpsArray, format
+ * separator between them. Returns length written or -1 when dest is too
+ * small; dest is always zero terminated.
+ */
+int formatGpsArray (char *dest, size_t size, GPS **gpsArray, int count,
+		             const COORD_FORMAT *format){
+
+	size_t	sepLen;
+	char		*ptr = dest;
+	char		*end = dest + size;
+	int		length;
+	int		iCount;
+
+	ASSERTARGS (dest && size && gpsArray && format);
+
+	sepLen = format->separator ? strlen (format->separator) : 0;
+
+	*ptr = '\0';
+
+	for (iCount = 0; iCount < count; iCount++){
+
+		if (iCount && sepLen){
+
+			if ((size_t) (end - ptr) <= sepLen)
+				return -1;
+
+			memcpy (ptr, format->separator, sepLen);
+			ptr += sepLen;
+			*ptr = '\0';
+		}
+
+		length = formatGps (ptr, end - ptr, gpsArray[iCount], format);
+		if (length < 0)
+			return -1;
+
+		ptr += length;
+	}
+
+	return ptr - dest;
+}
+
+/* scanCoordE7(): parses length characters at str - decimal degrees as
+ * [+|-]digits[.digits] - into e7 as degrees * 10^7; decimals past seventh
+ * are rounded half away from zero. str needs no terminating zero.
+ * Return: ztSuccess, ztDisallowedChar for character not in "0123456789.-+"
+ * or ztInvalidToken for anything else that is not a number - or too big.
+ */
+int scanCoordE7 (int32_t *e7, const char *str, size_t length){
+
+	const char		*ptr = str;
+	const char		*end = str + length;
+	long long		value = 0;
+	int				negative = 0;
+	int				numInt = 0, numFrac = 0;
+	int				roundUp = 0;
+	int				point = 0;
+
+	ASSERTARGS (e7 && str);
+
+	if (ptr < end && (*ptr == '-' || *ptr == '+')){
+		negative = (*ptr == '-');
+		ptr++;
+	}
+
+	for ( ; ptr < end; ptr++){
+
+		if (*ptr >= '0' && *ptr <= '9'){
+
+			if ( ! point ){
+
+				if (++numInt > 3)
+					return ztInvalidToken;
+
+				value = value * 10 + (*ptr - '0');
+			}
+			else if (numFrac < COORD_DECIMALS){
+
+				value = value * 10 + (*ptr - '0');
+				numFrac++;
+			}
+			else if (numFrac++ == COORD_DECIMALS)
+
+				roundUp = (*ptr >= '5');
+
+			continue;
+		}
+
+		if (*ptr == '.' && ! point){
+			point = 1;
+			continue;
+		}
+
+		if (*ptr == '.' || *ptr == '-' || *ptr == '+')
+
+			return ztInvalidToken;
+
+		return ztDisallowedChar;
+	}
+
+	if (numInt + numFrac == 0)
+
+		return ztInvalidToken;
+
+	for ( ; numFrac < COORD_DECIMALS; numFrac++)
+
+		value *= 10;
+
+	value += roundUp;
+
+	if (value > INT32_MAX)
+
+		return ztInvalidToken;
+
+	*e7 = (int32_t) (negative ? -value : value);
+
+	return ztSuccess;
+}
+
+/* gpsCentroid(): sets dest to average of count GPS in gpsArray - integer
+ * sums, rounded half away from zero. dest is not changed for zero count.
+ */
+void gpsCentroid (GPS *dest, GPS **gpsArray, int count){
+
+	int64_t	totalLon = 0, totalLat = 0;
+	int		iCount;
+
+	ASSERTARGS (dest && gpsArray);
+
+	if (count < 1)
+
+		return;
+
+	for (iCount = 0; iCount < count; iCount++){
+
+		totalLon += gpsArray[iCount]->lonE7;
+		totalLat += gpsArray[iCount]->latE7;
+	}
+
+	dest->lonE7 = (int32_t) ((totalLon + (totalLon < 0 ? -count : count) / 2) / count);
+	dest->latE7 = (int32_t) ((totalLat + (totalLat < 0 ? -count : count) / 2) / count);
+
+	return;
+}
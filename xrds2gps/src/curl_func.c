@@ -1,5 +1,8 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <curl/curl.h>
 
 #include "curl_func.h"
@@ -8,6 +11,7 @@
 
 // global variables
 static  int     sessionFlag = 0; // global initial flag
+static  long    queryTimeoutMs = QUERY_TIMEOUT_SECONDS * 1000L; // zero for none
 
 /* initialSession(): checks libcurl version and calls curl_global_init()
  * then sets sessionFlag. Call this function first to use any other
@@ -38,6 +42,9 @@ int initialSession(void){
 
 	}
 
+	/* retry delays are jittered with rand() */
+	srand ((unsigned) time (NULL) ^ (unsigned) getpid ());
+
 	sessionFlag = 1;
 
 	return ztSuccess;
@@ -59,27 +66,123 @@ void closeSession(void){
 	return;
 }
 
+/* initialMemory(): allocates capacity bytes for mem, sets it empty.
+ * Return: ztSuccess or ztMemoryAllocate.
+ **************************************************************************/
+int initialMemory (MEMORY_STRUCT *mem, size_t capacity){
+
+	ASSERTARGS (mem);
+
+	if (capacity < 1)
+		capacity = 1;
+
+	mem->memory = (char *) malloc (capacity);
+	if ( ! mem->memory ){
+		fprintf(stderr, "initialMemory(): Error allocating memory.\n");
+		mem->size = mem->capacity = 0;
+		return ztMemoryAllocate;
+	}
+
+	mem->memory[0] = '\0';
+	mem->size = 0;
+	mem->capacity = capacity;
+
+	return ztSuccess;
+}
+
+/* growMemory(): makes room in mem for needed more bytes plus terminating
+ * '\0'; capacity is doubled until it fits, so a response received in many
+ * chunks costs a few realloc() calls only.
+ * Return: ztSuccess or ztMemoryAllocate; mem is unchanged on error.
+ **************************************************************************/
+int growMemory (MEMORY_STRUCT *mem, size_t needed){
+
+	size_t	newCapacity;
+	char		*ptr;
+
+	ASSERTARGS (mem);
+
+	if (mem->size + needed + 1 <= mem->capacity)
+
+		return ztSuccess;
+
+	newCapacity = mem->capacity ? mem->capacity : MEMORY_INITIAL_SIZE;
+	while (newCapacity < mem->size + needed + 1)
+
+		newCapacity *= 2;
+
+	ptr = realloc (mem->memory, newCapacity);
+	if (ptr == NULL){
+		fprintf(stderr, "growMemory(): Error not enough memory "
+				"(realloc returned NULL)\n");
+		return ztMemoryAllocate;
+	}
+
+	mem->memory = ptr;
+	mem->capacity = newCapacity;
+
+	return ztSuccess;
+}
+
+/* appendMemory(): appends length bytes to mem, keeps it '\0' terminated. */
+int appendMemory (MEMORY_STRUCT *mem, const char *bytes, size_t length){
+
+	int	result;
+
+	ASSERTARGS (mem && bytes);
+
+	result = growMemory (mem, length);
+	if (result != ztSuccess)
+
+		return result;
+
+	memcpy (&(mem->memory[mem->size]), bytes, length);
+	mem->size += length;
+	mem->memory[mem->size] = 0;
+
+	return ztSuccess;
+}
+
+/* resetMemory(): empties mem keeping its allocated memory for next use. */
+void resetMemory (MEMORY_STRUCT *mem){
+
+	ASSERTARGS (mem);
+
+	mem->size = 0;
+	if (mem->memory)
+		mem->memory[0] = '\0';
+
+	return;
+}
+
+/* zapMemory(): frees mem allocated memory, the opposite of initialMemory() */
+void zapMemory (MEMORY_STRUCT *mem){
+
+	ASSERTARGS (mem);
+
+	if (mem->memory)
+		free (mem->memory);
+
+	memset (mem, 0, sizeof(MEMORY_STRUCT));
+
+	return;
+}
+
 /* WriteMemoryCallback(): call back function copied from curl source examples.
+ * Changed to grow memory by doubling; see growMemory().
  **************************************************************************** */
-static size_t WriteMemoryCallback (void *contents, size_t size,
+static size_t WriteMemoryCallback (char *contents, size_t size,
                                             size_t nmemb, void *userp) {
 
   size_t realsize = size * nmemb;
   MEMORY_STRUCT *mem = (MEMORY_STRUCT *) userp;
 
-  char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-  if(ptr == NULL) {
+  if (appendMemory (mem, contents, realsize) != ztSuccess) {
     /* out of memory! */
-    fprintf(stderr, "WriteMemoryCallback(): Error not enough memory "
-    		"(realloc returned NULL)\n");
+    fprintf(stderr, "WriteMemoryCallback(): Error not enough memory\n");
     return 0;
   }
 
-  mem->memory = ptr;
-  memcpy(&(mem->memory[mem->size]), contents, realsize);
-  mem->size += realsize;
-  mem->memory[mem->size] = 0;
-
   return realsize;
 }
 
@@ -115,12 +218,14 @@ CURLU * initialURL (char *server){
 }
 
 /* initialQuery(): gets curl easy handle using curl URL parse handle.
- * Sets basic (common) query options.
+ * Sets basic (common) query options. Handle gets its own receive buffer,
+ * see queryMemory(); call closeQuery() when done with the handle.
  ***************************************************************** */
 CURL * initialQuery (CURLU *serverUrl){  // curl parser url CURLU
 
 	CURL			*qryHandle = NULL;
 	CURLcode 	res;
+	MEMORY_STRUCT	*memory;
 
 	if (sessionFlag == 0){
 		fprintf(stderr, "initialQuery(): Error, session not initialized. You must call\n "
@@ -144,10 +249,68 @@ CURL * initialQuery (CURLU *serverUrl){  // curl parser url CURLU
 		return qryHandle;
 	}
 
+	memory = (MEMORY_STRUCT *) malloc (sizeof(MEMORY_STRUCT));
+	if ( ! memory || initialMemory (memory, MEMORY_INITIAL_SIZE) != ztSuccess ){
+		fprintf(stderr, "initialQuery(): Error allocating receive buffer.\n");
+		if (memory)
+			free (memory);
+		easyCleanup(qryHandle);
+		qryHandle = NULL;
+		return qryHandle;
+	}
+
+	curl_easy_setopt (qryHandle, CURLOPT_PRIVATE, (void *) memory);
+
 	return qryHandle;
 
 }
 
+/* queryMemory(): returns receive buffer for handle made by initialQuery() */
+MEMORY_STRUCT * queryMemory (CURL *qh){
+
+	MEMORY_STRUCT	*memory = NULL;
+
+	ASSERTARGS (qh);
+
+	curl_easy_getinfo (qh, CURLINFO_PRIVATE, (char **) &memory);
+
+	ASSERTARGS (memory);
+
+	return memory;
+}
+
+/* closeQuery(): frees receive buffer and cleans up handle from initialQuery() */
+void closeQuery (CURL *qh){
+
+	MEMORY_STRUCT	*memory;
+
+	ASSERTARGS (qh);
+
+	memory = queryMemory (qh);
+	zapMemory (memory);
+	free (memory);
+
+	easyCleanup (qh);
+
+	return;
+}
+
+/* setQueryTimeout(): sets limit on time for each query to ms milliseconds,
+ * zero for none; it applies to handles made by initialQuery() after this.
+ */
+void setQueryTimeout (long ms){
+
+	queryTimeoutMs = (ms > 0) ? ms : 0;
+
+	return;
+}
+
+/* getQueryTimeout(): returns query time limit in milliseconds, 0 for none */
+long getQueryTimeout (void){
+
+	return queryTimeoutMs;
+}
+
 /* queryBasicOptions(): sets query basic options
 ************************************************************************** */
 CURLcode queryBasicOptions (CURL *qH, CURLU *serverUrl){
@@ -193,6 +356,13 @@ CURLcode queryBasicOptions (CURL *qH, CURLU *serverUrl){
 		return res;
 	}
 
+	res = curl_easy_setopt(qH, CURLOPT_TIMEOUT_MS, queryTimeoutMs);
+	if(res != CURLE_OK) {
+		fprintf(stderr, "queryBasicOptions() failed to set TIMEOUT_MS "
+	   				  "{CURLOPT_TIMEOUT_MS}: %s\n", curl_easy_strerror(res));
+		return res;
+	}
+
 	res = curl_easy_setopt(qH, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
 	if(res != CURLE_OK) {
 		fprintf(stderr, "queryBasicOptions() failed to set WRITEFUNCTION "
@@ -204,22 +374,29 @@ CURLcode queryBasicOptions (CURL *qH, CURLU *serverUrl){
 
 }
 
-/* performQuery(): executes query on the srvrURL, writes results in memory
- * defined in answer pointer.
+/* prepareQueryWrite(): sets query for easy handle qh without performing the
+ * transfer; received data is passed to writeFunc with writeData as its last
+ * argument as it arrives. Used by callers who drive handles with curl multi
+ * interface and by performQueryWrite().
  *****************************************************************************/
 
-int performQuery (MEMORY_STRUCT *answer, char *query, CURLU *srvrURL, CURL *qh){
+int prepareQueryWrite (char *query, CURL *qh,
+		                          curl_write_callback writeFunc, void *writeData){
 
 	CURLcode	result;
 
-	ASSERTARGS (answer && query && srvrURL && qh);
+	ASSERTARGS (query && qh && writeFunc);
 
-	answer->memory = malloc(1); /* should check return, lazy ass! */
-	answer->size = 0;
+	result = curl_easy_setopt(qh, CURLOPT_WRITEFUNCTION, writeFunc);
+	if(result != CURLE_OK) {
+		fprintf(stderr, "prepareQueryWrite() failed to set WRITEFUNCTION "
+	   				  "{CURLOPT_WRITEFUNCTION}: %s\n", curl_easy_strerror(result));
+		return result;
+	}
 
-	result = curl_easy_setopt(qh, CURLOPT_WRITEDATA, (void *)answer);
+	result = curl_easy_setopt(qh, CURLOPT_WRITEDATA, writeData);
 	if(result != CURLE_OK) {
-		fprintf(stderr, "performQuery() failed to set WRITEDATA "
+		fprintf(stderr, "prepareQueryWrite() failed to set WRITEDATA "
 	   				  "{CURLOPT_WRITEDATA}: %s\n", curl_easy_strerror(result));
 		return result;
 	}
@@ -227,28 +404,354 @@ int performQuery (MEMORY_STRUCT *answer, char *query, CURLU *srvrURL, CURL *qh){
 	// what to POST -- third parameter is the pointer to our query string
 	result = curl_easy_setopt(qh, CURLOPT_POSTFIELDS, query);
 	if (result != CURLE_OK) {
-		fprintf(stderr, "performQuery() failed to set POSTFIELD "
+		fprintf(stderr, "prepareQueryWrite() failed to set POSTFIELD "
 				"{CURLOPT_POSTFIELDS}: %s\n", curl_easy_strerror(result));
 
 		return result;
 	}
 
-	/* get it! */
+	return ztSuccess;
+}
+
+/* prepareQuery(): as prepareQueryWrite() with received data written to
+ * memory in answer. answer is emptied here; it must be zeroed or initialed
+ * with initialMemory() - queryMemory(qh) is a good choice.
+ *****************************************************************************/
+
+int prepareQuery (MEMORY_STRUCT *answer, char *query, CURL *qh){
+
+	ASSERTARGS (answer && query && qh);
+
+	/* keep answer memory from last query; allocate only the first time */
+	if (answer->memory)
+		resetMemory (answer);
+	else if (initialMemory (answer, MEMORY_INITIAL_SIZE) != ztSuccess)
+		return ztMemoryAllocate;
+
+	return prepareQueryWrite (query, qh, WriteMemoryCallback, (void *) answer);
+}
+
+/* queryFailure(): classifies finished transfer on handle qh from its
+ * CURLcode result and HTTP response code. QUERY_BAD_ANSWER is never
+ * returned here - HTTP 200 with a body that is not ours is found by the
+ * caller checking response header; isOkResponse() or finishXrdsParser().
+ *****************************************************************************/
+QUERY_FAILURE queryFailure (CURL *qh, CURLcode result){
+
+	long		httpCode = 0;
+
+	ASSERTARGS (qh);
+
+	if (result != CURLE_OK)
+
+		return QUERY_TRANSPORT;
+
+	curl_easy_getinfo (qh, CURLINFO_RESPONSE_CODE, &httpCode);
+
+	if (httpCode == 429)
+
+		return QUERY_RATE_LIMIT;
+
+	if (httpCode >= 500)
+
+		return QUERY_GATEWAY;
+
+	if (httpCode >= 400)
+
+		return QUERY_REJECTED;
+
+	return QUERY_OK;
+}
+
+/* failureName(): returns short description for failure */
+const char * failureName (QUERY_FAILURE failure){
+
+	switch (failure){
+
+	case QUERY_OK:
+		return "done";
+
+	case QUERY_TRANSPORT:
+		return "transport error";
+
+	case QUERY_RATE_LIMIT:
+		return "rate limited (HTTP 429)";
+
+	case QUERY_GATEWAY:
+		return "server error (HTTP 5xx)";
+
+	case QUERY_BAD_ANSWER:
+		return "bad response";
+
+	case QUERY_REJECTED:
+		return "rejected (HTTP 4xx)";
+
+	case QUERY_CANCELLED:
+		return "cancelled";
+
+	default:
+		return "unknown failure";
+	}
+}
+
+/* retryDelayMs(): milliseconds to wait before next try after failure on
+ * try number tries - first try is one. Delay doubles with each try from
+ * RETRY_BASE_MS - RETRY_LIMIT_BASE_MS for rate limit - up to RETRY_MAX_MS,
+ * then it is jittered to between half and one and a half of that, so
+ * queries failing together are not tried again together.
+ *****************************************************************************/
+long retryDelayMs (QUERY_FAILURE failure, int tries){
+
+	long		delay;
+
+	delay = (failure == QUERY_RATE_LIMIT) ? RETRY_LIMIT_BASE_MS : RETRY_BASE_MS;
+
+	while (--tries > 0 && delay < RETRY_MAX_MS)
+
+		delay *= 2;
+
+	delay = MIN(delay, RETRY_MAX_MS);
+
+	return delay / 2 + (long) (((double) rand () / ((double) RAND_MAX + 1.0)) * delay);
+}
+
+/* pauseMs(): sleeps for ms milliseconds */
+void pauseMs (long ms){
+
+	struct timespec	request;
+
+	if (ms <= 0)
+
+		return;
+
+	request.tv_sec = ms / 1000;
+	request.tv_nsec = (ms % 1000) * 1000000L;
+
+	while (nanosleep (&request, &request) != 0)
+		;
+
+	return;
+}
+
+/* performQueryWrite(): executes query on the srvrURL, received data is passed
+ * to writeFunc as it arrives; see prepareQueryWrite(). Query is tried once;
+ * data already passed to writeFunc can not be taken back.
+ * Return: ztSuccess, ztNoConnError for transport error - HTTP error response
+ * is passed to writeFunc, which checks response header - or prepare error.
+ *****************************************************************************/
+
+int performQueryWrite (char *query, CURLU *srvrURL, CURL *qh,
+		                            curl_write_callback writeFunc, void *writeData){
+
+	CURLcode	result;
+	int		prepared;
+
+	ASSERTARGS (query && srvrURL && qh && writeFunc);
+
+	prepared = prepareQueryWrite (query, qh, writeFunc, writeData);
+	if (prepared != ztSuccess)
+
+		return prepared;
+
 	result = curl_easy_perform(qh);
 
-	/* check for errors */
-	if (result != CURLE_OK) {
-		fprintf(stderr, "performQuery() failed call to curl_easy_perform!!: %s\n",
+	if (result != CURLE_OK){
+		fprintf(stderr, "performQueryWrite() failed call to curl_easy_perform!!: %s\n",
 				curl_easy_strerror(result));
+		return ztNoConnError;
 	}
 
-	else {
+	return ztSuccess;
+}
+
+/* hasHeader(): TRUE when first line in answer is header. */
+static int hasHeader (MEMORY_STRUCT *answer, char *header){
+
+	size_t	length = strlen (header);
+
+	return answer->size >= length &&
+			strncmp (MEMORY_BYTES(answer), header, length) == 0 &&
+			(MEMORY_BYTES(answer)[length] == '\n' || MEMORY_BYTES(answer)[length] == '\0');
+}
+
+/* performQuery(): executes query on the srvrURL, writes results in memory
+ * defined in answer pointer. With header not NULL, answer must start with
+ * header line; else it is a bad answer - Overpass error page. Transport
+ * error, rate limit, server error and bad answer are tried again - up to
+ * NUM_TRIES tries with retryDelayMs() wait between.
+ * Return: ztSuccess, ztNoConnError when transport still fails, else
+ * ztInvalidResponse for HTTP error response or bad answer; server response
+ * is printed.
+ *****************************************************************************/
+
+int performQuery (MEMORY_STRUCT *answer, char *query, char *header, CURLU *srvrURL, CURL *qh){
 
-		printf("performQuery(): Done.  "
-				"%u bytes retrieved\n\n", (unsigned) answer->size);
+	CURLcode		result;
+	QUERY_FAILURE	failure;
+	long			delay;
+	int			prepared;
+	int			tries;
 
+	ASSERTARGS (answer && query && srvrURL && qh);
+
+	for (tries = 1; ; tries++){
+
+		prepared = prepareQuery (answer, query, qh);
+		if (prepared != ztSuccess)
+
+			return prepared;
+
+		/* get it! */
+		result = curl_easy_perform(qh);
+
+		failure = queryFailure (qh, result);
+		if (failure == QUERY_OK && header && ! hasHeader (answer, header))
+			failure = QUERY_BAD_ANSWER;
+
+		if (failure == QUERY_OK)
+
+			break;
+
+		/* check for errors */
+		if (result != CURLE_OK)
+			fprintf(stderr, "performQuery() failed call to curl_easy_perform!!: %s\n",
+					curl_easy_strerror(result));
+		else
+			fprintf(stderr, "performQuery(): Error query %s.\n", failureName (failure));
+
+		if (failure == QUERY_REJECTED || tries == NUM_TRIES){
+
+			if (failure == QUERY_TRANSPORT)
+
+				return ztNoConnError;
+
+			printf (" Start server response below >>>>:\n\n");
+			printf ("%s\n\n", MEMORY_BYTES(answer));
+			printf (" >>>> End server response This line is NOT included.\n\n");
+
+			return ztInvalidResponse;
+		}
+
+		delay = retryDelayMs (failure, tries);
+
+		fprintf(stderr, "performQuery(): Try [%d of %d] failed, trying again in %ld ms.\n",
+				tries, NUM_TRIES, delay);
+
+		pauseMs (delay);
 	}
 
+	printf("performQuery(): Done.  "
+			"%u bytes retrieved\n\n", (unsigned) answer->size);
+
 	return ztSuccess;
 
 }
+
+/* statusURL(): makes /api/status URL from interpreter URL srvrURL - last
+ * path part replaced with "status". Caller must call urlCleanup().
+ */
+static CURLU * statusURL (CURLU *srvrURL){
+
+	CURLU	*url;
+	char		*path = NULL;
+	char		*slash;
+	char		newPath[LONG_LINE];
+
+	url = curl_url_dup (srvrURL);
+	if ( ! url )
+
+		return NULL;
+
+	if (curl_url_get (url, CURLUPART_PATH, &path, 0) != CURLUE_OK ||
+		strlen (path) >= sizeof(newPath) - strlen ("status")){
+
+		if (path)
+			curl_free (path);
+		urlCleanup (url);
+		return NULL;
+	}
+
+	slash = strrchr (path, '/');
+	snprintf (newPath, sizeof(newPath), "%.*sstatus", slash ? (int) (slash - path + 1) : 1,
+			     slash ? path : "/");
+	curl_free (path);
+
+	if (curl_url_set (url, CURLUPART_PATH, newPath, 0) != CURLUE_OK){
+		urlCleanup (url);
+		return NULL;
+	}
+
+	return url;
+}
+
+/* getServerStatus(): asks Overpass server at srvrURL for our query slots on
+ * its /api/status page; sets rateLimit to "Rate limit:" value - zero for no
+ * limit - and available to slots "available now". Waits no more than
+ * STATUS_TIMEOUT_MS; not all servers have the status page.
+ * Return: ztSuccess, ztNoConnError, ztInvalidResponse for HTTP error, or
+ * ztParseError when page has no rate limit line.
+ *****************************************************************************/
+int getServerStatus (CURLU *srvrURL, int *rateLimit, int *available){
+
+	CURLU			*url;
+	CURL				*handle;
+	MEMORY_STRUCT	*answer;
+	CURLcode			result;
+	char				*line;
+	int				slots;
+	int				retCode = ztSuccess;
+
+	ASSERTARGS (srvrURL && rateLimit && available);
+
+	url = statusURL (srvrURL);
+	if ( ! url ){
+		fprintf(stderr, "getServerStatus(): Error making status URL.\n");
+		return ztGotNull;
+	}
+
+	handle = initialQuery (url);
+	if ( ! handle ){
+		urlCleanup (url);
+		return ztGotNull;
+	}
+
+	answer = queryMemory (handle);
+	resetMemory (answer);
+
+	curl_easy_setopt (handle, CURLOPT_HTTPGET, 1L);
+	curl_easy_setopt (handle, CURLOPT_TIMEOUT_MS, (long) STATUS_TIMEOUT_MS);
+	curl_easy_setopt (handle, CURLOPT_WRITEDATA, (void *) answer);
+
+	result = curl_easy_perform (handle);
+
+	if (queryFailure (handle, result) != QUERY_OK){
+
+		retCode = (result != CURLE_OK) ? ztNoConnError : ztInvalidResponse;
+		goto cleanup;
+	}
+
+	line = strstr (MEMORY_BYTES(answer), "Rate limit:");
+	if ( ! line || sscanf (line, "Rate limit: %d", rateLimit) != 1 ){
+
+		retCode = ztParseError;
+		goto cleanup;
+	}
+
+	*available = 0;
+	for (line = MEMORY_BYTES(answer); line; line = strchr (line, '\n')){
+
+		if (*line == '\n')
+			line++;
+
+		if (sscanf (line, "%d slots available now", &slots) == 1)
+			*available = slots;
+	}
+
+cleanup:
+
+	closeQuery (handle);
+	urlCleanup (url);
+
+	return retCode;
+
+} // END getServerStatus()
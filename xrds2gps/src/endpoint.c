@@ -0,0 +1,543 @@
+/*
+ * endpoint.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Overpass server endpoints: a list of identical servers given on command
+ * line or in a file. Each query goes to the healthy endpoint with fewest
+ * queries outstanding. An endpoint failing EJECT_FAILURES queries in a row -
+ * no connection or server error - is ejected; its connection is checked
+ * every PROBE_INTERVAL_MS and it is readmitted once it answers. Inside a
+ * multi handle run the check is a connect only transfer in the same multi
+ * handle, see startProbes(), so transfers in flight never wait on it;
+ * between runs it is checkURL(). With no endpoint healthy queries are not
+ * sent; they wait for a probe to readmit one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <curl/curl.h>
+
+#include "endpoint.h"
+#include "network.h"
+#include "fileio.h"
+#include "curl_func.h"
+#include "util.h"
+#include "ztError.h"
+
+/* initialEndpointPool(): sets pool empty */
+void initialEndpointPool (ENDPOINT_POOL *pool){
+
+	ASSERTARGS (pool);
+
+	memset (pool, 0, sizeof(ENDPOINT_POOL));
+
+	return;
+}
+
+/* addEndpoint(): adds server URL to pool; it is taken healthy until checked.
+ * Return: ztSuccess, ztOutOfRangePara for full pool, ztInvalidArg for bad
+ * URL, ztParseError or ztMemoryAllocate.
+ *************************************************************************/
+int addEndpoint (ENDPOINT_POOL *pool, char *server){
+
+	ENDPOINT		*endpoint;
+	CURLUcode	rc;
+
+	ASSERTARGS (pool && server);
+
+	if (pool->count == MAX_ENDPOINTS){
+		fprintf (stderr, "addEndpoint(): Error too many servers; most is %d.\n", MAX_ENDPOINTS);
+		return ztOutOfRangePara;
+	}
+
+	endpoint = &pool->endpoint[pool->count];
+	memset (endpoint, 0, sizeof(ENDPOINT));
+
+	endpoint->server = strdup (server);
+	if ( ! endpoint->server ){
+		fprintf (stderr, "addEndpoint(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	endpoint->url = initialURL (server);
+	if ( ! endpoint->url ){
+		fprintf (stderr, "addEndpoint(): Error invalid server URL: <%s>\n", server);
+		free (endpoint->server);
+		return ztInvalidArg;
+	}
+
+	rc = curl_url_get (endpoint->url, CURLUPART_HOST, &endpoint->host, 0);
+	if (rc == CURLUE_OK)
+		rc = curl_url_get (endpoint->url, CURLUPART_PORT, &endpoint->port, CURLU_DEFAULT_PORT);
+
+	if (rc != CURLUE_OK){
+		fprintf (stderr, "addEndpoint(): Error could not get server name and port for <%s>: %s\n",
+				    server, curl_url_strerror(rc));
+		if (endpoint->host)
+			curl_free (endpoint->host);
+		urlCleanup (endpoint->url);
+		free (endpoint->server);
+		return ztParseError;
+	}
+
+	endpoint->healthy = 1;
+	pool->count++;
+
+	return ztSuccess;
+}
+
+/* readEndpointFile(): adds servers listed in filename to pool, one URL per
+ * line; blank and comment lines are skipped - see nextLineView().
+ * Return: ztSuccess, ztFileEmpty for no server in file or addEndpoint() or
+ * file error.
+ *************************************************************************/
+int readEndpointFile (ENDPOINT_POOL *pool, char *filename){
+
+	MAPPED_FILE	mapped;
+	LINE_VIEW	view;
+	char			server[URL_NAME_LENGTH];
+	char			*end;
+	int			numServers = 0;
+	int			result;
+
+	ASSERTARGS (pool && filename);
+
+	result = openMappedFile (&mapped, filename);
+	if (result != ztSuccess){
+		fprintf (stderr, "readEndpointFile(): Error opening servers file: <%s>\n", filename);
+		return result;
+	}
+
+	while (nextLineView (&mapped, &view)){
+
+		result = lineView2Str (server, sizeof(server), &view);
+		if (result != ztSuccess){
+			fprintf (stderr, "readEndpointFile(): Error line [%d] is too long in <%s>\n",
+					    view.lineNum, filename);
+			break;
+		}
+
+		for (end = server + strlen (server); end > server && strchr (" \t\r", end[-1]); end--)
+			;
+		*end = '\0';
+
+		result = addEndpoint (pool, server);
+		if (result != ztSuccess){
+			fprintf (stderr, "readEndpointFile(): Error in line [%d] in <%s>\n",
+					    view.lineNum, filename);
+			break;
+		}
+
+		numServers++;
+	}
+
+	closeMappedFile (&mapped);
+
+	if (result == ztSuccess && numServers == 0){
+		fprintf (stderr, "readEndpointFile(): Error no server in file: <%s>\n", filename);
+		result = ztFileEmpty;
+	}
+
+	return result;
+}
+
+/* probeEndpoint(): checks we can connect to endpoint server and port */
+static int probeEndpoint (ENDPOINT *endpoint){
+
+	char		*ipBuf = NULL;
+	int		result;
+
+	result = checkURL (endpoint->host, endpoint->port, &ipBuf); /* network.c */
+
+	if (ipBuf)
+		free (ipBuf);
+
+	return result;
+}
+
+/* checkEndpoints(): checks connection to each server in pool; unreachable
+ * ones start ejected. Return: ztSuccess when one server at least is
+ * reachable, else ztNoConnError.
+ *************************************************************************/
+int checkEndpoints (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+	int		numUp = 0;
+	int		result;
+
+	ASSERTARGS (pool);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		result = probeEndpoint (endpoint);
+
+		endpoint->healthy = (result == ztSuccess);
+		if (endpoint->healthy){
+			numUp++;
+			continue;
+		}
+
+		fprintf (stderr, "checkEndpoints(): Error SERVER: (%s) is NOT reachable.\n",
+				    endpoint->server);
+		fprintf (stderr, " The error was: %s\n", code2Msg(result));
+
+		endpoint->nextProbe = nowMs () + PROBE_INTERVAL_MS;
+		endpoint->probeFailures = 1;
+	}
+
+	if (numUp == 0)
+
+		return ztNoConnError;
+
+	if (pool->count > 1)
+		printf ("checkEndpoints(): [ %d ] of [ %d ] servers are reachable.\n",
+				   numUp, pool->count);
+
+	return ztSuccess;
+}
+
+/* probeResult(): readmits endpoint when probe connected, else it waits
+ * another PROBE_INTERVAL_MS.
+ */
+static void probeResult (ENDPOINT *endpoint, int connected){
+
+	if (connected){
+
+		endpoint->healthy = 1;
+		endpoint->failures = 0;
+		endpoint->probeFailures = 0;
+		printf ("probeResult(): Server <%s> answers again; readmitted.\n",
+				   endpoint->server);
+	}
+	else {
+
+		endpoint->probeFailures++;
+		endpoint->nextProbe = nowMs () + PROBE_INTERVAL_MS;
+	}
+
+	return;
+}
+
+/* probeEjected(): checks ejected endpoints due for a probe with checkURL();
+ * blocks, so it is used outside multi handle runs only.
+ */
+static void probeEjected (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+	double	now = 0.0;
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		if (endpoint->healthy)
+
+			continue;
+
+		if (now == 0.0)
+			now = nowMs ();
+
+		if (endpoint->nextProbe > now)
+
+			continue;
+
+		probeResult (endpoint, probeEndpoint (endpoint) == ztSuccess);
+	}
+
+	return;
+}
+
+/* startProbes(): adds a connect only transfer to multiHandle for each
+ * ejected endpoint due for a probe; call probeDone() for each finished
+ * transfer. Returns ztSuccess or ztGotNull when a handle can not be made.
+ *************************************************************************/
+int startProbes (ENDPOINT_POOL *pool, CURLM *multiHandle){
+
+	ENDPOINT	*endpoint;
+	double	now = 0.0;
+
+	ASSERTARGS (pool && multiHandle);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		if (endpoint->healthy || endpoint->probe)
+
+			continue;
+
+		if (now == 0.0)
+			now = nowMs ();
+
+		if (endpoint->nextProbe > now)
+
+			continue;
+
+		endpoint->probe = curl_easy_init ();
+		if ( ! endpoint->probe ){
+			fprintf (stderr, "startProbes(): Error returned from curl_easy_init().\n");
+			return ztGotNull;
+		}
+
+		curl_easy_setopt (endpoint->probe, CURLOPT_CURLU, endpoint->url);
+		curl_easy_setopt (endpoint->probe, CURLOPT_CONNECT_ONLY, 1L);
+		curl_easy_setopt (endpoint->probe, CURLOPT_CONNECTTIMEOUT_MS, (long) PROBE_INTERVAL_MS);
+
+		if (curl_multi_add_handle (multiHandle, endpoint->probe) != CURLM_OK){
+			fprintf (stderr, "startProbes(): Error returned from curl_multi_add_handle().\n");
+			curl_easy_cleanup (endpoint->probe);
+			endpoint->probe = NULL;
+			return ztGotNull;
+		}
+	}
+
+	return ztSuccess;
+}
+
+/* probeDone(): when handle is a probe from startProbes(), removes it from
+ * multiHandle, readmits its endpoint when it connected and returns TRUE;
+ * FALSE for any other handle.
+ *************************************************************************/
+int probeDone (ENDPOINT_POOL *pool, CURLM *multiHandle, CURL *handle, CURLcode result){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool && multiHandle && handle);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		if (endpoint->probe != handle)
+
+			continue;
+
+		curl_multi_remove_handle (multiHandle, handle);
+		curl_easy_cleanup (handle);
+		endpoint->probe = NULL;
+
+		probeResult (endpoint, result == CURLE_OK);
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* stopProbes(): removes probes still running from multiHandle; endpoints
+ * stay ejected and are probed again when due.
+ */
+void stopProbes (ENDPOINT_POOL *pool, CURLM *multiHandle){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool && multiHandle);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		if ( ! endpoint->probe )
+
+			continue;
+
+		curl_multi_remove_handle (multiHandle, endpoint->probe);
+		curl_easy_cleanup (endpoint->probe);
+		endpoint->probe = NULL;
+	}
+
+	return;
+}
+
+/* numHealthy(): number of endpoints not ejected */
+int numHealthy (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+	int		count = 0;
+
+	ASSERTARGS (pool);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++)
+
+		count += (endpoint->healthy != 0);
+
+	return count;
+}
+
+/* nextProbeMs(): milliseconds from now until next probe is due, zero when
+ * one is due now; -1 when no endpoint waits for a probe.
+ */
+double nextProbeMs (ENDPOINT_POOL *pool, double now){
+
+	ENDPOINT	*endpoint;
+	double	wait = -1.0;
+
+	ASSERTARGS (pool);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		if (endpoint->healthy || endpoint->probe)
+
+			continue;
+
+		if (wait < 0 || endpoint->nextProbe - now < wait)
+			wait = MAX(endpoint->nextProbe - now, 0.0);
+	}
+
+	return wait;
+}
+
+/* isPoolDown(): TRUE when no endpoint is healthy and each one failed
+ * NUM_TRIES probes in a row; queries waiting for a server are given up.
+ */
+int isPoolDown (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++)
+
+		if (endpoint->healthy || endpoint->probeFailures < NUM_TRIES)
+
+			return FALSE;
+
+	return TRUE;
+}
+
+/* leastOutstanding(): healthy endpoint with fewest queries in flight, ties
+ * go round robin; avoid is taken only when no other one is healthy. NULL
+ * when all are ejected.
+ */
+static ENDPOINT * leastOutstanding (ENDPOINT_POOL *pool, ENDPOINT *avoid){
+
+	ENDPOINT	*endpoint;
+	ENDPOINT	*best = NULL;
+	int		iCount;
+
+	for (iCount = 0; iCount < pool->count; iCount++){
+
+		endpoint = &pool->endpoint[(pool->next + iCount) % pool->count];
+
+		if ( ! endpoint->healthy )
+
+			continue;
+
+		if ( ! best || (best == avoid && endpoint != avoid) ||
+			(endpoint != avoid && endpoint->outstanding < best->outstanding) )
+			best = endpoint;
+	}
+
+	return best;
+}
+
+/* pickEndpoint(): returns endpoint for next query and counts it outstanding;
+ * call endpointDone() with query outcome. avoid - may be NULL - is picked
+ * only when no other endpoint is healthy; hedge goes to another server.
+ * Returns NULL with all endpoints ejected; query is not sent, it waits for
+ * a probe to readmit one - see startProbes() and isPoolDown().
+ *************************************************************************/
+ENDPOINT * pickEndpoint (ENDPOINT_POOL *pool, ENDPOINT *avoid){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool && pool->count);
+
+	endpoint = leastOutstanding (pool, avoid);
+	if ( ! endpoint )
+
+		return NULL;
+
+	pool->next = (pool->next + 1) % pool->count;
+
+	endpoint->outstanding++;
+	endpoint->numQueries++;
+
+	return endpoint;
+}
+
+/* endpointDone(): query on endpoint is over with failure; no connection and
+ * server error count toward ejection, a good answer resets the count. Rate
+ * limit, bad answer, rejected and cancelled query say nothing about server
+ * health.
+ *************************************************************************/
+void endpointDone (ENDPOINT_POOL *pool, ENDPOINT *endpoint, QUERY_FAILURE failure){
+
+	ASSERTARGS (pool && endpoint);
+
+	endpoint->outstanding--;
+
+	if (failure == QUERY_OK){
+
+		endpoint->failures = 0;
+		return;
+	}
+
+	if (failure != QUERY_TRANSPORT && failure != QUERY_GATEWAY)
+
+		return;
+
+	endpoint->failures++;
+	endpoint->numFailed++;
+
+	if (endpoint->healthy && endpoint->failures >= EJECT_FAILURES){
+
+		endpoint->healthy = 0;
+		endpoint->nextProbe = nowMs () + PROBE_INTERVAL_MS;
+
+		printf ("endpointDone(): Server <%s> failed [ %d ] queries in a row; ejected.\n",
+				   endpoint->server, endpoint->failures);
+	}
+
+	return;
+}
+
+/* endpointURL(): URL for a single query outside pickEndpoint() balancing -
+ * the healthy endpoint with fewest queries in flight, first one when none
+ * is healthy. Ejected endpoints due for a probe are checked first.
+ */
+CURLU * endpointURL (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool && pool->count);
+
+	probeEjected (pool);
+
+	endpoint = leastOutstanding (pool, NULL);
+	if ( ! endpoint )
+		endpoint = &pool->endpoint[0];
+
+	return endpoint->url;
+}
+
+/* printEndpoints(): prints queries sent to each endpoint and its state */
+void printEndpoints (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++)
+
+		printf ("Server <%s>: [ %ld ] queries, [ %ld ] failed%s\n",
+				   endpoint->server, endpoint->numQueries, endpoint->numFailed,
+				   endpoint->healthy ? "" : "; ejected");
+
+	return;
+}
+
+/* zapEndpointPool(): frees all memory in pool, it is empty after. */
+void zapEndpointPool (ENDPOINT_POOL *pool){
+
+	ENDPOINT	*endpoint;
+
+	ASSERTARGS (pool);
+
+	for (endpoint = pool->endpoint; endpoint < pool->endpoint + pool->count; endpoint++){
+
+		curl_free (endpoint->host);
+		curl_free (endpoint->port);
+		urlCleanup (endpoint->url);
+		free (endpoint->server);
+	}
+
+	initialEndpointPool (pool);
+
+	return;
+}
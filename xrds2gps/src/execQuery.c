@@ -0,0 +1,501 @@
+/*
+ * execQuery.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Local query program backend: with Overpass on this machine each query
+ * can skip libcurl, the web server and the CGI layer. Query from
+ * xrdsFillTemplate() is written to stdin of a child process running the
+ * local query program - osm3s_query talking to the dispatcher - and CSV
+ * answer on its stdout goes through XRDS_PARSER as with server answers.
+ * Up to schedule jobs children run at once, their pipes are served with
+ * poll(). A child exiting with error, with an answer parser does not take
+ * or running over getQueryTimeout() is tried again up to NUM_TRIES tries.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/wait.h>
+
+#include "execQuery.h"
+#include "overpass-c.h"
+#include "op_string.h"
+#include "curl_func.h"
+#include "util.h"
+#include "ztError.h"
+
+/* closeFd(): closes file descriptor fd if open and sets it -1 */
+static void closeFd (int *fd){
+
+	if (*fd >= 0)
+		close (*fd);
+
+	*fd = -1;
+
+	return;
+}
+
+/* startExec(): starts child for xrds query on slot.
+ * Return: ztSuccess, ztMemoryAllocate or ztChildProcessFailed.
+ */
+static int startExec (EXEC_SLOT *slot, XROADS *xrds, int index, BBOX *bbox, char *execPath){
+
+	char		*argList[2];
+
+	resetArena (&slot->arena);
+
+	slot->query = xrdsFillTemplate (xrds, bbox, &slot->arena);
+	if ( ! slot->query ){
+		fprintf(stderr, "startExec(): Error returned from xrdsFillTemplate().\n");
+		return ztMemoryAllocate;
+	}
+
+	slot->length = strlen (slot->query);
+	slot->written = 0;
+
+	initialXrdsParser (&slot->parser, xrds, rawDataFP ? &slot->raw : NULL);
+
+	argList[0] = execPath;
+	argList[1] = NULL;
+
+	slot->pid = spawnPipes (execPath, argList, &slot->toChild, &slot->fromChild);
+	if (slot->pid < 0){
+		fprintf(stderr, "startExec(): Error starting <%s>: %s\n", execPath, strerror (errno));
+		slot->toChild = slot->fromChild = -1;
+		return ztChildProcessFailed;
+	}
+
+	slot->xrds = xrds;
+	slot->index = index;
+	slot->started = nowMs ();
+	slot->busy = 1;
+
+	return ztSuccess;
+}
+
+/* stopExec(): closes slot pipes, kills child - and all it started - when
+ * force is set and waits for it. Returns child exit code, -1 when it did not exit by itself.
+ */
+static int stopExec (EXEC_SLOT *slot, int force){
+
+	int		status;
+
+	closeFd (&slot->toChild);
+	closeFd (&slot->fromChild);
+
+	if (force)
+		kill (-slot->pid, SIGKILL);
+
+	slot->busy = 0;
+
+	if (waitpid (slot->pid, &status, 0) < 0 || ! WIFEXITED(status))
+
+		return -1;
+
+	return WEXITSTATUS(status);
+}
+
+/* serveSlot(): writes what query is left to child stdin and reads answer
+ * from child stdout - as much as pipes take now - for poll() events.
+ */
+static void serveSlot (EXEC_SLOT *slot, short inEvents, short outEvents){
+
+	char		buffer[EXEC_READ_SIZE];
+	ssize_t	count;
+
+	if (slot->toChild >= 0 && inEvents){
+
+		count = write (slot->toChild, slot->query + slot->written, slot->length - slot->written);
+
+		if (count > 0)
+			slot->written += count;
+
+		/* child closed stdin - its exit code tells */
+		if (slot->written == slot->length || (count < 0 && errno != EAGAIN))
+			closeFd (&slot->toChild);
+	}
+
+	while (slot->fromChild >= 0 && outEvents){
+
+		count = read (slot->fromChild, buffer, sizeof(buffer));
+
+		if (count > 0){
+
+			feedXrdsParser (&slot->parser, buffer, count);
+			continue;
+		}
+
+		if (count < 0 && errno == EAGAIN)
+
+			break;
+
+		closeFd (&slot->fromChild);
+	}
+
+	return;
+}
+
+/* execGetXrdsDL(): fills GPS members for each XROADS in xrdsDL by running
+ * execPath for each query, keeping up to schedule jobs children at once;
+ * per query time limit and run deadline are as with multiGetXrdsDL(), rate,
+ * hedge, adaptive and server pool are not used. XROADS are filled in place
+ * in input order, raw data file is written in input order. done - when not
+ * NULL - is called with doneData as each XROADS is filled. XROADS failing
+ * NUM_TRIES tries are set XRDS_FAILED, the run goes on.
+ * Return: ztSuccess - failed XROADS included - or error stopping the run.
+ ***************************************************************************/
+int execGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, char *execPath,
+		            QUERY_SCHEDULE *schedule, XRDS_DONE_FUNC done, void *doneData){
+
+	XROADS			**xrdsArray = NULL;
+	MEMORY_STRUCT	*rawArray = NULL;
+	char				*doneArray = NULL;
+	int				*tries = NULL;
+	EXEC_SLOT		*slots = NULL;
+	struct pollfd	*pollFds = NULL;
+	int				*pollSlot = NULL;
+	struct sigaction	ignore, saved;
+	DL_ELEM			*elem;
+	EXEC_SLOT		*slot;
+	XROADS			*xrds;
+	double			now, wait;
+	long				timeout;
+	int				total, maxJobs, numPoll;
+	int				nextIndex, flushIndex, numDone, numFailed;
+	int				outOfTime = 0;
+	int				iCount, exitCode, result;
+	const char		*failure;
+	int				retCode = ztSuccess;
+
+	ASSERTARGS (xrdsDL && bbox && execPath && schedule);
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	maxJobs = schedule->jobs;
+	if (maxJobs < 1 || maxJobs > MAX_JOBS){
+		fprintf(stderr, "execGetXrdsDL(): Error maxJobs out of range [1 - %d].\n", MAX_JOBS);
+		return ztOutOfRangePara;
+	}
+
+	total = DL_SIZE(xrdsDL);
+	if (maxJobs > total)
+
+		maxJobs = total;
+
+	xrdsArray = (XROADS **) malloc (sizeof(XROADS *) * total);
+	doneArray = (char *) calloc (total, sizeof(char));
+	tries = (int *) calloc (total, sizeof(int));
+	slots = (EXEC_SLOT *) calloc (maxJobs, sizeof(EXEC_SLOT));
+	pollFds = (struct pollfd *) malloc (sizeof(struct pollfd) * maxJobs * 2);
+	pollSlot = (int *) malloc (sizeof(int) * maxJobs * 2);
+	if (rawDataFP)
+		rawArray = (MEMORY_STRUCT *) calloc (total, sizeof(MEMORY_STRUCT));
+
+	if ( ! xrdsArray || ! doneArray || ! tries || ! slots || ! pollFds || ! pollSlot ||
+		(rawDataFP && ! rawArray) ){
+		fprintf(stderr, "execGetXrdsDL(): Error allocating memory.\n");
+		retCode = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	iCount = 0;
+	for (elem = DL_HEAD(xrdsDL); elem; elem = DL_NEXT(elem))
+
+		xrdsArray[iCount++] = (XROADS *) DL_DATA(elem);
+
+	for (iCount = 0; iCount < maxJobs; iCount++){
+
+		slots[iCount].toChild = slots[iCount].fromChild = -1;
+		initialArena (&slots[iCount].arena, 0);
+
+		if (rawDataFP && initialMemory (&slots[iCount].raw, MEMORY_INITIAL_SIZE) != ztSuccess){
+			fprintf(stderr, "execGetXrdsDL(): Error allocating memory.\n");
+			retCode = ztMemoryAllocate;
+			goto cleanup;
+		}
+	}
+
+	/* child quitting before reading all of query must not stop us */
+	memset (&ignore, 0, sizeof(ignore));
+	ignore.sa_handler = SIG_IGN;
+	sigaction (SIGPIPE, &ignore, &saved);
+
+	nextIndex = flushIndex = numDone = numFailed = 0;
+
+	while (numDone < total){
+
+		now = nowMs ();
+
+		if (schedule->deadline > 0 && now >= schedule->deadline){
+
+			outOfTime = 1;
+			break;
+		}
+
+		/* keep idle slots busy */
+		for (iCount = 0; iCount < maxJobs && nextIndex < total; iCount++){
+
+			if (slots[iCount].busy)
+
+				continue;
+
+			result = startExec (&slots[iCount], xrdsArray[nextIndex], nextIndex, bbox, execPath);
+			if (result != ztSuccess){
+				retCode = result;
+				goto restore;
+			}
+
+			tries[nextIndex++]++;
+		}
+
+		/* poll pipes of busy slots, no longer than first time limit */
+		numPoll = 0;
+		wait = 1000.0;
+		timeout = getQueryTimeout ();
+
+		for (iCount = 0; iCount < maxJobs; iCount++){
+
+			slot = &slots[iCount];
+
+			if ( ! slot->busy )
+
+				continue;
+
+			if (slot->toChild >= 0){
+				pollFds[numPoll].fd = slot->toChild;
+				pollFds[numPoll].events = POLLOUT;
+				pollSlot[numPoll++] = iCount;
+			}
+
+			if (slot->fromChild >= 0){
+				pollFds[numPoll].fd = slot->fromChild;
+				pollFds[numPoll].events = POLLIN;
+				pollSlot[numPoll++] = iCount;
+			}
+
+			if (timeout)
+				wait = MIN(wait, MAX(slot->started + timeout - now, 0.0));
+		}
+
+		if (schedule->deadline > 0)
+			wait = MIN(wait, MAX(schedule->deadline - now, 0.0));
+
+		if (numPoll && poll (pollFds, numPoll, (int) wait + 1) < 0 && errno != EINTR){
+			fprintf(stderr, "execGetXrdsDL(): Error in poll(): %s\n", strerror (errno));
+			retCode = ztFatalError;
+			goto restore;
+		}
+
+		for (iCount = 0; iCount < numPoll; iCount++){
+
+			if ( ! pollFds[iCount].revents )
+
+				continue;
+
+			slot = &slots[pollSlot[iCount]];
+
+			if (pollFds[iCount].fd == slot->toChild)
+				serveSlot (slot, pollFds[iCount].revents, 0);
+			else if (pollFds[iCount].fd == slot->fromChild)
+				serveSlot (slot, 0, pollFds[iCount].revents);
+		}
+
+		/* finished children - answer read to the end - and late ones */
+		now = nowMs ();
+
+		for (iCount = 0; iCount < maxJobs; iCount++){
+
+			slot = &slots[iCount];
+
+			if ( ! slot->busy )
+
+				continue;
+
+			failure = NULL;
+
+			if (slot->fromChild < 0){
+
+				exitCode = stopExec (slot, 0);
+
+				if (exitCode != 0)
+					failure = "query program failed";
+
+				else {
+
+					result = finishXrdsParser (&slot->parser);
+					if (result == ztMemoryAllocate){
+						retCode = result;
+						goto restore;
+					}
+
+					if (result != ztSuccess)
+						failure = "answer not taken";
+				}
+			}
+			else if (timeout && now - slot->started >= timeout){
+
+				stopExec (slot, 1);
+				failure = "timed out";
+			}
+			else
+
+				continue;
+
+			xrds = slot->xrds;
+
+			if (failure){
+
+				fprintf(stderr, "execGetXrdsDL(): Error try [%d of %d] for [ %s && %s ]: %s\n",
+						    tries[slot->index], NUM_TRIES, xrds->firstRD, xrds->secondRD, failure);
+
+				if (tries[slot->index] < NUM_TRIES){
+
+					result = startExec (slot, xrds, slot->index, bbox, execPath);
+					if (result != ztSuccess){
+						retCode = result;
+						goto restore;
+					}
+
+					tries[slot->index]++;
+					continue;
+				}
+
+				xrds->nodesNum = 0;
+				xrds->status = XRDS_FAILED;
+				numFailed++;
+			}
+
+			/* progress to stderr, results may be on stdout */
+			fprintf(stderr, "execGetXrdsDL(): %s [%d of %d].\n",
+					    failure ? "Failed" : "Done", slot->index + 1, total);
+
+			/* raw data: write now if this is the next one in input order,
+			 * else keep a copy until its turn comes */
+			if (rawArray && slot->index == flushIndex)
+
+				xrdsWriteRawData (xrds, &slot->raw);
+
+			else if (rawArray){
+
+				if (appendMemory (&rawArray[slot->index], MEMORY_BYTES(&slot->raw),
+						                     MEMORY_LENGTH(&slot->raw)) != ztSuccess){
+					retCode = ztMemoryAllocate;
+					goto restore;
+				}
+			}
+
+			doneArray[slot->index] = 1;
+			numDone++;
+
+			if (done)
+				done (xrds, doneData);
+
+			while (flushIndex < total && doneArray[flushIndex]){
+
+				if (rawArray && rawArray[flushIndex].memory){
+					xrdsWriteRawData (xrdsArray[flushIndex], &rawArray[flushIndex]);
+					zapMemory (&rawArray[flushIndex]);
+				}
+
+				flushIndex++;
+			}
+		}
+
+	} // end while (numDone < total)
+
+	if (outOfTime){
+
+		for (iCount = 0; iCount < maxJobs; iCount++)
+
+			if (slots[iCount].busy)
+				stopExec (&slots[iCount], 1);
+
+		fprintf(stderr, "execGetXrdsDL(): Error run deadline passed; [ %d ] of [ %d ] "
+				    "cross roads not done.\n", total - numDone, total);
+
+		for (iCount = 0; iCount < total; iCount++){
+
+			if (doneArray[iCount])
+
+				continue;
+
+			xrdsArray[iCount]->nodesNum = 0;
+			xrdsArray[iCount]->status = XRDS_FAILED;
+			doneArray[iCount] = 1;
+			numDone++;
+			numFailed++;
+
+			if (done)
+				done (xrdsArray[iCount], doneData);
+		}
+
+		for ( ; flushIndex < total; flushIndex++){
+
+			if (rawArray && rawArray[flushIndex].memory){
+				xrdsWriteRawData (xrdsArray[flushIndex], &rawArray[flushIndex]);
+				zapMemory (&rawArray[flushIndex]);
+			}
+		}
+	}
+
+	if (numFailed)
+		printf ("execGetXrdsDL(): [ %d ] of [ %d ] cross roads failed.\n",
+				    numFailed, total);
+
+restore:
+
+	for (iCount = 0; iCount < maxJobs; iCount++)
+
+		if (slots[iCount].busy)
+			stopExec (&slots[iCount], 1);
+
+	sigaction (SIGPIPE, &saved, NULL);
+
+cleanup:
+
+	if (slots){
+
+		for (iCount = 0; iCount < maxJobs; iCount++){
+
+			zapArena (&slots[iCount].arena);
+			zapMemory (&slots[iCount].raw);
+		}
+
+		free (slots);
+	}
+
+	if (rawArray){
+
+		for (iCount = 0; iCount < total; iCount++)
+
+			zapMemory (&rawArray[iCount]);
+
+		free (rawArray);
+	}
+
+	if (pollSlot)
+		free (pollSlot);
+
+	if (pollFds)
+		free (pollFds);
+
+	if (tries)
+		free (tries);
+
+	if (doneArray)
+		free (doneArray);
+
+	if (xrdsArray)
+		free (xrdsArray);
+
+	return retCode;
+
+} // END execGetXrdsDL()
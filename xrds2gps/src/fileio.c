@@ -9,6 +9,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fileio.h"
 #include "dList.h"
@@ -29,11 +33,13 @@
  * function allocates memory for each line, use zapLineInfo() as second
  * argument when initializing list, this way zapLineInfo() will be called
  * when you destroy the list.
+ * With arena, LINE_INFO and line strings are taken from arena instead; list
+ * is initialized with NULL destroy and memory goes with the arena.
  * It is an error for list not to be empty.
  *
  *********************************************************************/
 
-int file2List (DL_LIST *list, char *filename){
+int file2List (DL_LIST *list, char *filename, ARENA *arena){
 
 	FILE 		*fPtr;
 	LINE_INFO 	*newLine;
@@ -88,14 +94,19 @@ int file2List (DL_LIST *list, char *filename){
 
 			start++;
 
-		newLine = (LINE_INFO *) malloc(sizeof(LINE_INFO));
+		newLine = (LINE_INFO *) arenaAlloc(arena, sizeof(LINE_INFO));
 		if (newLine == NULL){
 			printf("file2List(): Error allocating memory.\n");
 			fclose(fPtr);
 			return ztMemoryAllocate;
 		}
 
-		newLine->string = strdup(start);
+		newLine->string = arenaStrdup(arena, start);
+		if (newLine->string == NULL){
+			printf("file2List(): Error allocating memory.\n");
+			fclose(fPtr);
+			return ztMemoryAllocate;
+		}
 		newLine->originalNum = myLineNum;
 
 		result = insertNextDL (list, DL_TAIL(list), newLine);
@@ -112,6 +123,163 @@ int file2List (DL_LIST *list, char *filename){
 	return ztSuccess;
 }
 
+/* openMappedFile(): maps filename into memory read only for nextLineView().
+ * Empty file is not an error, it has no lines.
+ * Returns ztSuccess or ztOpenFileError.
+ *********************************************************************/
+int openMappedFile (MAPPED_FILE *mapped, char *filename){
+
+	int			fd;
+	struct stat	st;
+	void			*data;
+
+	ASSERTARGS (mapped && filename);
+
+	memset (mapped, 0, sizeof(MAPPED_FILE));
+
+	errno = 0;
+	fd = open (filename, O_RDONLY);
+	if (fd < 0 || fstat (fd, &st) != 0){
+		printf ("openMappedFile(): Error opening file: %s: %s\n",
+				   filename, strerror(errno));
+		if (fd >= 0)
+			close (fd);
+		return ztOpenFileError;
+	}
+
+	if (st.st_size > 0){
+
+		data = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED){
+			printf ("openMappedFile(): Error mapping file: %s: %s\n",
+					   filename, strerror(errno));
+			close (fd);
+			return ztOpenFileError;
+		}
+
+		madvise (data, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+		mapped->data = (char *) data;
+		mapped->size = (size_t) st.st_size;
+	}
+
+	close (fd); // mapping stays good
+
+	return ztSuccess;
+}
+
+/* nextLineView(): sets view to next line in mapped file skipping blank and
+ * comment lines same as file2List() with myFgets(): leading space and tab
+ * are dropped, line feed is removed, comment line starts with [# or ;].
+ * Unlike myFgets(), last line without line feed is not lost.
+ * Returns 1 when view is set, 0 at end of file.
+ *********************************************************************/
+int nextLineView (MAPPED_FILE *mapped, LINE_VIEW *view){
+
+	const char	*start, *end, *ptr;
+	const char	*whiteSpace = "\040\t\n\r";
+
+	ASSERTARGS (mapped && view);
+
+	while (mapped->offset < mapped->size){
+
+		start = mapped->data + mapped->offset;
+
+		end = memchr (start, '\n', mapped->size - mapped->offset);
+		if (end)
+			mapped->offset = (end - mapped->data) + 1;
+		else {
+			end = mapped->data + mapped->size;
+			mapped->offset = mapped->size;
+		}
+
+		mapped->lineNum++;
+
+		// ignore blank lines
+		for (ptr = start; ptr < end && strchr (whiteSpace, *ptr); ptr++)
+			;
+
+		if (ptr == end)
+
+			continue;
+
+		// move to first non-space character
+		while (*start == ' ' || *start == '\t')
+
+			start++;
+
+		if (strchr (COMMENT_SET, *start))
+
+			continue;
+
+		view->ptr = start;
+		view->len = end - start;
+		view->lineNum = mapped->lineNum;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+/* mappedLineCount(): number of lines in mapped file - including blank and
+ * comment lines; upper bound for lines nextLineView() gives.
+ *********************************************************************/
+int mappedLineCount (MAPPED_FILE *mapped){
+
+	const char	*ptr, *end;
+	int			count = 0;
+
+	ASSERTARGS (mapped);
+
+	if ( ! mapped->data )
+
+		return 0;
+
+	ptr = mapped->data;
+	end = mapped->data + mapped->size;
+
+	while (ptr < end && (ptr = memchr (ptr, '\n', end - ptr))){
+		count++;
+		ptr++;
+	}
+
+	if (mapped->data[mapped->size - 1] != '\n')
+		count++;
+
+	return count;
+}
+
+/* closeMappedFile(): unmaps file, views from it are no good after this */
+void closeMappedFile (MAPPED_FILE *mapped){
+
+	ASSERTARGS (mapped);
+
+	if (mapped->data)
+		munmap (mapped->data, mapped->size);
+
+	memset (mapped, 0, sizeof(MAPPED_FILE));
+
+	return;
+}
+
+/* lineView2Str(): copies view into dest as zero terminated string.
+ * Returns ztSuccess or ztStrToolong when view does not fit size.
+ *********************************************************************/
+int lineView2Str (char *dest, size_t size, LINE_VIEW *view){
+
+	ASSERTARGS (dest && view && size);
+
+	if (view->len >= size)
+
+		return ztStrToolong;
+
+	memcpy (dest, view->ptr, view->len);
+	dest[view->len] = '\0';
+
+	return ztSuccess;
+}
+
 void printLineInfo(LINE_INFO *lineInfo){
 
 	ASSERTARGS(lineInfo);
@@ -30,7 +30,26 @@ void printHelp(FILE *toStream){
 	"  -o   --output filename   Writes output to specified \"filename\"\n"
 	"  -f   --force             Use with output option to force overwriting existing \"filename\"\n"
 	"  -W   --WKT filename      Writes Well Known Text to \"filename\"\n"
-	"  -r   --raw-data filename Writes received (downloaded) data from server to \"filename\"\n\n"
+	"  -r   --raw-data filename Writes received (downloaded) data from server to \"filename\"\n"
+	"  -j   --jobs number       Keeps \"number\" queries in flight to server; default is 1\n"
+	"  -q   --rate number       Starts at most \"number\" queries per second\n"
+	"  -b   --batch             Sends one query per input file for all its cross roads\n"
+	"  -n   --no-cache          Does not use result cache; always queries server\n"
+	"  -R   --refresh           Ignores cached results; queries server and updates cache\n"
+	"  -t   --cache-ttl days    Cached results older than \"days\" are not used; default 30\n"
+	"  -F   --format name       Output format: text (default), csv, ndjson or binary\n"
+	"  -O   --osm-file filename Finds cross roads in local OSM XML file, no server\n"
+	"  -s   --streets           Queries node ids per street, finds cross roads here\n"
+	"  -g   --grid              Input files list NS and EW streets, see below\n"
+	"  -c   --crossings         Input files list streets, finds all their cross roads\n"
+	"  -d   --dictionary        Checks street names against names in bbox first\n"
+	"  -S   --server URL        Sends queries to Overpass server at \"URL\"; may repeat\n"
+	"  -C   --servers filename  Reads Overpass server URLs from \"filename\"\n"
+	"  -T   --timeout seconds   Gives up on a query after \"seconds\"; default 300\n"
+	"  -D   --deadline seconds  Gives up on queries not done \"seconds\" after start\n"
+	"  -H   --hedge             Sends a copy of slow queries, first answer is used\n"
+	"  -A   --adaptive          Sets queries in flight by server load; jobs is the most\n"
+	"  -E   --exec path         Runs local query program \"path\" for queries, no server\n\n"
 
 	"  Output directory: On invocation program creates a directory entry with program\n"
 	"name \"xrds2gps\" under the effective user home directory, this directory is\n"
@@ -67,6 +86,129 @@ void printHelp(FILE *toStream){
 	"                       are not saved to disk. Using this option user can save\n"
 	"                       query results to \"filename\".\n\n"
 
+	" --jobs number : By default, program sends one query at a time to the server and\n"
+	"                 waits for its response. This option tells the program to keep\n"
+	"                 up to \"number\" queries in flight at the same time [1 - 64].\n"
+	"                 Output - including raw data - is still written in input order.\n"
+	"                 Use with your own server; please do NOT use with public servers.\n\n"
+	" --rate number : Paces query starts to \"number\" queries per second - may be a\n"
+	"                 fraction like 0.5 - tries again included. Default is no pacing.\n\n"
+
+	" --server URL : Overpass server to query, as in http://127.0.0.1/api/interpreter\n"
+	"                Repeat the option for more servers with the same data; queries\n"
+	"                are spread over them - each goes to the server with the fewest\n"
+	"                queries in flight - so use \"jobs\" as well. A server failing\n"
+	"                3 queries in a row is left out, and checked every 5 seconds\n"
+	"                until it answers again. Default is the server built into the\n"
+	"                program.\n\n"
+
+	" --servers filename : Same as server option, one URL per line in \"filename\";\n"
+	"                      blank lines and lines starting with # or ; are skipped.\n\n"
+
+	" --timeout seconds : A query not answered in \"seconds\" fails - and is tried\n"
+	"                     again as below. Zero is no limit; default is 300.\n\n"
+
+	" --deadline seconds : Whole run - all input files - must be done \"seconds\"\n"
+	"                      after program start; queries still in flight then are\n"
+	"                      stopped and pairs not done are shown as \"Query Failed\".\n"
+	"                      Applies to queries sent one per pair, with or without\n"
+	"                      \"jobs\"; single queries - batch, streets, grid - have\n"
+	"                      the query timeout only.\n\n"
+
+	" --hedge : Once 20 queries are done, a query still running longer than 95 of\n"
+	"           100 queries took gets a copy sent - to another server when there is\n"
+	"           one - on one extra slot; first good answer is used and the other\n"
+	"           query is stopped. Cuts slow tail queries at the cost of a few more.\n\n"
+
+	" --adaptive : Number of queries in flight follows server capacity: it starts\n"
+	"              at the free query slots on the server status page - one when\n"
+	"              server has no limit or no page - goes up by one for each round\n"
+	"              of good queries and is cut in half on rate limit (HTTP 429),\n"
+	"              server error, no answer, or when average latency gets over\n"
+	"              twice the lowest of recent queries. Server slot limit and\n"
+	"              \"jobs\" - default 16 here - are the most. Each change is\n"
+	"              shown with its reason.\n\n"
+
+	" --exec path : With Overpass on this machine, runs query program at \"path\" -\n"
+	"               as osm3s_query with its dispatcher running - for each query in\n"
+	"               place of the server; query is written to its standard input and\n"
+	"               answer read from its standard output, no web server involved.\n"
+	"               Up to \"jobs\" programs run at once; timeout and deadline apply.\n"
+	"               Not used with --osm-file, --batch, --streets, --grid, --crossings\n"
+	"               or --dictionary. bench/mockQuery.sh is a stand in to try it.\n\n"
+
+	"  Failed queries: A query that fails - no connection, server busy (HTTP 429),\n"
+	"gateway time out (HTTP 504) or an error page in place of data - is tried again\n"
+	"after a random delay that grows with each try; up to 3 tries. Other pairs go on\n"
+	"in the meantime. A pair still failing is shown as \"Query Failed\", it is not\n"
+	"cached, and the run goes on with the rest.\n\n"
+
+	" --batch : Program sends ONE query for each input file; named streets in the\n"
+	"           bounding box are fetched once and common nodes for every cross roads\n"
+	"           pair are found by the server in the same query. Use this when many\n"
+	"           pairs share the same street. The \"jobs\" option is ignored here.\n\n"
+
+	"  Result cache: Query results are saved in \"xrds2gps.cache\" file in program\n"
+	"output directory. When the same cross roads are asked for again with the same\n"
+	"bounding box, the result is taken from the cache and the server is not asked.\n\n"
+
+	" --no-cache : Do not read nor write the cache file.\n\n"
+
+	" --refresh : Query server for every cross roads, replacing cached results.\n\n"
+
+	" --cache-ttl days : Results older than \"days\" are queried again; zero for\n"
+	"                    no time limit. Default is 30 days.\n\n"
+
+	" --format name : Output is written as \"text\" table by default. For loading by\n"
+	"                 other programs use one of:\n"
+	"                 csv : header line then one row per cross roads with street\n"
+	"                       names, number of nodes, mid-point longitude and latitude\n"
+	"                       and nodes as \"lon lat;lon lat\"; empty when not found.\n"
+	"                 ndjson : one JSON object per line per cross roads with \"first\",\n"
+	"                       \"second\", \"nodes\" [[lon,lat],..] and \"mid\" [lon,lat].\n"
+	"                 binary : fixed size little endian records - one per cross roads\n"
+	"                       with degrees * 10^7 integers - for reading with mmap();\n"
+	"                       see \"sink.h\" for the layout.\n"
+	"                 Formats other than text need output option, since progress\n"
+	"                 lines go to terminal; terminal still shows the text table.\n\n"
+
+	" --streets : Node ids of each distinct street in bbox are queried once - ids\n"
+	"             only - and kept for the session; common nodes of each pair are\n"
+	"             found by the program, then their coordinates are queried in one\n"
+	"             query. Server work goes with number of streets, not of pairs.\n"
+	"             Used instead of jobs and batch options.\n\n"
+
+	" --grid : Input files - after the bounding box line - list north-south streets\n"
+	"          on lines starting with \"NS:\" and east-west streets on lines starting\n"
+	"          with \"EW:\"; a line may list more names separated with comma:\n"
+	"            NS: North Central Avenue, North 7th Street\n"
+	"            EW: East Camelback Road\n"
+	"          Every NS street is crossed with every EW street - NS name first - in\n"
+	"          listed order. Nodes for each group are fetched with one query, so a\n"
+	"          30 x 30 grid takes two queries instead of 900.\n\n"
+
+	" --crossings : Input files - after the bounding box line - list street names\n"
+	"          only, one or more per line separated with comma. Every node each\n"
+	"          street shares with another named highway in bbox is found with\n"
+	"          one query for the whole file; one cross roads is output for each\n"
+	"          crossing street name, listed street first. Crossings you did not\n"
+	"          know to ask for are found too. Result cache is not used with it.\n\n"
+
+	" --dictionary : Street names of all ways in bbox are queried once for each\n"
+	"          bbox; every pair is checked against them before it is queried.\n"
+	"          A pair with a name no street has - a typo - is output as not found\n"
+	"          without query and near matches are shown. A name found in just one\n"
+	"          street name is replaced with that name and matched exactly on the\n"
+	"          server, no regular expression. Not used with --osm-file.\n\n"
+
+	" --osm-file filename : Cross roads are found in local OSM XML \"filename\" - a\n"
+	"                 regional extract - instead of querying the server; file is\n"
+	"                 read once at start. Streets are named highway ways but\n"
+	"                 \"service\", names match case insensitive as on the server.\n"
+	"                 PBF files must be converted first, for example with:\n"
+	"                   osmium cat region.osm.pbf -o region.osm\n"
+	"                 Result cache and raw-data option are not used with it.\n\n"
+
 	"  Input file list: In one invocation or session, program can process multiple\n"
 	"files with space separated list. Program process each input file and the output\n"
 	"is combined for all input files. If you have a large area, this a way to use\n"
@@ -112,6 +254,25 @@ void shortUsage (FILE *toFP, ztExitCodeType exitCode){
 			"  -f   --force             Use with output option to force overwriting existing \"filename\".\n"
 			"  -W   --WKT filename      Writes Well Known Text to \"filename\"\n"
 			"  -r   --raw-data filename Writes received (downloaded) data from server to \"filename\".\n"
+			"  -j   --jobs number       Keeps \"number\" queries in flight to server.\n"
+			"  -q   --rate number       Starts at most \"number\" queries per second.\n"
+			"  -b   --batch             Sends one query per input file.\n"
+			"  -n   --no-cache          Does not use result cache.\n"
+			"  -R   --refresh           Ignores cached results, updates cache.\n"
+			"  -t   --cache-ttl days    Sets cached results time to live in days.\n"
+			"  -F   --format name       Sets output format: text, csv, ndjson or binary.\n"
+			"  -O   --osm-file filename Finds cross roads in local OSM file, no server.\n"
+			"  -s   --streets           Queries node ids per street, not per pair.\n"
+			"  -g   --grid              Reads input as NS and EW street lists.\n"
+			"  -c   --crossings         Reads input as streets, finds all crossings.\n"
+			"  -d   --dictionary        Checks street names before querying.\n"
+			"  -S   --server URL        Sends queries to server \"URL\"; may repeat.\n"
+			"  -C   --servers filename  Reads server URLs from \"filename\".\n"
+			"  -T   --timeout seconds   Gives up on a query after \"seconds\".\n"
+			"  -D   --deadline seconds  Gives up on queries not done by \"seconds\".\n"
+			"  -H   --hedge             Sends a copy of slow queries.\n"
+			"  -A   --adaptive          Sets queries in flight by server load.\n"
+			"  -E   --exec path         Runs local query program \"path\", no server.\n"
 			"\n"
 			"Try: '%s --help'\n\n", prog_name);
 
@@ -0,0 +1,876 @@
+/*
+ * multiQuery.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Concurrent cross roads queries using libcurl multi interface. A small pool
+ * of easy handles (slots) is kept busy; each slot carries one query at a time.
+ * Responses are parsed as they arrive, raw data is written in input order.
+ * Failed queries are tried again later with backoff, query starts may be
+ * paced to a rate, slow queries may be hedged and the run may have a
+ * deadline; see multiGetXrdsDL().
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <curl/curl.h>
+
+#include "multiQuery.h"
+#include "adaptive.h"
+#include "overpass-c.h"
+#include "curl_func.h"
+#include "util.h"
+#include "ztError.h"
+
+/* startSlot(): fills query template for xrds and adds slot handle to multi
+ * handle; with schedule pool, query goes to pickEndpoint() server - not to
+ * avoid if we have another. Query time limit is cut to time left before run
+ * deadline. Returns ztSuccess or error code.
+ ***************************************************************************/
+static int startSlot (CURLM *multiHandle, QUERY_SLOT *slot, XROADS *xrds, int index,
+		                          BBOX *bbox, QUERY_SCHEDULE *schedule, ENDPOINT *avoid){
+
+	CURLMcode	mResult;
+	long			timeout;
+	int			result;
+
+	ASSERTARGS (multiHandle && slot && xrds && bbox && schedule);
+
+	resetArena (&slot->arena);
+
+	slot->query = xrdsFillTemplate (xrds, bbox, &slot->arena);
+	if ( ! slot->query ){
+		fprintf(stderr, "startSlot(): Error returned from xrdsFillTemplate().\n");
+		return ztMemoryAllocate;
+	}
+
+	initialXrdsParser (&slot->parser, xrds, rawDataFP ? queryMemory (slot->handle) : NULL);
+
+	result = prepareQueryWrite (slot->query, slot->handle, xrdsParserWrite, &slot->parser);
+	if (result != ztSuccess){
+		fprintf(stderr, "startSlot(): Error returned from prepareQueryWrite().\n");
+		return result;
+	}
+
+	slot->started = nowMs ();
+
+	timeout = getQueryTimeout ();
+	if (schedule->deadline > 0){
+
+		/* at least one millisecond; zero is no limit to libcurl */
+		if (timeout == 0 || schedule->deadline - slot->started < timeout)
+			timeout = MAX(1, (long) (schedule->deadline - slot->started));
+	}
+
+	curl_easy_setopt (slot->handle, CURLOPT_TIMEOUT_MS, timeout);
+
+	slot->endpoint = NULL;
+	if (schedule->pool){
+
+		slot->endpoint = pickEndpoint (schedule->pool, avoid);
+		if ( ! slot->endpoint ){
+			fprintf(stderr, "startSlot(): Error no healthy server.\n");
+			return ztNoConnError;
+		}
+		curl_easy_setopt (slot->handle, CURLOPT_CURLU, slot->endpoint->url);
+	}
+
+	mResult = curl_multi_add_handle (multiHandle, slot->handle);
+	if (mResult != CURLM_OK){
+		fprintf(stderr, "startSlot(): curl_multi_add_handle() failed: %s\n",
+				    curl_multi_strerror(mResult));
+		if (slot->endpoint)
+			endpointDone (schedule->pool, slot->endpoint, QUERY_CANCELLED);
+		return ztFatalError;
+	}
+
+	slot->xrds = xrds;
+	slot->index = index;
+	slot->busy = 1;
+
+	return ztSuccess;
+}
+
+/* startHedge(): sends copy of query in primary slot on idle slot hedge, to
+ * another server when we have one; copy is parsed into hedge shadow XROADS.
+ ***************************************************************************/
+static int startHedge (CURLM *multiHandle, QUERY_SLOT *hedge, QUERY_SLOT *primary,
+		                          BBOX *bbox, QUERY_SCHEDULE *schedule){
+
+	XROADS	*shadow = &hedge->shadow;
+	int		result;
+
+	shadow->firstRD = primary->xrds->firstRD;
+	shadow->secondRD = primary->xrds->secondRD;
+	shadow->exact = primary->xrds->exact;
+	shadow->status = XRDS_PENDING;
+
+	result = startSlot (multiHandle, hedge, shadow, primary->index, bbox, schedule,
+			                 primary->endpoint);
+	if (result != ztSuccess)
+
+		return result;
+
+	hedge->hedge = 1;
+	hedge->twin = primary;
+	primary->twin = hedge;
+
+	return ztSuccess;
+}
+
+/* cancelSlot(): stops query in busy slot; its twin - if any - goes on alone */
+static void cancelSlot (CURLM *multiHandle, QUERY_SLOT *slot, ENDPOINT_POOL *pool){
+
+	curl_multi_remove_handle (multiHandle, slot->handle);
+
+	if (slot->endpoint)
+		endpointDone (pool, slot->endpoint, QUERY_CANCELLED);
+
+	if (slot->twin)
+		slot->twin->twin = NULL;
+
+	slot->twin = NULL;
+	slot->hedge = 0;
+	slot->busy = 0;
+
+	return;
+}
+
+/* copyResult(): copies result members - not names - from hedge shadow src
+ * to dest input XROADS.
+ */
+static void copyResult (XROADS *dest, XROADS *src){
+
+	int	iCount;
+
+	dest->nodesNum = src->nodesNum;
+
+	for (iCount = 0; iCount < src->nodesNum; iCount++)
+
+		*(dest->nodesGPS[iCount]) = *(src->nodesGPS[iCount]);
+
+	if (src->nodesNum){
+
+		*(dest->midGps) = *(src->midGps);
+		dest->point->gps = *(dest->midGps);
+	}
+
+	dest->status = src->status;
+
+	return;
+}
+
+/* countPrimary(): busy slots not running a hedge */
+static int countPrimary (QUERY_SLOT *slots, int numSlots){
+
+	int	iCount;
+	int	numPrimary = 0;
+
+	for (iCount = 0; iCount < numSlots; iCount++)
+
+		numPrimary += (slots[iCount].busy && ! slots[iCount].hedge);
+
+	return numPrimary;
+}
+
+static int compareDouble (const void *first, const void *second){
+
+	double	diff = *(const double *) first - *(const double *) second;
+
+	return (diff > 0) - (diff < 0);
+}
+
+/* addLatency(): adds good query latency ms to ring, updates its p95 */
+static void addLatency (LATENCY_RING *ring, double ms){
+
+	double	sorted[HEDGE_SAMPLES];
+
+	ring->sample[ring->next] = ms;
+	ring->next = (ring->next + 1) % HEDGE_SAMPLES;
+
+	if (ring->count < HEDGE_SAMPLES)
+		ring->count++;
+
+	if (ring->count < HEDGE_MIN_SAMPLES)
+
+		return;
+
+	memcpy (sorted, ring->sample, sizeof(double) * ring->count);
+	qsort (sorted, ring->count, sizeof(double), compareDouble);
+
+	ring->p95 = sorted[(ring->count * 95 + 99) / 100 - 1];
+
+	return;
+}
+
+/* initialWaitQueue(): allocates queue for size XROADS, all are queued in
+ * input order ready now. Returns ztSuccess or ztMemoryAllocate.
+ */
+static int initialWaitQueue (WAIT_QUEUE *queue, int size){
+
+	int	iCount;
+
+	memset (queue, 0, sizeof(WAIT_QUEUE));
+
+	queue->index = (int *) malloc (sizeof(int) * size);
+	queue->readyAt = (double *) calloc (size, sizeof(double));
+	queue->tries = (int *) calloc (size, sizeof(int));
+	if ( ! queue->index || ! queue->readyAt || ! queue->tries )
+
+		return ztMemoryAllocate;
+
+	for (iCount = 0; iCount < size; iCount++)
+
+		queue->index[iCount] = iCount;
+
+	queue->count = queue->size = size;
+
+	return ztSuccess;
+}
+
+static void zapWaitQueue (WAIT_QUEUE *queue){
+
+	if (queue->index)
+		free (queue->index);
+
+	if (queue->readyAt)
+		free (queue->readyAt);
+
+	if (queue->tries)
+		free (queue->tries);
+
+	memset (queue, 0, sizeof(WAIT_QUEUE));
+
+	return;
+}
+
+/* pushWait(): queues index at the end; an index is queued once at most,
+ * so queue never overflows.
+ */
+static void pushWait (WAIT_QUEUE *queue, int index){
+
+	queue->index[(queue->head + queue->count) % queue->size] = index;
+	queue->count++;
+
+	return;
+}
+
+static int popWait (WAIT_QUEUE *queue){
+
+	int	index;
+
+	index = queue->index[queue->head];
+	queue->head = (queue->head + 1) % queue->size;
+	queue->count--;
+
+	return index;
+}
+
+/* takeReady(): removes and returns first index in queue ready at now; ones
+ * still waiting before it go to the end. Returns -1 when none is ready.
+ */
+static int takeReady (WAIT_QUEUE *queue, double now){
+
+	int	iCount, numWaiting;
+	int	index;
+
+	numWaiting = queue->count;
+
+	for (iCount = 0; iCount < numWaiting; iCount++){
+
+		index = popWait (queue);
+		if (queue->readyAt[index] <= now)
+
+			return index;
+
+		pushWait (queue, index);
+	}
+
+	return -1;
+}
+
+/* nextReadyMs(): milliseconds from now until first queued index is ready,
+ * zero when one is ready now; -1 for empty queue.
+ */
+static double nextReadyMs (WAIT_QUEUE *queue, double now){
+
+	double	wait = -1.0;
+	int		iCount, index;
+
+	for (iCount = 0; iCount < queue->count; iCount++){
+
+		index = queue->index[(queue->head + iCount) % queue->size];
+
+		if (wait < 0 || queue->readyAt[index] - now < wait)
+
+			wait = MAX(queue->readyAt[index] - now, 0.0);
+	}
+
+	return wait;
+}
+
+/* multiGetXrdsDL(): fills GPS members for each XROADS in xrdsDL keeping up
+ * to schedule jobs queries in flight on srvrURL. XROADS structures are filled
+ * in place, so list order - input order - is kept for the output. When raw
+ * data file is set, response for each XROADS is held until all XROADS before
+ * it are done, then written; raw data file is in input order too.
+ * done - when not NULL - is called with doneData as each XROADS is filled.
+ *
+ * A failed query - see queryFailure(), a response finishXrdsParser() does
+ * not take is a bad answer - is put back at the end of the wait queue to
+ * start no sooner than retryDelayMs() from now. After NUM_TRIES tries, or
+ * when server rejects the query, XROADS is set XRDS_FAILED and done is
+ * called for it; the run goes on. With schedule rate set, query starts -
+ * tries again included - are paced by a token bucket holding one token.
+ * With schedule pool, each query - each try - goes to the server picked
+ * by pickEndpoint(); srvrURL is used for slot handles setup only. Ejected
+ * servers are probed in the multi handle; while none is healthy no query
+ * is started, and once all failed NUM_TRIES probes XROADS still waiting
+ * are set XRDS_FAILED.
+ *
+ * With schedule hedge set, one slot more than jobs is kept for hedges: a
+ * query running longer than p95 of good queries so far gets a copy on an
+ * idle slot - to another server when there is one. First good answer wins,
+ * the other query is cancelled; a failed copy leaves the other one alone.
+ * Each query time is limited to getQueryTimeout(); when schedule deadline
+ * passes, queries in flight are cancelled and XROADS not done yet are set
+ * XRDS_FAILED.
+ * With schedule adaptive set, jobs is the most queries in flight; the number
+ * is set by server slots and query outcomes, see adaptive.c.
+ * Return: ztSuccess - failed XROADS included - or error stopping the run.
+ ***************************************************************************/
+int multiGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL,
+		             QUERY_SCHEDULE *schedule, XRDS_DONE_FUNC done, void *doneData){
+
+	XROADS			**xrdsArray = NULL;
+	MEMORY_STRUCT	*rawArray = NULL;
+	char				*doneArray = NULL;
+	QUERY_SLOT		*slots = NULL;
+	CURLM			*multiHandle = NULL;
+	CURLMsg			*msg;
+	CURLMcode		mResult;
+	DL_ELEM			*elem;
+	QUERY_SLOT		*slot, *idle;
+	XROADS			*xrds;
+	WAIT_QUEUE		queue;
+	LATENCY_RING		latency;
+	ADAPTIVE			adapt;
+	QUERY_FAILURE	failure;
+	double			now, wait, ready, tokens, lastRefill;
+	int				total, maxJobs, jobLimit, numSlots, flushIndex;
+	int				numDone, numBusy, numPrimary, numFailed;
+	int				numHedged = 0, numHedgeWins = 0;
+	int				outOfTime = 0;
+	int				serverUp;
+	int				running, msgsLeft;
+	int				iCount, index, isHedge;
+	int				result;
+	int				retCode = ztSuccess;
+
+	ASSERTARGS (xrdsDL && bbox && srvrURL && schedule);
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	maxJobs = schedule->jobs;
+	if (maxJobs < 1 || maxJobs > MAX_JOBS){
+		fprintf(stderr, "multiGetXrdsDL(): Error maxJobs out of range [1 - %d].\n", MAX_JOBS);
+		return ztOutOfRangePara;
+	}
+
+	if (schedule->rate < 0 || schedule->rate > MAX_RATE){
+		fprintf(stderr, "multiGetXrdsDL(): Error rate out of range [0 - %d].\n", MAX_RATE);
+		return ztOutOfRangePara;
+	}
+
+	total = DL_SIZE(xrdsDL);
+	if (maxJobs > total)
+
+		maxJobs = total;
+
+	numSlots = maxJobs + (schedule->hedge ? 1 : 0);
+
+	memset (&queue, 0, sizeof(WAIT_QUEUE));
+	memset (&latency, 0, sizeof(LATENCY_RING));
+
+	xrdsArray = (XROADS **) malloc (sizeof(XROADS *) * total);
+	doneArray = (char *) calloc (total, sizeof(char));
+	slots = (QUERY_SLOT *) calloc (numSlots, sizeof(QUERY_SLOT));
+	if (rawDataFP)
+		rawArray = (MEMORY_STRUCT *) calloc (total, sizeof(MEMORY_STRUCT));
+
+	if ( ! xrdsArray || ! doneArray || ! slots || (rawDataFP && ! rawArray) ||
+		initialWaitQueue (&queue, total) != ztSuccess ){
+		fprintf(stderr, "multiGetXrdsDL(): Error allocating memory.\n");
+		retCode = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	iCount = 0;
+	for (elem = DL_HEAD(xrdsDL); elem; elem = DL_NEXT(elem))
+
+		xrdsArray[iCount++] = (XROADS *) DL_DATA(elem);
+
+	multiHandle = curl_multi_init();
+	if ( ! multiHandle ){
+		fprintf(stderr, "multiGetXrdsDL(): Error returned from curl_multi_init().\n");
+		retCode = ztGotNull;
+		goto cleanup;
+	}
+
+	for (iCount = 0; iCount < numSlots; iCount++){
+
+		slot = &slots[iCount];
+
+		initialArena (&slot->arena, 0);
+
+		slot->shadow.point = &slot->shadowPoint;
+		for (index = 0; index < MAX_NODES; index++)
+			slot->shadow.nodesGPS[index] = &slot->shadowGps[index];
+		slot->shadow.midGps = &slot->shadowGps[MAX_NODES];
+
+		slot->handle = initialQuery (srvrURL);
+		if ( ! slot->handle ){
+			fprintf(stderr, "multiGetXrdsDL(): Error returned from initialQuery().\n");
+			retCode = ztGotNull;
+			goto cleanup;
+		}
+	}
+
+	if (schedule->adaptive)
+		initialAdaptive (&adapt, maxJobs, schedule->pool, srvrURL);
+
+	flushIndex = numDone = numBusy = numFailed = 0;
+	tokens = 1.0;
+	lastRefill = nowMs();
+
+	while (numDone < total){
+
+		now = nowMs();
+
+		if (schedule->deadline > 0 && now >= schedule->deadline){
+
+			outOfTime = 1;
+			break;
+		}
+
+		if (schedule->rate > 0){
+
+			tokens = MIN(1.0, tokens + (now - lastRefill) * schedule->rate / 1000.0);
+			lastRefill = now;
+		}
+
+		/* with no server healthy queries wait in queue for a probe */
+		serverUp = TRUE;
+		if (schedule->pool){
+
+			result = startProbes (schedule->pool, multiHandle);
+			if (result != ztSuccess){
+				retCode = result;
+				goto cleanup;
+			}
+
+			serverUp = (numHealthy (schedule->pool) > 0);
+
+			if ( ! serverUp && queue.count && isPoolDown (schedule->pool) ){
+
+				fprintf(stderr, "multiGetXrdsDL(): Error no server answers; [ %d ] "
+						    "cross roads not sent.\n", queue.count);
+
+				while (queue.count){
+
+					index = popWait (&queue);
+
+					xrdsArray[index]->nodesNum = 0;
+					xrdsArray[index]->status = XRDS_FAILED;
+					doneArray[index] = 1;
+					numDone++;
+					numFailed++;
+
+					if (done)
+						done (xrdsArray[index], doneData);
+				}
+
+				while (flushIndex < total && doneArray[flushIndex]){
+
+					if (rawArray && rawArray[flushIndex].memory){
+						xrdsWriteRawData (xrdsArray[flushIndex], &rawArray[flushIndex]);
+						zapMemory (&rawArray[flushIndex]);
+					}
+
+					flushIndex++;
+				}
+
+				if (numDone == total)
+
+					break;
+			}
+		}
+
+		/* hedge slow queries first, they hold up output in input order */
+		for (iCount = 0; serverUp && schedule->hedge && latency.p95 > 0 && iCount < numSlots; iCount++){
+
+			slot = &slots[iCount];
+
+			if ( ! slot->busy || slot->twin || now - slot->started < latency.p95 )
+
+				continue;
+
+			if (schedule->rate > 0 && tokens < 1.0)
+
+				break;
+
+			for (idle = slots; idle < slots + numSlots && idle->busy; idle++)
+				;
+
+			if (idle == slots + numSlots)
+
+				break;
+
+			result = startHedge (multiHandle, idle, slot, bbox, schedule);
+			if (result != ztSuccess){
+				retCode = result;
+				goto cleanup;
+			}
+
+			numBusy++;
+			numHedged++;
+
+			if (schedule->rate > 0)
+				tokens -= 1.0;
+		}
+
+		/* keep idle slots busy while we have XROADS ready; no more than
+		 * jobs of them, a hedge slot is left */
+		numPrimary = countPrimary (slots, numSlots);
+		jobLimit = schedule->adaptive ? adaptiveLimit (&adapt) : maxJobs;
+
+		for (iCount = 0; serverUp && iCount < numSlots && queue.count && numPrimary < jobLimit; iCount++){
+
+			if (slots[iCount].busy)
+
+				continue;
+
+			if (schedule->rate > 0 && tokens < 1.0)
+
+				break;
+
+			index = takeReady (&queue, now);
+			if (index < 0)
+
+				break;
+
+			result = startSlot (multiHandle, &slots[iCount], xrdsArray[index], index,
+					                     bbox, schedule, NULL);
+			if (result != ztSuccess){
+				retCode = result;
+				goto cleanup;
+			}
+
+			queue.tries[index]++;
+			numBusy++;
+			numPrimary++;
+
+			if (schedule->rate > 0)
+				tokens -= 1.0;
+		}
+
+		mResult = curl_multi_perform (multiHandle, &running);
+		if (mResult != CURLM_OK){
+			fprintf(stderr, "multiGetXrdsDL(): curl_multi_perform() failed: %s\n",
+					    curl_multi_strerror(mResult));
+			retCode = ztFatalError;
+			goto cleanup;
+		}
+
+		while ((msg = curl_multi_info_read (multiHandle, &msgsLeft))){
+
+			if (msg->msg != CURLMSG_DONE)
+
+				continue;
+
+			if (schedule->pool &&
+				probeDone (schedule->pool, multiHandle, msg->easy_handle, msg->data.result))
+
+				continue;
+
+			for (slot = slots; slot->handle != msg->easy_handle; slot++)
+				;
+
+			if ( ! slot->busy ) // cancelled twin
+
+				continue;
+
+			curl_multi_remove_handle (multiHandle, slot->handle);
+			slot->busy = 0;
+			numBusy--;
+
+			isHedge = slot->hedge;
+			slot->hedge = 0;
+			xrds = xrdsArray[slot->index];
+
+			failure = queryFailure (slot->handle, msg->data.result);
+
+			if (failure == QUERY_OK){
+
+				result = finishXrdsParser (&slot->parser);
+				if (result == ztMemoryAllocate){
+					retCode = result;
+					goto cleanup;
+				}
+
+				if (result != ztSuccess)
+					failure = QUERY_BAD_ANSWER;
+			}
+
+			/* query cut short by run deadline says nothing about server;
+			 * its XROADS is set failed below with the others not done */
+			if (msg->data.result == CURLE_OPERATION_TIMEDOUT && schedule->deadline > 0 &&
+				(getQueryTimeout () == 0 ||
+				 slot->started + getQueryTimeout () > schedule->deadline))
+				failure = QUERY_CANCELLED;
+
+			if (slot->endpoint)
+				endpointDone (schedule->pool, slot->endpoint, failure);
+
+			if (schedule->adaptive)
+				adaptiveDone (&adapt, failure, nowMs () - slot->started);
+
+			if (failure == QUERY_CANCELLED){
+
+				if (slot->twin){
+
+					slot->twin->twin = NULL;
+					slot->twin = NULL;
+				}
+				continue;
+			}
+
+			if (failure != QUERY_OK){
+
+				fprintf(stderr, "multiGetXrdsDL(): Error %s [%d of %d] for [ %s && %s ]: %s\n",
+						    isHedge ? "hedge for try" : "try",
+						    queue.tries[slot->index], NUM_TRIES, xrds->firstRD, xrds->secondRD,
+						    (msg->data.result != CURLE_OK) ?
+						    curl_easy_strerror(msg->data.result) : failureName (failure));
+
+				/* other query for this XROADS goes on */
+				if (slot->twin){
+
+					slot->twin->twin = NULL;
+					slot->twin = NULL;
+					continue;
+				}
+
+				if (failure != QUERY_REJECTED && queue.tries[slot->index] < NUM_TRIES){
+
+					queue.readyAt[slot->index] = nowMs () +
+							                      retryDelayMs (failure, queue.tries[slot->index]);
+					pushWait (&queue, slot->index);
+					continue;
+				}
+
+				/* shows server error message, if any */
+				if (failure == QUERY_RATE_LIMIT || failure == QUERY_GATEWAY ||
+					failure == QUERY_REJECTED)
+					finishXrdsParser (&slot->parser);
+
+				xrds->nodesNum = 0;
+				xrds->status = XRDS_FAILED;
+				numFailed++;
+			}
+			else {
+
+				if (slot->twin){
+
+					cancelSlot (multiHandle, slot->twin, schedule->pool);
+					slot->twin = NULL;
+					numBusy--;
+					numHedgeWins += isHedge;
+				}
+
+				if (isHedge)
+					copyResult (xrds, &slot->shadow);
+
+				addLatency (&latency, nowMs () - slot->started);
+			}
+
+			/* progress to stderr, results may be on stdout */
+			fprintf(stderr, "multiGetXrdsDL(): %s [%d of %d].\n",
+					    (failure == QUERY_OK) ? "Done" : "Failed", slot->index + 1, total);
+
+			/* raw data - last try for failed XROADS: write now if this is
+			 * the next one in input order, else keep a copy until its turn
+			 * comes; handle memory is reused by the next query. */
+			if (rawArray && slot->index == flushIndex)
+
+				xrdsWriteRawData (xrds, slot->parser.raw);
+
+			else if (rawArray){
+
+				if (appendMemory (&rawArray[slot->index], MEMORY_BYTES(slot->parser.raw),
+						                     MEMORY_LENGTH(slot->parser.raw)) != ztSuccess){
+					retCode = ztMemoryAllocate;
+					goto cleanup;
+				}
+			}
+
+			doneArray[slot->index] = 1;
+			numDone++;
+
+			if (done)
+				done (xrds, doneData);
+
+			while (flushIndex < total && doneArray[flushIndex]){
+
+				if (rawArray && rawArray[flushIndex].memory){
+					xrdsWriteRawData (xrdsArray[flushIndex], &rawArray[flushIndex]);
+					zapMemory (&rawArray[flushIndex]);
+				}
+
+				flushIndex++;
+			}
+
+		} // end while (msg)
+
+		if (numDone == total)
+
+			break;
+
+		/* wait for transfers, but no longer than until an idle slot can
+		 * start next query - its backoff is over and a token is in - or a
+		 * query is due for a hedge, or run deadline. */
+		wait = 1000.0;
+
+		now = nowMs();
+		ready = nextReadyMs (&queue, now);
+		jobLimit = schedule->adaptive ? adaptiveLimit (&adapt) : maxJobs;
+		if (serverUp && numBusy < numSlots && countPrimary (slots, numSlots) < jobLimit &&
+			ready >= 0)
+			wait = MIN(wait, ready);
+
+		/* probe due; a running probe wakes poll when it is done */
+		if (schedule->pool && nextProbeMs (schedule->pool, now) >= 0)
+			wait = MIN(wait, nextProbeMs (schedule->pool, now));
+
+		for (iCount = 0; schedule->hedge && latency.p95 > 0 && numBusy < numSlots &&
+		                 iCount < numSlots; iCount++)
+
+			if (slots[iCount].busy && ! slots[iCount].twin)
+				wait = MIN(wait, MAX(slots[iCount].started + latency.p95 - now, 0.0));
+
+		if (wait < 1000.0 && schedule->rate > 0 && tokens < 1.0)
+			wait = MAX(wait, (1.0 - tokens) * 1000.0 / schedule->rate);
+
+		if (schedule->deadline > 0)
+			wait = MIN(wait, MAX(schedule->deadline - now, 0.0));
+
+		if (wait > 0){
+
+			mResult = curl_multi_poll (multiHandle, NULL, 0, (int) wait + 1, NULL);
+			if (mResult != CURLM_OK){
+				fprintf(stderr, "multiGetXrdsDL(): curl_multi_poll() failed: %s\n",
+						    curl_multi_strerror(mResult));
+				retCode = ztFatalError;
+				goto cleanup;
+			}
+		}
+
+	} // end while (numDone < total)
+
+	if (outOfTime){
+
+		/* cancel queries in flight, all not done yet have failed */
+		for (iCount = 0; iCount < numSlots; iCount++)
+
+			if (slots[iCount].busy)
+				cancelSlot (multiHandle, &slots[iCount], schedule->pool);
+
+		fprintf(stderr, "multiGetXrdsDL(): Error run deadline passed; [ %d ] of [ %d ] "
+				    "cross roads not done.\n", total - numDone, total);
+
+		for (index = 0; index < total; index++){
+
+			if (doneArray[index])
+
+				continue;
+
+			xrdsArray[index]->nodesNum = 0;
+			xrdsArray[index]->status = XRDS_FAILED;
+			doneArray[index] = 1;
+			numDone++;
+			numFailed++;
+
+			if (done)
+				done (xrdsArray[index], doneData);
+		}
+
+		for ( ; flushIndex < total; flushIndex++){
+
+			if (rawArray && rawArray[flushIndex].memory){
+				xrdsWriteRawData (xrdsArray[flushIndex], &rawArray[flushIndex]);
+				zapMemory (&rawArray[flushIndex]);
+			}
+		}
+	}
+
+	if (schedule->adaptive)
+		printAdaptive (&adapt);
+
+	if (numHedged)
+		printf ("multiGetXrdsDL(): [ %d ] queries hedged at p95 latency [ %.0f ] ms, "
+				   "[ %d ] hedges won.\n", numHedged, latency.p95, numHedgeWins);
+
+	if (numFailed)
+		printf ("multiGetXrdsDL(): [ %d ] of [ %d ] cross roads failed.\n",
+				    numFailed, total);
+
+cleanup:
+
+	if (schedule->pool && multiHandle)
+		stopProbes (schedule->pool, multiHandle);
+
+	if (slots){
+
+		for (iCount = 0; iCount < numSlots; iCount++){
+
+			slot = &slots[iCount];
+
+			if (slot->busy && multiHandle)
+				curl_multi_remove_handle (multiHandle, slot->handle);
+
+			if (slot->handle)
+				closeQuery (slot->handle);
+
+			zapArena (&slot->arena);
+		}
+
+		free (slots);
+	}
+
+	if (multiHandle)
+		curl_multi_cleanup (multiHandle);
+
+	if (rawArray){
+
+		for (iCount = 0; iCount < total; iCount++)
+
+			zapMemory (&rawArray[iCount]);
+
+		free (rawArray);
+	}
+
+	zapWaitQueue (&queue);
+
+	if (doneArray)
+		free (doneArray);
+
+	if (xrdsArray)
+		free (xrdsArray);
+
+	return retCode;
+
+} // END multiGetXrdsDL()
@@ -0,0 +1,414 @@
+/*
+ * nameIndex.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Street name dictionary: names of all ways in bbox the cross roads query
+ * can match are fetched once per bbox with namesFillTemplate() query and
+ * kept sorted in memory. Each pair is checked against it before any query
+ * is sent; a name that is in no way name can only give zero nodes, so the
+ * pair is resolved as not found here and near matches are shown instead.
+ * A name found in exactly one way name is replaced with that canonical
+ * name, which the server then matches exactly - not with case insensitive
+ * regular expression.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <curl/curl.h>
+
+#include "nameIndex.h"
+#include "overpass-c.h"
+#include "curl_func.h"
+#include "util.h"
+#include "ztError.h"
+
+static char	*namesHeader = "name";
+
+/* initialNameIndex(): sets index to empty, nothing loaded. */
+void initialNameIndex (NAME_INDEX *index){
+
+	ASSERTARGS (index);
+
+	memset (index, 0, sizeof(NAME_INDEX));
+	initialArena (&index->arena, 0);
+
+	return;
+}
+
+/* dropNames(): frees names in index, arena is kept for reuse. */
+static void dropNames (NAME_INDEX *index){
+
+	if (index->names)
+		free (index->names);
+
+	if (index->lowerNames)
+		free (index->lowerNames);
+
+	index->names = NULL;
+	index->lowerNames = NULL;
+	index->count = 0;
+	index->loaded = 0;
+
+	resetArena (&index->arena);
+
+	return;
+}
+
+/* zapNameIndex(): frees all memory in index, it is empty after. */
+void zapNameIndex (NAME_INDEX *index){
+
+	ASSERTARGS (index);
+
+	dropNames (index);
+	zapArena (&index->arena);
+
+	memset (index, 0, sizeof(NAME_INDEX));
+
+	return;
+}
+
+static int compareNames (const void *first, const void *second){
+
+	return strcmp (*(char * const *) first, *(char * const *) second);
+}
+
+/* lowerCopy(): copies src into dst of size in lower case, truncates. */
+static void lowerCopy (char *dst, const char *src, size_t size){
+
+	size_t	iCount;
+
+	for (iCount = 0; src[iCount] && iCount < size - 1; iCount++)
+
+		dst[iCount] = (char) tolower ((unsigned char) src[iCount]);
+
+	dst[iCount] = '\0';
+
+	return;
+}
+
+/* parseNamesData(): lines after header in response are way names - one
+ * for each way, so repeated - they are copied into index, sorted and made
+ * distinct; lower case copies are made in the same order.
+ * Return: ztSuccess or ztMemoryAllocate.
+ */
+static int parseNamesData (NAME_INDEX *index, MEMORY_STRUCT *data){
+
+	char		*ptr = MEMORY_BYTES(data);
+	char		*end = ptr + MEMORY_LENGTH(data);
+	char		*lineFeed;
+	char		**newNames;
+	size_t	length;
+	int		capacity = 0;
+	int		iCount, numDistinct;
+
+	lineFeed = memchr (ptr, '\n', end - ptr); // header, checked by caller
+	ptr = lineFeed ? lineFeed + 1 : end;
+
+	while (ptr < end){
+
+		lineFeed = memchr (ptr, '\n', end - ptr);
+		length = (lineFeed ? lineFeed : end) - ptr;
+
+		if (length && ptr[length - 1] == '\r')
+			length--;
+
+		if (length){
+
+			if (index->count == capacity){
+
+				capacity = capacity ? capacity * 2 : 1024;
+
+				newNames = (char **) realloc (index->names, sizeof(char *) * capacity);
+				if ( ! newNames )
+
+					return ztMemoryAllocate;
+
+				index->names = newNames;
+			}
+
+			index->names[index->count] = (char *) arenaAlloc (&index->arena, length + 1);
+			if ( ! index->names[index->count] )
+
+				return ztMemoryAllocate;
+
+			memcpy (index->names[index->count], ptr, length);
+			index->names[index->count][length] = '\0';
+			index->count++;
+		}
+
+		ptr = lineFeed ? lineFeed + 1 : end;
+	}
+
+	if (index->count == 0)
+
+		return ztSuccess;
+
+	qsort (index->names, index->count, sizeof(char *), compareNames);
+
+	for (iCount = 1, numDistinct = 1; iCount < index->count; iCount++)
+
+		if (strcmp (index->names[iCount], index->names[numDistinct - 1]) != 0)
+
+			index->names[numDistinct++] = index->names[iCount];
+
+	index->count = numDistinct;
+
+	index->lowerNames = (char **) malloc (sizeof(char *) * index->count);
+	if ( ! index->lowerNames )
+
+		return ztMemoryAllocate;
+
+	for (iCount = 0; iCount < index->count; iCount++){
+
+		length = strlen (index->names[iCount]) + 1;
+
+		index->lowerNames[iCount] = (char *) arenaAlloc (&index->arena, length);
+		if ( ! index->lowerNames[iCount] )
+
+			return ztMemoryAllocate;
+
+		lowerCopy (index->lowerNames[iCount], index->names[iCount], length);
+	}
+
+	return ztSuccess;
+}
+
+/* loadNameIndex(): fetches street names in bbox into index with one
+ * namesFillTemplate() query; nothing is fetched when index is loaded for
+ * the same bbox already. Names for a previous bbox are dropped.
+ * Return: ztSuccess, ztGotNull, ztMemoryAllocate or query error.
+ ***************************************************************************/
+int loadNameIndex (NAME_INDEX *index, BBOX *bbox, CURLU *srvrURL){
+
+	CURL				*handle;
+	MEMORY_STRUCT	*answer;
+	char				*query;
+	int				result;
+
+	ASSERTARGS (index && bbox && srvrURL);
+
+	if (index->loaded &&
+		index->bbox.sw.gps.latE7 == bbox->sw.gps.latE7 &&
+		index->bbox.sw.gps.lonE7 == bbox->sw.gps.lonE7 &&
+		index->bbox.ne.gps.latE7 == bbox->ne.gps.latE7 &&
+		index->bbox.ne.gps.lonE7 == bbox->ne.gps.lonE7)
+
+		return ztSuccess;
+
+	dropNames (index);
+
+	result = namesFillTemplate (&query, bbox);
+	if (result != ztSuccess)
+
+		return result;
+
+	handle = initialQuery (srvrURL);
+	if ( ! handle ){
+		fprintf (stderr, "loadNameIndex(): Error returned from initialQuery().\n");
+		free (query);
+		return ztGotNull;
+	}
+
+	answer = queryMemory (handle);
+
+	result = performQuery (answer, query, namesHeader, srvrURL, handle);
+	free (query);
+	if (result != ztSuccess){
+		fprintf (stderr, "loadNameIndex(): Error returned from performQuery().\n");
+		goto cleanup;
+	}
+
+	if (rawDataFP) {
+
+		fprintf (rawDataFP, "Data for street names in bbox:\n\n");
+		fprintf (rawDataFP, "%s", MEMORY_BYTES(answer));
+		fprintf (rawDataFP,
+				"\n ++++++++++++++++++++++++++++++++++++++++++++++++\n\n");
+		fflush (rawDataFP);
+	}
+
+	result = parseNamesData (index, answer);
+
+	if (result != ztSuccess){
+		fprintf (stderr, "loadNameIndex(): Error getting street names: %s\n",
+				    code2Msg (result));
+		dropNames (index);
+		goto cleanup;
+	}
+
+	index->bbox = *bbox;
+	index->loaded = 1;
+
+	printf ("loadNameIndex(): [ %d ] street names in bbox.\n", index->count);
+
+cleanup:
+
+	closeQuery (handle);
+
+	return result;
+
+} // END loadNameIndex()
+
+/* regular expression operators; server matches name as expression, so a
+ * name with any of them can not be checked as plain text */
+static const char	*regexChars = ".[](){}*+?|^$\\";
+
+/* findName(): returns number of names in index containing name - case
+ * insensitive - the names server regular expression matches; *match is set
+ * to the last one found. Returns -1 for name with a regular expression
+ * operator, it is not checked.
+ */
+static int findName (NAME_INDEX *index, const char *name, int *match){
+
+	char		lower[LONG_LINE];
+	int		iCount;
+	int		numMatch = 0;
+
+	if (strpbrk (name, regexChars))
+
+		return -1;
+
+	lowerCopy (lower, name, sizeof(lower));
+
+	for (iCount = 0; iCount < index->count; iCount++)
+
+		if (strstr (index->lowerNames[iCount], lower)){
+
+			*match = iCount;
+			numMatch++;
+		}
+
+	return numMatch;
+}
+
+/* substringDistance(): least edit distance between pattern of length and
+ * any part of text - both lower case - so a partial name is compared with
+ * the part of a street name it stands for.
+ */
+static int substringDistance (const char *pattern, size_t length, const char *text){
+
+	int		column[LONG_LINE + 1];
+	int		diagonal, saved, cost;
+	int		best = (int) length;
+	size_t	iCount;
+
+	for (iCount = 0; iCount <= length; iCount++)
+
+		column[iCount] = (int) iCount;
+
+	for ( ; *text; text++){
+
+		diagonal = column[0];
+		column[0] = 0;
+
+		for (iCount = 1; iCount <= length; iCount++){
+
+			saved = column[iCount];
+			cost = (pattern[iCount - 1] != *text);
+
+			column[iCount] = MIN(MIN(column[iCount] + 1, column[iCount - 1] + 1),
+					                  diagonal + cost);
+			diagonal = saved;
+		}
+
+		best = MIN(best, column[length]);
+	}
+
+	return best;
+}
+
+/* suggestNames(): prints name as unknown with up to MAX_SUGGESTIONS names in
+ * index nearest to it; names more than a quarter of name length edits away -
+ * one edit for short names - are not given.
+ */
+static void suggestNames (NAME_INDEX *index, const char *name){
+
+	char		lower[LONG_LINE];
+	int		best[MAX_SUGGESTIONS];
+	int		bestDistance[MAX_SUGGESTIONS];
+	int		numBest = 0;
+	int		maxDistance, distance;
+	int		iCount, jCount;
+	size_t	length;
+
+	lowerCopy (lower, name, sizeof(lower));
+	length = strlen (lower);
+
+	maxDistance = (length <= 4) ? 1 : MAX(2, (int) length / 4);
+
+	for (iCount = 0; iCount < index->count; iCount++){
+
+		distance = substringDistance (lower, length, index->lowerNames[iCount]);
+		if (distance > maxDistance ||
+			(numBest == MAX_SUGGESTIONS && distance >= bestDistance[numBest - 1]))
+
+			continue;
+
+		if (numBest < MAX_SUGGESTIONS)
+			numBest++;
+
+		for (jCount = numBest - 1; jCount > 0 && bestDistance[jCount - 1] > distance; jCount--){
+
+			best[jCount] = best[jCount - 1];
+			bestDistance[jCount] = bestDistance[jCount - 1];
+		}
+
+		best[jCount] = iCount;
+		bestDistance[jCount] = distance;
+	}
+
+	printf ("checkXrdsNames(): Unknown street name <%s> in bbox", name);
+
+	for (iCount = 0; iCount < numBest; iCount++)
+
+		printf ("%s<%s>", iCount ? ", " : "; did you mean: ", index->names[best[iCount]]);
+
+	printf ("\n");
+
+	return;
+}
+
+/* checkXrdsNames(): checks both names of xrds against loaded index. Returns
+ * FALSE when a name is in no street name - query can only give zero nodes -
+ * and prints near matches for it; else TRUE. A name found in exactly one
+ * street name is replaced with that name and its exact bit is set in xrds;
+ * new name points into index, good until index is loaded for another bbox.
+ ***************************************************************************/
+int checkXrdsNames (NAME_INDEX *index, XROADS *xrds){
+
+	char		**names[2];
+	int		exactBit[2] = {XRDS_EXACT_FIRST, XRDS_EXACT_SECOND};
+	int		numMatch, match = 0;
+	int		known = TRUE;
+	int		side;
+
+	ASSERTARGS (index && xrds && xrds->firstRD && xrds->secondRD);
+
+	names[0] = &xrds->firstRD;
+	names[1] = &xrds->secondRD;
+
+	for (side = 0; side < 2; side++){
+
+		numMatch = findName (index, *names[side], &match);
+
+		if (numMatch == 0){
+
+			suggestNames (index, *names[side]);
+			known = FALSE;
+		}
+
+		/* quote in name would end query string */
+		else if (numMatch == 1 && ! strpbrk (index->names[match], "'\\")){
+
+			*names[side] = index->names[match];
+			xrds->exact |= exactBit[side];
+		}
+	}
+
+	return known;
+
+} // END checkXrdsNames()
@@ -104,6 +104,7 @@ int checkURL(const char* name, char *service, char** ipStr){
 
 	if (pmover == NULL) {
 	    fprintf(stderr, "checkURL(): failed to connect to: %s\n", name);
+	    freeaddrinfo(res);
 	    return ztNoConnError;
 	}
 
@@ -112,7 +113,7 @@ int checkURL(const char* name, char *service, char** ipStr){
 	            ipstr, sizeof ipstr);
 
 	*ipStr = strdup(ipstr);
-	if (ipStr == NULL){
+	if (*ipStr == NULL){
 		printf("checkURL(): Error allocating memory; strdup() failed!\n");
 		return ztMemoryAllocate;
 	}
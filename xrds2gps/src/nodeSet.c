@@ -0,0 +1,225 @@
+/*
+ * nodeSet.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Sorted integer sets for node ids; cross roads are nodes shared by the
+ * two streets, so finding them is a sorted set intersection.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nodeSet.h"
+#include "util.h"
+#include "ztError.h"
+
+/* initialNodeSet(): sets set to empty with room for capacity ids; zero
+ * capacity uses NODE_SET_INITIAL_SIZE. Returns ztSuccess or ztMemoryAllocate.
+ */
+int initialNodeSet (NODE_SET *set, int capacity){
+
+	ASSERTARGS (set);
+
+	if (capacity < 1)
+		capacity = NODE_SET_INITIAL_SIZE;
+
+	memset (set, 0, sizeof(NODE_SET));
+
+	set->ids = (int64_t *) malloc (sizeof(int64_t) * capacity);
+	if ( ! set->ids ){
+		fprintf(stderr, "initialNodeSet(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	set->capacity = capacity;
+
+	return ztSuccess;
+}
+
+/* growNodeSet(): makes room for need more ids, doubling capacity. */
+static int growNodeSet (NODE_SET *set, int need){
+
+	int64_t	*newIds;
+	int		newCapacity;
+
+	if (set->count + need <= set->capacity)
+
+		return ztSuccess;
+
+	newCapacity = set->capacity ? set->capacity : NODE_SET_INITIAL_SIZE;
+	while (newCapacity < set->count + need)
+		newCapacity *= 2;
+
+	newIds = (int64_t *) realloc (set->ids, sizeof(int64_t) * newCapacity);
+	if ( ! newIds ){
+		fprintf(stderr, "growNodeSet(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	set->ids = newIds;
+	set->capacity = newCapacity;
+
+	return ztSuccess;
+}
+
+/* addNodeSet(): appends id to set; set is not sorted after this call.
+ * Returns ztSuccess or ztMemoryAllocate.
+ */
+int addNodeSet (NODE_SET *set, int64_t id){
+
+	ASSERTARGS (set);
+
+	if (set->count == set->capacity && growNodeSet (set, 1) != ztSuccess)
+
+		return ztMemoryAllocate;
+
+	set->ids[set->count++] = id;
+
+	return ztSuccess;
+}
+
+/* appendNodeSet(): appends all ids in src to dest, dest is not sorted
+ * after this call. Returns ztSuccess or ztMemoryAllocate.
+ */
+int appendNodeSet (NODE_SET *dest, NODE_SET *src){
+
+	ASSERTARGS (dest && src);
+
+	if (growNodeSet (dest, src->count) != ztSuccess)
+
+		return ztMemoryAllocate;
+
+	if (src->count)
+		memcpy (dest->ids + dest->count, src->ids, sizeof(int64_t) * src->count);
+
+	dest->count += src->count;
+
+	return ztSuccess;
+}
+
+static int compareId (const void *first, const void *second){
+
+	int64_t	a = *(const int64_t *) first;
+	int64_t	b = *(const int64_t *) second;
+
+	return (a > b) - (a < b);
+}
+
+/* sortNodeSet(): sorts set ascending and drops repeated ids. */
+void sortNodeSet (NODE_SET *set){
+
+	int	iCount, kept;
+
+	ASSERTARGS (set);
+
+	if (set->count < 2)
+
+		return;
+
+	qsort (set->ids, set->count, sizeof(int64_t), compareId);
+
+	for (iCount = 1, kept = 1; iCount < set->count; iCount++)
+
+		if (set->ids[iCount] != set->ids[kept - 1])
+			set->ids[kept++] = set->ids[iCount];
+
+	set->count = kept;
+
+	return;
+}
+
+/* findNodeSet(): binary search of sorted set.
+ * Returns index of id in set or -1 when not found.
+ */
+int findNodeSet (NODE_SET *set, int64_t id){
+
+	int	low = 0, high, middle;
+
+	ASSERTARGS (set);
+
+	high = set->count - 1;
+
+	while (low <= high){
+
+		middle = low + (high - low) / 2;
+
+		if (set->ids[middle] < id)
+			low = middle + 1;
+		else if (set->ids[middle] > id)
+			high = middle - 1;
+		else
+			return middle;
+	}
+
+	return -1;
+}
+
+/* intersectNodeSets(): sets dest to ids found in both sorted sets, in
+ * ascending order; dest must be initialized and not one of the two.
+ * When one set is much smaller, its ids are searched for in the other;
+ * else both are walked together.
+ * Returns ztSuccess or ztMemoryAllocate.
+ */
+int intersectNodeSets (NODE_SET *dest, NODE_SET *first, NODE_SET *second){
+
+	NODE_SET	*small, *large;
+	int		iCount, jCount;
+
+	ASSERTARGS (dest && first && second);
+	ASSERTARGS (dest != first && dest != second);
+
+	dest->count = 0;
+
+	small = (first->count <= second->count) ? first : second;
+	large = (small == first) ? second : first;
+
+	if (small->count == 0)
+
+		return ztSuccess;
+
+	if (growNodeSet (dest, small->count) != ztSuccess)
+
+		return ztMemoryAllocate;
+
+	if (small->count * 16 < large->count){
+
+		for (iCount = 0; iCount < small->count; iCount++)
+
+			if (findNodeSet (large, small->ids[iCount]) >= 0)
+				dest->ids[dest->count++] = small->ids[iCount];
+
+		return ztSuccess;
+	}
+
+	iCount = jCount = 0;
+	while (iCount < first->count && jCount < second->count){
+
+		if (first->ids[iCount] < second->ids[jCount])
+			iCount++;
+		else if (first->ids[iCount] > second->ids[jCount])
+			jCount++;
+		else {
+			dest->ids[dest->count++] = first->ids[iCount];
+			iCount++;
+			jCount++;
+		}
+	}
+
+	return ztSuccess;
+}
+
+/* zapNodeSet(): frees ids memory, set is empty after. */
+void zapNodeSet (NODE_SET *set){
+
+	ASSERTARGS (set);
+
+	if (set->ids)
+		free (set->ids);
+
+	memset (set, 0, sizeof(NODE_SET));
+
+	return;
+}
@@ -4,7 +4,9 @@
  ***********************************************************************/
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #include "overpass-c.h"
 #include "dList.h"
@@ -14,9 +16,22 @@
 
 #include "curl_func.h"
 #include "op_string.h"
+#include "coord.h"
+
+/* coordinate layouts for formatGps(), same as "%10.7f" printf formats used
+ * before; formatter is in coord.c */
+static const COORD_FORMAT textNodeFormat = {"(", 10, ", ", 10, ")", ""};
+static const COORD_FORMAT textMidFormat = {"Mid-Point / Average: {", 10, ", ", 10, "}", ""};
+static const COORD_FORMAT wktPointFormat = {"\"POINT ((", 10, " ", 10, "))\"", ""};
+static const COORD_FORMAT wktRingFormat = {"", 11, " ", 10, "", ", "};
+static const COORD_FORMAT printNodeFormat = {"\t ", 10, ", ", 10, "\n", ""};
+static const COORD_FORMAT printMidFormat = {"\t [", 10, ", ", 10, "]\n", ""};
 
 /* Functions parseBbox() and xrdsParseNames() are used to parse input file */
 
+/* characters not allowed in road names */
+static char	*disallowedNameChars = "~!@#$%^&*()_+./\\|\":`<>[{]}";
+
 /* parseBbox(): parses string pointed to by string, assumed to be in the
  * following format with comma as delimiter:
  *  south-west latitude, south-west longitude, north-east latitude, north-east longitude
@@ -27,18 +42,17 @@
  *  	string: a character pointer to string to parse.
  *  Return: ztSuccess on success.
  *  Checked run time errors the function may return:
- *  ztBadLineZI, ztGotNull, ztInvalidToken, ztDisallowedChar
+ *  ztBadLineZI, ztInvalidToken, ztDisallowedChar
+ *  string is not changed.
  *
  *  ****************************************************/
 int parseBbox(BBOX *bbox, char *string){
 
-	char			*delim = ",";
-	char			*token;
-	char			*allowed = "0123456789.-+"; //digits, period, - and + signs
-	double	numDbl;
-	char			*endPtr;
+	const char	*token, *end;
+	size_t		length;
+	int32_t		numE7;
+	int			result;
 	int			i;
-	char			*SPACESET = "\040\t";  // space and tab
 	char			*chPtr;
 
 	// do not allow null pointers
@@ -54,38 +68,38 @@ int parseBbox(BBOX *bbox, char *string){
 		return ztBadLineZI;
 	}
 
-	/* get bbox members, that is 4 doubles delimited by comma */
+	/* get bbox members, that is 4 numbers delimited by comma; each token is
+	 * parsed in place as fixed point by scanCoordE7() */
+	token = string;
 	for (i = 0; i < 4; i++){
 
-		if(i == 0)
-			token = strtok(string, delim);
-		else
-			token = strtok(NULL, delim);
+		end = strchr (token, ',');
+		if (end == NULL)
+			end = token + strlen (token);
 
-		if (token == NULL) {
-			printf("parseBbox(): Error; could not get token number %d! NULL.\n", i+1);
-			return ztGotNull;
-		}
+		// trim space and tab both ends
+		while (token < end && (*token == ' ' || *token == '\t'))
+			token++;
+		while (end > token && (end[-1] == ' ' || end[-1] == '\t'))
+			end--;
+
+		length = end - token;
 
 		// is token ALL spaces?
-		if(strspn(token, SPACESET) == strlen(token)){
+		if (length == 0){
 			printf("parseBbox(): Error; ALL spaces token number %d! \n", i+1);
 			return ztInvalidToken;
-
 		}
 
-		removeSpaces(&token);
-
-		if(strspn(token, allowed) != strlen(token)){ // disallowed char found
-			printf("parseBbox(): Disallowed character in token number %d: [%s]\n",
-					    i+1, token);
-			return ztDisallowedChar;
+		result = scanCoordE7 (&numE7, token, length);
+		if (result == ztDisallowedChar){
+			printf("parseBbox(): Disallowed character in token number %d: [%.*s]\n",
+					    i+1, (int) length, token);
+			return result;
 		}
-
-		numDbl = (double) strtod (token, &endPtr);
-		if (*endPtr != '\0') {
-			printf("parseBbox(): Error invalid token for double: <%s>.\n", token);
-			return ztInvalidToken;
+		if (result != ztSuccess){
+			printf("parseBbox(): Error invalid token for number: <%.*s>.\n", (int) length, token);
+			return result;
 		}
 
 		/* check range for PHOENIX, ARIZONA */
@@ -93,8 +107,8 @@ int parseBbox(BBOX *bbox, char *string){
 			case 1:
 			case 3:
 
-			if (! LONGITUDE_OK (numDbl)){
-				printf("parseBbox(): Error; invalid Phoenix longitude. <%f>\n", numDbl);
+			if (! LONGITUDE_E7_OK (numE7)){
+				printf("parseBbox(): Error; invalid Phoenix longitude. <%.*s>\n", (int) length, token);
 				return ztInvalidToken;
 			}
 			break;
@@ -102,8 +116,8 @@ int parseBbox(BBOX *bbox, char *string){
 			case 0:
 			case 2:
 
-			if (! LATITUDE_OK(numDbl)){
-				printf("parseBbox(): Error; invalid Phoenix latitude. <%f>\n", numDbl);
+			if (! LATITUDE_E7_OK(numE7)){
+				printf("parseBbox(): Error; invalid Phoenix latitude. <%.*s>\n", (int) length, token);
 				return ztInvalidToken;
 			}
 			break;
@@ -116,19 +130,19 @@ int parseBbox(BBOX *bbox, char *string){
 		switch (i){  /* assign */
 
 		case 0:
-			bbox->sw.gps.latitude = numDbl;
+			bbox->sw.gps.latE7 = numE7;
 			break;
 
 		case 1:
-			bbox->sw.gps.longitude = numDbl;
+			bbox->sw.gps.lonE7 = numE7;
 			break;
 
 		case 2:
-			bbox->ne.gps.latitude= numDbl;
+			bbox->ne.gps.latE7 = numE7;
 			break;
 
 		case 3:
-			bbox->ne.gps.longitude = numDbl;
+			bbox->ne.gps.lonE7 = numE7;
 			break;
 
 		default:
@@ -136,26 +150,28 @@ int parseBbox(BBOX *bbox, char *string){
 
 		}  /* end switch to assign */
 
-	} /* end for (...) get gps bbox */
+		token = strchr (token, ',');
+		if (token)
+			token++;
 
-	// we might need to check the rest of the line!
+	} /* end for (...) get gps bbox */
 
 	return ztSuccess;
 
 } // END parseBbox()
 
-/* xrdsParseNames(): parses string into 2 cross road names,  comma as delimiter,
- * road names are placed into dest [XROADS struct] firstRd and secondRd members.
+/* parseNames(): parses string into 2 cross road names,  comma as delimiter,
+ * str is changed; first and second are set to names inside str.
  * returns integer as follows:
  *		ztSuccess: on success
  *		ztParseError: missing comma delimiter or missing token
  *		ztDisallowedChar: found disallowed character within a token
  **********************************************************************/
-int xrdsParseNames(XROADS *dest, char *str){
+int parseNames(char **first, char **second, char *str){
 
 	char			*delim = ",";
 	char			*token1, *token2;
-	char			*disallowed = "~!@#$%^&*()_+./\\|\":`<>[{]}"; //disallowed char set
+	char			*disallowed = disallowedNameChars;
 	int			COMMA = ',';
 	char			*ptr4COMMA = NULL;
 
@@ -163,7 +179,7 @@ int xrdsParseNames(XROADS *dest, char *str){
 	// we can also check its position; error if it is first or last character
 	ptr4COMMA = strchr (str, COMMA);
 	if (ptr4COMMA == NULL){
-		printf ("xrdsParseNames(): Error line is missing the comma delimiter!\n");
+		printf ("parseNames(): Error line is missing the comma delimiter!\n");
 		return ztParseError;
 	}
 
@@ -171,7 +187,7 @@ int xrdsParseNames(XROADS *dest, char *str){
 	token2 = strtok(NULL, delim);
 
 	if ( (token1 == NULL) || (token2 ==NULL) ){
-		printf ("xrdsParseNames(): Error got NULL for token1 or token2!\n");
+		printf ("parseNames(): Error got NULL for token1 or token2!\n");
 		return ztParseError;
 	}
 
@@ -179,157 +195,693 @@ int xrdsParseNames(XROADS *dest, char *str){
 	removeSpaces(&token2);
 
 	if(strcspn(token1, disallowed) != strlen(token1)){
-		printf("xrdsParseNames(): token1 <%s> has disallowed character. *****\n", token1);
+		printf("parseNames(): token1 <%s> has disallowed character. *****\n", token1);
 		return ztDisallowedChar;
 	}
 	if(strcspn(token2, disallowed) != strlen(token2)){
-		printf("xrdsParseNames(): token2 <%s> has disallowed character. *****\n", token2);
+		printf("parseNames(): token2 <%s> has disallowed character. *****\n", token2);
 		return ztDisallowedChar;
 	}
 
-	dest->firstRD = strdup(token1);
-	dest->secondRD = strdup(token2);
+	*first = token1;
+	*second = token2;
 
 	return ztSuccess;
 }
 
+/* xrdsParseNames(): parses string into 2 cross road names with parseNames(),
+ * road names are placed into dest [XROADS struct] firstRd and secondRd members.
+ * returns same as parseNames().
+ **********************************************************************/
+int xrdsParseNames(XROADS *dest, char *str){
 
-int parseGPS (GPS *dst, char *str){
-/* parse GPS point latitude and longitude members (overpass result line)
- * <	33.5605235		-112.0652852	> store result in dst members
- * dst is pointer to GPS structure in parseGPS2()
- * was XROADS pointer in parseGPS() - earlier function */
-	char			*myStr;
-	char			*delim = "\040\t";
-	char			*token1, *token2;
-	char			*allowed = "0123456789.-"; //digits, period and minus sign
-	double	numLat, numLng;
-	char			*endPtr;
+	char		*first, *second;
+	int		result;
 
-	// do not allow null pointers
-	ASSERTARGS (dst && str);
+	result = parseNames (&first, &second, str);
+	if (result != ztSuccess)
 
-	myStr = strdup(str);
+		return result;
 
-	token1 = strtok(myStr, delim);
-	token2 = strtok(NULL, delim);
+	dest->firstRD = strdup(first);
+	dest->secondRD = strdup(second);
 
-	if ((token1 == NULL ) || (token2 == NULL )) {
-		printf("parseGPS2(): Error; could not a get token! One of two is NULL.\n");
-			return ztGotNull;
+	return ztSuccess;
+}
+
+
+/* parseBboxView(): parseBbox() for a line view, view is not changed */
+int parseBboxView(BBOX *bbox, LINE_VIEW *view){
+
+	char		line[LONG_LINE];
+
+	ASSERTARGS (bbox && view);
+
+	if (lineView2Str (line, LONG_LINE, view) != ztSuccess){
+		printf ("parseBboxView(): Error line is too long!\n");
+		return ztStrToolong;
 	}
 
-	// removeSpaces(&token1); wrong! strtok() does this already
+	return parseBbox (bbox, line);
+}
+
+/* xrdsParseView(): parses line view into 2 cross road names with parseNames()
+ * and takes next XROADS from batch for them - names are copied into batch.
+ * dest is set to new XROADS. returns same as parseNames(), ztStrToolong
+ * for long line or ztMemoryAllocate when batch is full.
+ **********************************************************************/
+int xrdsParseView(XROADS **dest, XRDS_BATCH *batch, LINE_VIEW *view){
 
-	if(strspn(token1, allowed) != strlen(token1)){ // disallowed char found
-		printf("parseGPS2(): Disallowed character in token number 1.\n");
-		return ztDisallowedChar;
+	char		line[LONG_LINE];
+	char		*first, *second;
+	int		result;
+
+	ASSERTARGS (dest && batch && view);
+
+	if (lineView2Str (line, LONG_LINE, view) != ztSuccess){
+		printf ("xrdsParseView(): Error line is too long!\n");
+		return ztStrToolong;
 	}
 
-	numLat = (double) strtod (token1, &endPtr);
-	if (*endPtr != '\0') {
-		printf("parseGPS2(): Error invalid token for double: <%s>.\n", token1);
-		return ztInvalidToken;
+	result = parseNames (&first, &second, line);
+	if (result != ztSuccess)
+
+		return result;
+
+	*dest = batchNewXrds (batch, first, second);
+	if ( ! *dest )
+
+		return ztMemoryAllocate;
+
+	return ztSuccess;
+}
+
+/* sameName(): TRUE when names a and b are the same street: case folded
+ * and inner white space runs taken as one space, as pairKey() does. Names
+ * have no leading or trailing white space.
+ */
+static int sameName (const char *a, const char *b){
+
+	while (*a && *b){
+
+		if (isspace((unsigned char) *a) && isspace((unsigned char) *b)){
+
+			while (isspace((unsigned char) *a))
+				a++;
+			while (isspace((unsigned char) *b))
+				b++;
+			continue;
+		}
+
+		if (tolower((unsigned char) *a) != tolower((unsigned char) *b))
+
+			return FALSE;
+
+		a++;
+		b++;
 	}
 
-	if (! LATITUDE_OK(numLat)){
-		printf("parseGPS2(): Error; invalid Phoenix latitude. <%f>\n", numLat);
-		return ztInvalidToken;
+	return *a == *b;
+}
+
+/* gridAddNames(): adds comma separated names in str to names, copies are
+ * made in arena; a name already in names is skipped. Returns ztSuccess,
+ * ztParseError for empty name, ztDisallowedChar or ztMemoryAllocate.
+ */
+static int gridAddNames (char ***names, int *count, int *capacity, char *str, ARENA *arena){
+
+	char		*token, *save = NULL;
+	char		**newNames;
+	int		iCount;
+
+	for (token = strtok_r (str, ",", &save); token; token = strtok_r (NULL, ",", &save)){
+
+		if ( ! removeSpaces (&token) || *token == '\0' ){
+			printf ("gridAddNames(): Error empty street name.\n");
+			return ztParseError;
+		}
+
+		if (strcspn (token, disallowedNameChars) != strlen (token)){
+			printf ("gridAddNames(): Error street name <%s> has disallowed character.\n", token);
+			return ztDisallowedChar;
+		}
+
+		for (iCount = 0; iCount < *count; iCount++)
+
+			if (sameName ((*names)[iCount], token))
+				break;
+
+		if (iCount < *count){
+			printf ("gridAddNames(): Street name <%s> is listed more than once; "
+					   "used once.\n", token);
+			continue;
+		}
+
+		if (*count == *capacity){
+
+			*capacity = *capacity ? *capacity * 2 : 32;
+
+			newNames = (char **) realloc (*names, sizeof(char *) * *capacity);
+			if ( ! newNames )
+
+				return ztMemoryAllocate;
+
+			*names = newNames;
+		}
+
+		(*names)[*count] = arenaStrdup (arena, token);
+		if ( ! (*names)[*count] )
+
+			return ztMemoryAllocate;
+
+		(*count)++;
 	}
 
-	// removeSpaces(&token2);
+	return ztSuccess;
+}
 
-	if(strspn(token2, allowed) != strlen(token2)){ // disallowed char found
-		printf("parseGPS2(): Disallowed character in token number 2.\n");
-		return ztDisallowedChar;
+/* gridParseFile(): reads rest of input file - after bbox line - in grid
+ * form; lines are "NS: name" for north-south streets and "EW: name" for
+ * east-west streets, one line may list more names with comma between them.
+ * One XROADS is made for every NS, EW pair - NS street first - in NS order
+ * then EW order, and inserted in xrdsDL. batch is made here sized for the
+ * grid; caller frees it with zapXrdsBatch(), on error it is NULL.
+ * Returns ztSuccess, ztMissFormatFile, ztStrToolong, ztParseError,
+ * ztDisallowedChar or ztMemoryAllocate.
+ **********************************************************************/
+int gridParseFile (XRDS_BATCH **batch, DL_LIST *xrdsDL, MAPPED_FILE *mapped){
+
+	LINE_VIEW	view;
+	char			line[LONG_LINE];
+	char			**names[2] = {NULL, NULL};	// NS, EW
+	int			count[2] = {0, 0};
+	int			capacity[2] = {0, 0};
+	size_t		namesLength[2] = {0, 0};
+	ARENA		arena;
+	XROADS		*xrds;
+	int			side, iCount, jCount;
+	int			result = ztSuccess;
+
+	ASSERTARGS (batch && xrdsDL && mapped);
+
+	*batch = NULL;
+	initialArena (&arena, 0);
+
+	while (nextLineView (mapped, &view)){
+
+		if (lineView2Str (line, LONG_LINE, &view) != ztSuccess){
+			printf ("gridParseFile(): Error line # %d is too long!\n", view.lineNum);
+			result = ztStrToolong;
+			goto cleanup;
+		}
+
+		if (strncasecmp (line, "NS:", 3) == 0)
+			side = 0;
+		else if (strncasecmp (line, "EW:", 3) == 0)
+			side = 1;
+		else {
+			printf ("gridParseFile(): Error line # %d does not start with \"NS:\" "
+					   "or \"EW:\" <%s>\n", view.lineNum, line);
+			result = ztMissFormatFile;
+			goto cleanup;
+		}
+
+		result = gridAddNames (&names[side], &count[side], &capacity[side], line + 3, &arena);
+		if (result != ztSuccess){
+			printf ("gridParseFile(): Error in line # %d.\n", view.lineNum);
+			goto cleanup;
+		}
+	}
+
+	if (count[0] == 0 || count[1] == 0){
+		printf ("gridParseFile(): Error grid needs at least one NS and one EW street.\n");
+		result = ztMissFormatFile;
+		goto cleanup;
+	}
+
+	for (side = 0; side < 2; side++)
+
+		for (iCount = 0; iCount < count[side]; iCount++)
+
+			namesLength[side] += strlen (names[side][iCount]) + 1;
+
+	/* every NS name is copied once for each EW street and the other way */
+	*batch = initialXrdsBatch (count[0] * count[1],
+			                   namesLength[0] * count[1] + namesLength[1] * count[0]);
+	if ( ! *batch ){
+		result = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	for (iCount = 0; iCount < count[0]; iCount++){
+
+		for (jCount = 0; jCount < count[1]; jCount++){
+
+			xrds = batchNewXrds (*batch, names[0][iCount], names[1][jCount]);
+			if ( ! xrds ){
+				result = ztMemoryAllocate;
+				goto cleanup;
+			}
+
+			insertNextDL (xrdsDL, DL_TAIL(xrdsDL), xrds);
+		}
+	}
+
+cleanup:
+
+	if (result != ztSuccess && *batch)
+		zapXrdsBatch ((void **) batch);
+
+	for (side = 0; side < 2; side++)
+
+		if (names[side])
+			free (names[side]);
+
+	zapArena (&arena);
+
+	return result;
+
+} // END gridParseFile()
+
+/* namesParseFile(): reads rest of input file - after bbox line - as street
+ * names; one line may list more names with comma between them. Names are
+ * copied into arena, names array is allocated here and freed by caller -
+ * also on error; caller zaps arena.
+ * Returns ztSuccess, ztMissFormatFile, ztStrToolong, ztParseError,
+ * ztDisallowedChar or ztMemoryAllocate.
+ **********************************************************************/
+int namesParseFile (char ***names, int *numNames, ARENA *arena, MAPPED_FILE *mapped){
+
+	LINE_VIEW	view;
+	char			line[LONG_LINE];
+	int			capacity = 0;
+	int			result;
+
+	ASSERTARGS (names && numNames && arena && mapped);
+
+	*names = NULL;
+	*numNames = 0;
+
+	while (nextLineView (mapped, &view)){
+
+		if (lineView2Str (line, LONG_LINE, &view) != ztSuccess){
+			printf ("namesParseFile(): Error line # %d is too long!\n", view.lineNum);
+			return ztStrToolong;
+		}
+
+		result = gridAddNames (names, numNames, &capacity, line, arena);
+		if (result != ztSuccess){
+			printf ("namesParseFile(): Error in line # %d.\n", view.lineNum);
+			return result;
+		}
+	}
+
+	if (*numNames == 0){
+		printf ("namesParseFile(): Error no street name found.\n");
+		return ztMissFormatFile;
+	}
+
+	return ztSuccess;
+
+} // END namesParseFile()
+
+/* nextField(): returns next field in [*ptr, end) delimited by space or tab,
+ * sets length; *ptr is moved past the field. NULL when no field is left.
+ */
+static const char *nextField (const char **ptr, const char *end, size_t *length){
+
+	const char	*start = *ptr;
+	const char	*stop;
+
+	while (start < end && (*start == ' ' || *start == '\t'))
+		start++;
+
+	if (start == end)
+
+		return NULL;
+
+	for (stop = start; stop < end && *stop != ' ' && *stop != '\t'; stop++)
+		;
+
+	*length = stop - start;
+	*ptr = stop;
+
+	return start;
+}
+
+/* parseGPSView(): parses overpass result line of length characters -
+ * not zero terminated - "lat<TAB>lon<TAB>" into dst. Numbers are read as
+ * fixed point degrees * 10^7 by scanCoordE7(), no strtod() nor copy.
+ * Return: ztSuccess, ztGotNull for missing number, ztDisallowedChar or
+ * ztInvalidToken.
+ */
+int parseGPSView (GPS *dst, const char *line, size_t length){
+
+	const char	*ptr = line;
+	const char	*end = line + length;
+	const char	*token1, *token2;
+	size_t		len1 = 0, len2 = 0;
+	int32_t		latE7, lonE7;
+	int			result;
+
+	ASSERTARGS (dst && line);
+
+	token1 = nextField (&ptr, end, &len1);
+	token2 = nextField (&ptr, end, &len2);
+
+	if ((token1 == NULL ) || (token2 == NULL )) {
+		printf("parseGPSView(): Error; could not a get token! One of two is NULL.\n");
+		return ztGotNull;
 	}
 
-	numLng = (double) strtod (token2, &endPtr);
-	if (*endPtr != '\0') {
-		printf("parseGPS2(): Error invalid token for double: <%s>.\n", token2);
+	result = scanCoordE7 (&latE7, token1, len1);
+	if (result != ztSuccess){
+		printf("parseGPSView(): Error invalid latitude token: <%.*s>.\n", (int) len1, token1);
+		return result;
+	}
+
+	if (! LATITUDE_E7_OK(latE7)){
+		printf("parseGPSView(): Error; invalid Phoenix latitude. <%.*s>\n", (int) len1, token1);
 		return ztInvalidToken;
 	}
 
-	if (! LONGITUDE_OK (numLng)){
-		printf("parseGPS2(): Error; invalid Phoenix longitude. <%f>\n", numLng);
+	result = scanCoordE7 (&lonE7, token2, len2);
+	if (result != ztSuccess){
+		printf("parseGPSView(): Error invalid longitude token: <%.*s>.\n", (int) len2, token2);
+		return result;
+	}
+
+	if (! LONGITUDE_E7_OK (lonE7)){
+		printf("parseGPSView(): Error; invalid Phoenix longitude. <%.*s>\n", (int) len2, token2);
 		return ztInvalidToken;
 	}
 
 	// assign values
-	dst->longitude = numLng;
-	dst->latitude = numLat;
+	dst->lonE7 = lonE7;
+	dst->latE7 = latE7;
 
 	return ztSuccess;
 }
 
+/* parse GPS point latitude and longitude members (overpass result line)
+ * <	33.5605235		-112.0652852	> store result in dst members;
+ * str is not changed. See parseGPSView().
+ */
+int parseGPS (GPS *dst, char *str){
+
+	ASSERTARGS (dst && str);
+
+	return parseGPSView (dst, str, strlen (str));
+}
+
 /* parseCurlXrdsData() parses overpass query result, fills members:
  * nodesNum, nodesGps[i] and calculates/fills midGps. It also copies
  * calculated midGps to gps in point member.
+ * The whole response is fed to XRDS_PARSER in one call; see below.
  */
 
 int parseCurlXrdsData (XROADS *xrds, void *data){
 
 	MEMORY_STRUCT *theData;
-	char		*str;
-	char		*linefeed = "\n";
-	char		*ptr;
-
-	int				lineNum = 0;
-	DL_LIST		linesList; // will insert line by line into the list
-	LINE_INFO	*lineInfo;
-	int				result;
+	XRDS_PARSER	parser;
 
 	ASSERTARGS (xrds && data);
 
 	theData = (MEMORY_STRUCT *) data;
 
-	// initial the list
-	initialDL (&linesList, NULL, NULL);
+	initialXrdsParser (&parser, xrds, NULL);
 
-	str = strdup(theData->memory);
+	if (theData->memory)
+		feedXrdsParser (&parser, theData->memory, theData->size);
 
-	ptr = strtok(str, linefeed);
-	if (ptr == NULL){
-		printf("parseCurlXrdsData(): Error first ptr is NULL.\n");
-		return ztGotNull;
+	return finishXrdsParser (&parser);
+}
+
+/* Streaming parser for cross roads query response. The response is:
+ *   header line "@lat<TAB>@lon<TAB>@count"
+ *   zero or more node lines "lat<TAB>lon<TAB>"
+ *   one count line "<TAB><TAB>count"
+ * Bytes are fed as they arrive - from curl write callback usually - and
+ * XROADS members are filled line by line; a partial line is carried in
+ * the parser fixed buffer to the next chunk, no memory is allocated unless
+ * raw copy is wanted. The first PARSER_KEEP_LENGTH bytes are kept to show
+ * the server error message when the header does not match.
+ ***************************************************************************/
+
+static char	*xrdsHeader = "@lat	@lon	@count";
+
+/* initialXrdsParser(): sets parser to start a new response for xrds.
+ * With raw set, parser keeps a full copy of the response there for raw data
+ * file; raw is emptied here and owned by caller - queryMemory(handle) is the
+ * usual choice.
+ *************************************************************************/
+void initialXrdsParser (XRDS_PARSER *parser, XROADS *xrds, MEMORY_STRUCT *raw){
+
+	ASSERTARGS (parser && xrds);
+
+	memset (parser, 0, sizeof(XRDS_PARSER));
+
+	parser->xrds = xrds;
+	parser->numCount = -1;
+	parser->raw = raw;
+
+	if (raw)
+		resetMemory (raw);
+
+	xrds->nodesNum = 0;
+
+	return;
+}
+
+/* scanCount(): parses count line "<TAB><TAB>count" of length characters
+ * into count. Returns 1 on success, 0 for no number.
+ */
+static int scanCount (int *count, const char *line, size_t length){
+
+	const char	*end = line + length;
+	int			value = 0;
+	int			numDigits = 0;
+
+	while (line < end && (*line == '\t' || *line == ' '))
+		line++;
+
+	for ( ; line < end && *line >= '0' && *line <= '9'; line++, numDigits++)
+
+		value = value * 10 + (*line - '0');
+
+	if (numDigits == 0 || numDigits > 9)
+
+		return 0;
+
+	*count = value;
+
+	return 1;
+}
+
+/* parseXrdsLine(): handles one complete line of length characters, line is
+ * in response chunk or parser line buffer; not zero terminated.
+ */
+static void parseXrdsLine (XRDS_PARSER *parser, const char *line, size_t length){
+
+	XROADS	*xrds = parser->xrds;
+	int		result;
+
+	if (length && line[length - 1] == '\r')
+		length--;
+
+	parser->lineNum++;
+
+	if (parser->lineNum == 1){ // header line
+
+		if (length != strlen(xrdsHeader) || memcmp(line, xrdsHeader, length) != 0)
+			parser->error = ztInvalidResponse;
+
+		return;
 	}
 
-	while (ptr){
+	if (length == 0)
 
-		// allocate memory for lineInfo
-		lineInfo = (LINE_INFO *) malloc (sizeof(LINE_INFO));
-		if ( ! lineInfo){
+		return;
 
-			printf("parseCurlXrdsData(): Error allocating memory for lineInfo!\n");
-			return ztMemoryAllocate;
+	if (parser->numCount >= 0){ // nothing expected after count line
+
+		printf ("parseXrdsLine(): Error unexpected line after count line: <%.*s>\n",
+				   (int) length, line);
+		parser->error = ztInvalidResponse;
+		return;
+	}
+
+	if (line[0] == '\t'){ // count line
+
+		if ( ! scanCount (&parser->numCount, line, length) ){
+			printf ("parseXrdsLine(): Error invalid count line: <%.*s>\n", (int) length, line);
+			parser->error = ztInvalidToken;
 		}
-		// set members
-		lineInfo->originalNum = lineNum;
-		lineInfo->string = ptr;
 
-		// insert into list -
-		result = insertNextDL (&linesList, DL_TAIL(&linesList), (void *) lineInfo);
+		return;
+	}
+
+	/* node line - keep up to MAX_NODES */
+	if (parser->numRows < MAX_NODES){
+
+		result = parseGPSView (xrds->nodesGPS[parser->numRows], line, length);
 		if (result != ztSuccess){
-			printf("parseCurlXrdsData(): Error returned by insertNextDL().\n");
-			return result;
+			printf ("parseXrdsLine(): Error returned by parseGPSView().\n");
+			parser->error = result;
+			return;
 		}
+	}
 
-		lineNum++;
-		ptr = strtok (NULL, linefeed);
+	parser->numRows++;
+
+	return;
+}
 
-	} // end while(ptr) or parse lines.
+/* feedXrdsParser(): feeds length bytes to parser. Whole lines are parsed in
+ * place; only a line split between chunks is copied to parser line buffer.
+ * Return: ztSuccess or the first error found in the response so far.
+ *************************************************************************/
+int feedXrdsParser (XRDS_PARSER *parser, const char *bytes, size_t length){
 
-	result = parseXrdsResult (xrds, &linesList);
-	if (result != ztSuccess){
+	const char	*end, *lineFeed;
+	size_t		chunk;
 
-		printf ("parseCurlXrdsData(): Error returned by parseOverpassResult().\n");
-		destroyDL(&linesList);
-		return result;
+	ASSERTARGS (parser && bytes);
+
+	if (parser->keepLength < PARSER_KEEP_LENGTH - 1){
+
+		chunk = MIN(length, (size_t) (PARSER_KEEP_LENGTH - 1 - parser->keepLength));
+		memcpy (parser->keep + parser->keepLength, bytes, chunk);
+		parser->keepLength += chunk;
+	}
+
+	if (parser->raw && appendMemory (parser->raw, bytes, length) != ztSuccess){
+
+		printf ("feedXrdsParser(): Error allocating memory for raw data.\n");
+		parser->error = ztMemoryAllocate;
+		return parser->error;
+	}
+
+	end = bytes + length;
+
+	while (bytes < end && parser->error == ztSuccess){
+
+		lineFeed = memchr (bytes, '\n', end - bytes);
+		chunk = (lineFeed ? lineFeed : end) - bytes;
+
+		if (parser->lineLength + chunk >= PARSER_LINE_LENGTH){
+
+			/* a too long first line is not our header; html page most likely */
+			parser->error = (parser->lineNum == 0) ? ztInvalidResponse : ztStrToolong;
+			break;
+		}
+
+		if (lineFeed && parser->lineLength == 0){
+
+			parseXrdsLine (parser, bytes, chunk);
+			bytes = lineFeed + 1;
+			continue;
+		}
+
+		memcpy (parser->line + parser->lineLength, bytes, chunk);
+		parser->lineLength += chunk;
+
+		if ( ! lineFeed )
+
+			break;
+
+		parseXrdsLine (parser, parser->line, parser->lineLength);
+		parser->lineLength = 0;
+
+		bytes = lineFeed + 1;
+	}
+
+	return parser->error;
+}
+
+/* finishXrdsParser(): ends response; parses last line without line feed,
+ * then sets nodesNum and midGps in xrds.
+ * Return: ztSuccess, ztGotNull for empty response, ztInvalidResponse,
+ * ztUnexpectedEOF for missing count line or first error in response.
+ *************************************************************************/
+int finishXrdsParser (XRDS_PARSER *parser){
+
+	XROADS	*xrds;
+	int		numKept;
+
+	ASSERTARGS (parser);
+
+	xrds = parser->xrds;
+
+	if (parser->error == ztSuccess && parser->lineLength){
+
+		parseXrdsLine (parser, parser->line, parser->lineLength);
+		parser->lineLength = 0;
+	}
+
+	if (parser->error == ztSuccess && parser->lineNum == 0){
+
+		printf("finishXrdsParser(): Error empty response.\n");
+		parser->error = ztGotNull;
+	}
+
+	if (parser->error == ztInvalidResponse){
+
+		parser->keep[parser->keepLength] = '\0';
+		printf ("finishXrdsParser(): Error: Not a valid response. Server may responded "
+				    "with an error message! The server response was:\n\n");
+		printf (" Start server response below >>>>:\n\n");
+		printf ("%s\n\n", parser->keep);
+		printf (" >>>> End server response This line is NOT included.\n\n");
+	}
+
+	if (parser->error != ztSuccess)
+
+		return parser->error;
+
+	if (parser->numCount < 0){
+
+		printf("finishXrdsParser(): Error response has no count line.\n");
+		parser->error = ztUnexpectedEOF;
+		return parser->error;
+	}
+
+	if (parser->numCount != parser->numRows){
+
+		printf("finishXrdsParser(): Error count [ %d ] does not match [ %d ] node lines.\n",
+				   parser->numCount, parser->numRows);
+		parser->error = ztInvalidResponse;
+		return parser->error;
+	}
+
+	numKept = MIN(parser->numRows, MAX_NODES);
+	xrds->nodesNum = numKept;
+
+	if (numKept){
+
+		gpsCentroid (xrds->midGps, xrds->nodesGPS, numKept);
+
+		// set XRDOADS gps in point member to calculated averages
+		xrds->point->gps = *(xrds->midGps);
 	}
 
+	xrds->status = XRDS_RESOLVED;
+
 	return ztSuccess;
 }
 
+/* xrdsParserWrite(): curl write callback, userp is XRDS_PARSER pointer.
+ * All bytes are always taken; errors are reported by finishXrdsParser().
+ *************************************************************************/
+size_t xrdsParserWrite (char *contents, size_t size, size_t nmemb, void *userp){
+
+	size_t	realsize = size * nmemb;
+
+	feedXrdsParser ((XRDS_PARSER *) userp, contents, realsize);
+
+	return realsize;
+}
+
 /* parseWgetXrdsFile (): parses disk file downloaded by wget call to overpass
  * server. Fills dst (XROADS struct) members with parsed values for structure
  * members point (with longitude and latitude) also the nodesFound member.
@@ -352,7 +904,7 @@ int parseWgetXrdsFile (XROADS *dst, void *filename){
 	}
 	initialDL (outFileDL, zapLineInfo, NULL);
 
-	result = file2List(outFileDL, (char *) filename);
+	result = file2List(outFileDL, (char *) filename, NULL);
 	if (result != ztSuccess){
 		printf("parseWgetXrdsFile(): Error returned by file2List()!\n");
 		return result;
@@ -387,8 +939,6 @@ int parseXrdsResult (XROADS *dstXrds, DL_LIST *srcDL){
 	int				numFound;
 	char				*str;
 	int				iCount, result;
-	double		totalLongitude, totalLatitude;
-	double		avrgLongitude, avrgLatitude;
 
 	ASSERTARGS (dstXrds && srcDL);
 
@@ -413,7 +963,6 @@ int parseXrdsResult (XROADS *dstXrds, DL_LIST *srcDL){
 	 elem = DL_HEAD(srcDL);
 	 elem = DL_NEXT(elem); // second line
 
-	 totalLongitude = totalLatitude = 0.0;
 	 for (iCount = 0; iCount < numFound; iCount++, elem = DL_NEXT(elem)){
 
 		 ASSERTARGS (elem);
@@ -427,31 +976,132 @@ int parseXrdsResult (XROADS *dstXrds, DL_LIST *srcDL){
 			 return result;
 		 }
 
-		 totalLongitude += dstXrds->nodesGPS[iCount]->longitude;
-		 totalLatitude += dstXrds->nodesGPS[iCount]->latitude;
-
 	 }
 
-	 if (numFound == 1){
+	 gpsCentroid (dstXrds->midGps, dstXrds->nodesGPS, numFound);
 
-		 avrgLongitude = dstXrds->nodesGPS[0]->longitude;
-		 avrgLatitude = dstXrds->nodesGPS[0]->latitude;
-	 }
-	 else {
+	 // set XRDOADS gps in point member to calculated averages
+	 dstXrds->point->gps = *(dstXrds->midGps);
 
-		 avrgLongitude = totalLongitude / numFound;
-		 avrgLatitude = totalLatitude / numFound;
-	 }
+	 return ztSuccess;
+}
+/* setMidGps(): calculates average for found nodes in xrds, sets midGps and
+ * gps in point member to it. Nothing is done when nodesNum is zero.
+ ***************************************************************************/
+static void setMidGps (XROADS *xrds){
 
-	 dstXrds->midGps->longitude = avrgLongitude;
-	 dstXrds->midGps->latitude = avrgLatitude;
+	ASSERTARGS (xrds);
 
-	 // set XRDOADS gps in point member to calculated averages
-	 dstXrds->point->gps.longitude = avrgLongitude;
-	 dstXrds->point->gps.latitude= avrgLatitude;
+	if (xrds->nodesNum < 1)
 
-	 return ztSuccess;
+		return;
+
+	gpsCentroid (xrds->midGps, xrds->nodesGPS, xrds->nodesNum);
+
+	xrds->point->gps = *(xrds->midGps);
+
+	return;
 }
+
+/* parseBatchXrdsData(): parses response for query made by batchFillTemplate()
+ * into the XROADS list used to make the query. First line is the header, then
+ * for each pair in list order: zero or more node lines "lat<TAB>lon<TAB>"
+ * followed by a count line "<TAB><TAB>count". Count line closes its pair.
+ * Only the first MAX_NODES nodes are kept per pair.
+ * Return: ztSuccess, ztGotNull, ztUnexpectedEOF, ztInvalidResponse or error
+ * from parseGPSView().
+ ***************************************************************************/
+int parseBatchXrdsData (DL_LIST *xrdsDL, void *data){
+
+	MEMORY_STRUCT	*theData;
+	const char		*ptr, *next, *end;
+	size_t			length;
+	DL_ELEM			*elem;
+	XROADS			*xrds;
+	int				numRows = 0;
+	int				numCount;
+	int				result = ztSuccess;
+
+	ASSERTARGS (xrdsDL && data);
+
+	theData = (MEMORY_STRUCT *) data;
+
+	/* lines are parsed in place, response is not changed */
+	ptr = theData->memory;
+	end = ptr + theData->size;
+
+	next = memchr(ptr, '\n', end - ptr); // skip header line, checked by caller
+	if (next == NULL){
+		printf("parseBatchXrdsData(): Error response has no line feed.\n");
+		return ztGotNull;
+	}
+	ptr = next + 1;
+
+	elem = DL_HEAD(xrdsDL);
+
+	for ( ; ptr < end && elem; ptr = next){
+
+		next = memchr(ptr, '\n', end - ptr);
+		if (next){
+			length = next - ptr;
+			next++;
+		}
+		else {
+			length = end - ptr;
+			next = end;
+		}
+
+		if (length && ptr[length - 1] == '\r')
+			length--;
+
+		if (length == 0) // blank line
+
+			continue;
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		if (ptr[0] != '\t'){ // node line for current pair
+
+			if (numRows < MAX_NODES){
+
+				result = parseGPSView (xrds->nodesGPS[numRows], ptr, length);
+				if (result != ztSuccess){
+					printf ("parseBatchXrdsData(): Error returned by parseGPSView().\n");
+					break;
+				}
+			}
+
+			numRows++;
+			continue;
+		}
+
+		/* count line - closes current pair */
+		if ( ! scanCount (&numCount, ptr, length) || numCount != numRows){
+			printf ("parseBatchXrdsData(): Error count line <%.*s> does not match "
+					    "[ %d ] node lines for: %s && %s\n", (int) length, ptr, numRows,
+					    xrds->firstRD, xrds->secondRD);
+			result = ztInvalidResponse;
+			break;
+		}
+
+		xrds->nodesNum = MIN(numRows, MAX_NODES);
+		setMidGps (xrds);
+		xrds->status = XRDS_RESOLVED;
+
+		numRows = 0;
+		elem = DL_NEXT(elem);
+	}
+
+	if (result == ztSuccess && elem){
+		printf ("parseBatchXrdsData(): Error response ended before all pairs "
+				    "were parsed.\n");
+		result = ztUnexpectedEOF;
+	}
+
+	return result;
+
+} // END parseBatchXrdsData()
+
 /* response2LineDL() : function parses overpass response - gets white space
  * clean tokens - for street for street names query
  * lines are placed in double linked list of pointers to CHARACTER STRINGS.
@@ -496,10 +1146,11 @@ void writeXrds (FILE *file, void *data){ // partial - half-assed job
 
 	int	iCount;
 	FILE	*filePtr;
-	char		namesBuf[100] = {0};
 	char		pointBuf[36] = {0};
+	char		midBuf[64] = {0};
 //	char		buf[LONG_LINE] = {0};
 	char		*notFound = "------- Not Found -------";
+	char		*failed = "----- Query Failed ------";
 	char		*dashLine = "--------------------------------------------------------------------------------\n";
 
 	XROADS	*xrds;
@@ -516,13 +1167,11 @@ void writeXrds (FILE *file, void *data){ // partial - half-assed job
 
 	xrds = (XROADS *) data;
 
-	/* make names string */
-	sprintf (namesBuf, "%s, %s", xrds->firstRD, xrds->secondRD);
-	fprintf (filePtr, "%s\n", namesBuf);
+	fprintf (filePtr, "%s, %s\n", xrds->firstRD, xrds->secondRD);
 
 	if (xrds->nodesNum == 0) {
 
-		sprintf (pointBuf, notFound);
+		sprintf (pointBuf, "%s", (xrds->status == XRDS_FAILED) ? failed : notFound);
 		fprintf (filePtr, "%80s\n", pointBuf);
 		fprintf(filePtr, dashLine);
 		return;
@@ -530,9 +1179,7 @@ void writeXrds (FILE *file, void *data){ // partial - half-assed job
 
 	for (iCount = 0; iCount < xrds->nodesNum; iCount++){
 
-		sprintf (pointBuf, "(%10.7f, %10.7f)",
-				xrds->nodesGPS[iCount]->longitude,
-				xrds->nodesGPS[iCount]->latitude);
+		formatGps (pointBuf, sizeof(pointBuf), xrds->nodesGPS[iCount], &textNodeFormat);
 
 		fprintf (filePtr, "%80s\n", pointBuf);
 	}
@@ -540,9 +1187,8 @@ void writeXrds (FILE *file, void *data){ // partial - half-assed job
 	fprintf (filePtr, "%80s\n", pointBuf);
 
 
-	sprintf(namesBuf, "Mid-Point / Average: {%10.7f, %10.7f}",
-			    xrds->midGps->longitude, xrds->midGps->latitude);
-	fprintf (filePtr, "%80s\n", namesBuf);
+	formatGps (midBuf, sizeof(midBuf), xrds->midGps, &textMidFormat);
+	fprintf (filePtr, "%80s\n", midBuf);
 
 	fprintf(filePtr, dashLine);
 
@@ -569,30 +1215,41 @@ void writeString2FP (FILE *to, void *str){
 	return;
 }
 
+/* formatGpsWKT(): formats gps as WKT point into caller buffer dest of size
+ * bytes, WKT_POINT_SIZE is enough. Returns length written, -1 when dest
+ * is too small.
+ */
+int formatGpsWKT (char *dest, size_t size, GPS *gps){
+
+	ASSERTARGS (dest && gps);
+
+	return formatGps (dest, size, gps, &wktPointFormat);
+}
+
 /* formats GPS as Well Known Text POINT: "POINT ((-111.917714 33.407882))"
- * function allocates memory for buffer, no line feed is used. */
-char *gps2WKT (GPS *gps){
+ * function allocates memory for buffer from arena - malloc() when NULL -
+ * no line feed is used. */
+char *gps2WKT (GPS *gps, ARENA *arena){
 
 	char		*retPtr = NULL;
-	int		bufSize = 36;
+	int		bufSize = WKT_POINT_SIZE;
 
 	ASSERTARGS (gps);
 
-	retPtr = (char *) malloc(sizeof(char) * bufSize);
+	retPtr = (char *) arenaAlloc(arena, sizeof(char) * bufSize);
 	if ( ! retPtr ){
 		printf ("gps2WKT(): Error allocating memory.\n");
 		return retPtr;
 	}
-	memset (retPtr, 0, bufSize);
 
-	sprintf (retPtr, "\"POINT ((%10.7f %10.7f))\"", gps->longitude, gps->latitude);
+	formatGpsWKT (retPtr, bufSize, gps);
 
 	return retPtr;
 
 } // END gps2WKT()
 
-/* return array of strings formated as WKT for given xrds */
-int xrds2WKT (char **dst, XROADS *xrds){
+/* return array of strings formated as WKT for given xrds, strings from arena */
+int xrds2WKT (char **dst, XROADS *xrds, ARENA *arena){
 
 //	char		*emptyP = "\"POINT EMPTY\"";
 	int		iCount;
@@ -601,7 +1258,7 @@ int xrds2WKT (char **dst, XROADS *xrds){
 
 	for (iCount = 0; iCount < xrds->nodesNum; iCount++){
 
-		*dst = gps2WKT (xrds->nodesGPS[iCount]);
+		*dst = gps2WKT (xrds->nodesGPS[iCount], arena);
 		if ( *dst == NULL)
 			return ztMemoryAllocate;
 
@@ -615,6 +1272,8 @@ int xrds2WKT (char **dst, XROADS *xrds){
 /* printXrds(): write XROADS structure to terminal. Not all members are handled */
 void printXrds(XROADS *xrds){
 
+	char		buffer[64];
+
 	ASSERTARGS(xrds);
 
 	printf("printXrds(): cross roads members:\n");
@@ -622,16 +1281,19 @@ void printXrds(XROADS *xrds){
 	printf("\t secondRd: %s\n\n", xrds->secondRD);
 	printf("\t number of nodes found : [ %d ] nodes.\n\n", xrds->nodesNum);
 	printf("\t Longitude and Latitude founds:\n");
-	for (int num = 0; num < xrds->nodesNum; num++)
-		printf("\t %10.7f, %10.7f\n", xrds->nodesGPS[num]->longitude,
-						xrds->nodesGPS[num]->latitude);
+	for (int num = 0; num < xrds->nodesNum; num++){
+		formatGps (buffer, sizeof(buffer), xrds->nodesGPS[num], &printNodeFormat);
+		fputs (buffer, stdout);
+	}
 	printf("\n");
 	printf("\t midGps members [ Longitude and Latitude ]\n");
-	printf("\t [%10.7f, %10.7f]\n", xrds->midGps->longitude, xrds->midGps->latitude);
+	formatGps (buffer, sizeof(buffer), xrds->midGps, &printMidFormat);
+	fputs (buffer, stdout);
 	printf("\n");
 
 	printf("\t GPS in point members [ Longitude and Latitude ]\n");
-	printf("\t [%10.7f, %10.7f]\n", xrds->point->gps.longitude, xrds->point->gps.latitude);
+	formatGps (buffer, sizeof(buffer), &xrds->point->gps, &printMidFormat);
+	fputs (buffer, stdout);
 	printf("\n");
 
 	return;
@@ -663,23 +1325,32 @@ void printXrdsDL (DL_LIST *srcDL){
 	return;
 }
 
-int formatRectWKT (char **dest, RECTANGLE *rect){
+int formatRectWKT (char **dest, RECTANGLE *rect, ARENA *arena){
 
 	char		buffer[LONG_LINE] = {0};
+	char		*ptr;
 	int		sizeNeeded;
+	GPS		*corners[5];
 
 	ASSERTARGS (dest && rect);
 
-	sprintf (buffer, "\"POLYGON ((%11.7f %10.7f, %11.7f %10.7f, %11.7f %10.7f, %11.7f %10.7f, %11.7f %10.7f))\"",
-				     rect->sw.gps.longitude, rect->sw.gps.latitude,
-					 rect->nw.gps.longitude, rect->nw.gps.latitude,
-					 rect->ne.gps.longitude, rect->ne.gps.latitude,
-					 rect->se.gps.longitude, rect->se.gps.latitude,
-					 rect->sw.gps.longitude, rect->sw.gps.latitude);
+	/* closed ring: sw, nw, ne, se then sw again */
+	corners[0] = &rect->sw.gps;
+	corners[1] = &rect->nw.gps;
+	corners[2] = &rect->ne.gps;
+	corners[3] = &rect->se.gps;
+	corners[4] = &rect->sw.gps;
+
+	strcpy (buffer, "\"POLYGON ((");
+	ptr = buffer + strlen (buffer);
+
+	ptr += formatGpsArray (ptr, sizeof(buffer) - (ptr - buffer) - 4, corners, 5, &wktRingFormat);
+
+	strcpy (ptr, "))\"");
 
 	sizeNeeded = strlen(buffer) * sizeof(char) + 1;
 
-	*dest = (char *) malloc (sizeof(char) * sizeNeeded);
+	*dest = (char *) arenaAlloc (arena, sizeof(char) * sizeNeeded);
 	if ( *dest == NULL) {
 		printf("formatRectWKT(): Error allocating memory.\n");
 		return ztMemoryAllocate;
@@ -698,16 +1369,16 @@ int bbox2Rectangle(RECTANGLE *destRect, BBOX *bbox){
 	destRect->sw = bbox->sw;
 	destRect->ne = bbox->ne;
 
-	destRect->nw.gps.longitude = bbox->sw.gps.longitude;
-	destRect->nw.gps.latitude= bbox->ne.gps.latitude;
+	destRect->nw.gps.lonE7 = bbox->sw.gps.lonE7;
+	destRect->nw.gps.latE7 = bbox->ne.gps.latE7;
 
-	destRect->se.gps.longitude = bbox->ne.gps.longitude;
-	destRect->se.gps.latitude = bbox->sw.gps.latitude;
+	destRect->se.gps.lonE7 = bbox->ne.gps.lonE7;
+	destRect->se.gps.latE7 = bbox->sw.gps.latE7;
 
 	return ztSuccess;
 }
 
-int formatBboxWKT (char **dest, BBOX *bbox){
+int formatBboxWKT (char **dest, BBOX *bbox, ARENA *arena){
 
 	RECTANGLE		rect;
 	char		*formatedStr;
@@ -716,7 +1387,7 @@ int formatBboxWKT (char **dest, BBOX *bbox){
 
 	bbox2Rectangle(&rect, bbox);
 
-	formatRectWKT (&formatedStr, &rect);
+	formatRectWKT (&formatedStr, &rect, arena);
 
 	*dest = formatedStr;
 
@@ -0,0 +1,840 @@
+/*
+ * osmFile.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Offline cross roads: loads a local OSM extract - the same file an Overpass
+ * server is built from - and resolves XROADS in process, no server needed.
+ * The file is mapped into memory and read once; we keep every node and the
+ * node lists of highway ways (not 'service') with a name, same ways our
+ * xrdsFillTemplate() query asks for. Ways with the same name are one street.
+ * Cross roads for a pair are nodes shared by the two streets - a sorted set
+ * intersection - in bbox.
+ * Only OSM XML is read; convert PBF first, say with:
+ *    osmium cat region.osm.pbf -o region.osm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "osmFile.h"
+#include "fileio.h"
+#include "coord.h"
+#include "util.h"
+#include "ztError.h"
+
+/* named highway way while loading; its node ids are in loader refs */
+typedef struct OSM_WAY_ {
+
+	char		*name;
+	int		firstRef;
+	int		numRefs;
+
+} OSM_WAY;
+
+/* load state: what we have so far and the way being read */
+typedef struct OSM_LOADER_ {
+
+	OSM_DATA		*osm;
+	int			nodeCapacity;
+	int			nodesSorted;
+	OSM_WAY		*ways;
+	int			numWays;
+	int			wayCapacity;
+	NODE_SET		refs;		// node ids for all kept ways
+	int			inWay;
+	int			wayFirstRef;
+	const char	*highway;	// tag values in file, NOT zero terminated
+	size_t		highwayLen;
+	const char	*name;
+	size_t		nameLen;
+
+} OSM_LOADER;
+
+#define IS_XML_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r')
+
+/* sameView(): true when length characters at view are the string str */
+static int sameView (const char *view, size_t length, const char *str){
+
+	return (length == strlen (str) && memcmp (view, str, length) == 0);
+}
+
+/* nextAttr(): reads next attribute - name="value" or name='value' - from
+ * tag text starting at *ptr up to end, sets name and value views, moves
+ * *ptr past it. Returns 1 when an attribute is read, 0 at end of tag.
+ */
+static int nextAttr (const char **ptr, const char *end,
+		              const char **name, size_t *nameLen,
+		              const char **value, size_t *valueLen){
+
+	const char	*pos = *ptr;
+	char			quote;
+
+	while (pos < end && IS_XML_SPACE(*pos))
+		pos++;
+
+	if (pos >= end || *pos == '/')
+
+		return 0;
+
+	*name = pos;
+	while (pos < end && *pos != '=' && ! IS_XML_SPACE(*pos))
+		pos++;
+	*nameLen = pos - *name;
+
+	while (pos < end && IS_XML_SPACE(*pos))
+		pos++;
+
+	if (pos >= end || *pos++ != '=')
+
+		return 0;
+
+	while (pos < end && IS_XML_SPACE(*pos))
+		pos++;
+
+	if (pos >= end || (*pos != '"' && *pos != '\''))
+
+		return 0;
+
+	quote = *pos++;
+	*value = pos;
+
+	pos = memchr (pos, quote, end - pos);
+	if ( ! pos )
+
+		return 0;
+
+	*valueLen = pos - *value;
+	*ptr = pos + 1;
+
+	return 1;
+}
+
+/* scanId(): reads length characters of decimal - maybe negative - id.
+ * Returns 1 on success, 0 for not a number.
+ */
+static int scanId (int64_t *id, const char *str, size_t length){
+
+	const char	*end = str + length;
+	int			negative = 0;
+	int64_t		value = 0;
+
+	if (str < end && *str == '-'){
+		negative = 1;
+		str++;
+	}
+
+	if (str == end)
+
+		return 0;
+
+	for ( ; str < end; str++){
+
+		if (*str < '0' || *str > '9' || value > (INT64_MAX - 9) / 10)
+
+			return 0;
+
+		value = value * 10 + (*str - '0');
+	}
+
+	*id = negative ? -value : value;
+
+	return 1;
+}
+
+/* decodeXmlText(): copies length characters of attribute value into arena
+ * replacing XML character references. Returns the copy or NULL.
+ */
+static char *decodeXmlText (ARENA *arena, const char *text, size_t length){
+
+	const char	*end = text + length;
+	const char	*semicolon;
+	char			*dest, *ptr;
+	unsigned long	code;
+	char			*endNum;
+
+	/* decoded text is never longer than encoded */
+	dest = (char *) arenaAlloc (arena, length + 1);
+	if ( ! dest )
+
+		return NULL;
+
+	ptr = dest;
+	while (text < end){
+
+		if (*text != '&' ||
+			! (semicolon = memchr (text, ';', end - text))){
+			*ptr++ = *text++;
+			continue;
+		}
+
+		if (sameView (text, semicolon + 1 - text, "&amp;"))
+			*ptr++ = '&';
+		else if (sameView (text, semicolon + 1 - text, "&lt;"))
+			*ptr++ = '<';
+		else if (sameView (text, semicolon + 1 - text, "&gt;"))
+			*ptr++ = '>';
+		else if (sameView (text, semicolon + 1 - text, "&quot;"))
+			*ptr++ = '"';
+		else if (sameView (text, semicolon + 1 - text, "&apos;"))
+			*ptr++ = '\'';
+		else if (text[1] == '#'){
+
+			if (text[2] == 'x' || text[2] == 'X')
+				code = strtoul (text + 3, &endNum, 16);
+			else
+				code = strtoul (text + 2, &endNum, 10);
+
+			if (endNum != semicolon || code == 0 || code > 0x10FFFF){
+				*ptr++ = *text++;
+				continue;
+			}
+
+			/* UTF-8 */
+			if (code < 0x80)
+				*ptr++ = (char) code;
+			else if (code < 0x800){
+				*ptr++ = (char) (0xC0 | (code >> 6));
+				*ptr++ = (char) (0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000){
+				*ptr++ = (char) (0xE0 | (code >> 12));
+				*ptr++ = (char) (0x80 | ((code >> 6) & 0x3F));
+				*ptr++ = (char) (0x80 | (code & 0x3F));
+			}
+			else {
+				*ptr++ = (char) (0xF0 | (code >> 18));
+				*ptr++ = (char) (0x80 | ((code >> 12) & 0x3F));
+				*ptr++ = (char) (0x80 | ((code >> 6) & 0x3F));
+				*ptr++ = (char) (0x80 | (code & 0x3F));
+			}
+		}
+		else {
+			*ptr++ = *text++;
+			continue;
+		}
+
+		text = semicolon + 1;
+	}
+
+	*ptr = '\0';
+
+	return dest;
+}
+
+/* lowerCopy(): returns lower case copy of str from arena, or NULL. */
+static char *lowerCopy (ARENA *arena, const char *str){
+
+	char	*dest, *ptr;
+
+	dest = arenaStrdup (arena, str);
+	if ( ! dest )
+
+		return NULL;
+
+	for (ptr = dest; *ptr; ptr++)
+		*ptr = (char) tolower ((unsigned char) *ptr);
+
+	return dest;
+}
+
+/* loaderNode(): keeps node from tag text [ptr, end).
+ * Nodes without location - deleted ones - are skipped.
+ */
+static int loaderNode (OSM_LOADER *loader, const char *ptr, const char *end){
+
+	OSM_DATA		*osm = loader->osm;
+	OSM_NODE		node;
+	OSM_NODE		*newNodes;
+	const char	*name, *value;
+	size_t		nameLen, valueLen;
+	int			have = 0;
+
+	while (nextAttr (&ptr, end, &name, &nameLen, &value, &valueLen)){
+
+		if (sameView (name, nameLen, "id")){
+			if ( ! scanId (&node.id, value, valueLen) )
+				return ztInvalidToken;
+			have |= 1;
+		}
+		else if (sameView (name, nameLen, "lat")){
+			if (scanCoordE7 (&node.gps.latE7, value, valueLen) != ztSuccess)
+				return ztInvalidToken;
+			have |= 2;
+		}
+		else if (sameView (name, nameLen, "lon")){
+			if (scanCoordE7 (&node.gps.lonE7, value, valueLen) != ztSuccess)
+				return ztInvalidToken;
+			have |= 4;
+		}
+	}
+
+	if (have != 7)
+
+		return ztSuccess;
+
+	if (osm->numNodes == loader->nodeCapacity){
+
+		loader->nodeCapacity = loader->nodeCapacity ? loader->nodeCapacity * 2 : 1024 * 1024;
+
+		newNodes = (OSM_NODE *) realloc (osm->nodes, sizeof(OSM_NODE) * loader->nodeCapacity);
+		if ( ! newNodes )
+
+			return ztMemoryAllocate;
+
+		osm->nodes = newNodes;
+	}
+
+	if (osm->numNodes && osm->nodes[osm->numNodes - 1].id >= node.id)
+		loader->nodesSorted = 0;
+
+	osm->nodes[osm->numNodes++] = node;
+
+	return ztSuccess;
+}
+
+/* loaderEndWay(): keeps way just read when it is a named highway and not
+ * 'service', else drops its node ids.
+ */
+static int loaderEndWay (OSM_LOADER *loader){
+
+	OSM_WAY		*newWays;
+	OSM_WAY		*way;
+	int			numRefs = loader->refs.count - loader->wayFirstRef;
+
+	loader->inWay = 0;
+
+	if ( ! loader->highway || ! loader->name || numRefs == 0 ||
+		sameView (loader->highway, loader->highwayLen, "service") ){
+
+		loader->refs.count = loader->wayFirstRef;
+		return ztSuccess;
+	}
+
+	if (loader->numWays == loader->wayCapacity){
+
+		loader->wayCapacity = loader->wayCapacity ? loader->wayCapacity * 2 : 4096;
+
+		newWays = (OSM_WAY *) realloc (loader->ways, sizeof(OSM_WAY) * loader->wayCapacity);
+		if ( ! newWays )
+
+			return ztMemoryAllocate;
+
+		loader->ways = newWays;
+	}
+
+	way = &loader->ways[loader->numWays];
+
+	way->name = decodeXmlText (&loader->osm->names, loader->name, loader->nameLen);
+	if ( ! way->name )
+
+		return ztMemoryAllocate;
+
+	way->firstRef = loader->wayFirstRef;
+	way->numRefs = numRefs;
+
+	loader->numWays++;
+
+	return ztSuccess;
+}
+
+/* loaderElement(): handles one element tag; text is [ptr, end) after the
+ * element name, end is at '>'. Sets *stop at first relation - relations
+ * come after all nodes and ways in OSM files.
+ */
+static int loaderElement (OSM_LOADER *loader, const char *element, size_t elementLen,
+		                   int closing, int selfClosing,
+		                   const char *ptr, const char *end, int *stop){
+
+	const char	*name, *value, *key = NULL, *keyValue = NULL;
+	size_t		nameLen, valueLen, keyLen = 0, keyValueLen = 0;
+	int64_t		ref;
+	int			result = ztSuccess;
+
+	if (sameView (element, elementLen, "node") && ! closing)
+
+		result = loaderNode (loader, ptr, end);
+
+	else if (sameView (element, elementLen, "way")){
+
+		if (closing)
+
+			return loader->inWay ? loaderEndWay (loader) : ztSuccess;
+
+		loader->inWay = 1;
+		loader->wayFirstRef = loader->refs.count;
+		loader->highway = loader->name = NULL;
+
+		if (selfClosing)
+			result = loaderEndWay (loader);
+	}
+	else if (sameView (element, elementLen, "nd") && loader->inWay){
+
+		while (nextAttr (&ptr, end, &name, &nameLen, &value, &valueLen)){
+
+			if ( ! sameView (name, nameLen, "ref") )
+
+				continue;
+
+			if ( ! scanId (&ref, value, valueLen) )
+
+				return ztInvalidToken;
+
+			result = addNodeSet (&loader->refs, ref);
+		}
+	}
+	else if (sameView (element, elementLen, "tag") && loader->inWay){
+
+		while (nextAttr (&ptr, end, &name, &nameLen, &value, &valueLen)){
+
+			if (sameView (name, nameLen, "k")){
+				key = value;
+				keyLen = valueLen;
+			}
+			else if (sameView (name, nameLen, "v")){
+				keyValue = value;
+				keyValueLen = valueLen;
+			}
+		}
+
+		if (key && keyValue && sameView (key, keyLen, "highway")){
+			loader->highway = keyValue;
+			loader->highwayLen = keyValueLen;
+		}
+		else if (key && keyValue && sameView (key, keyLen, "name")){
+			loader->name = keyValue;
+			loader->nameLen = keyValueLen;
+		}
+	}
+	else if (sameView (element, elementLen, "relation"))
+
+		*stop = 1;
+
+	return result;
+}
+
+static int compareNode (const void *first, const void *second){
+
+	int64_t	a = ((const OSM_NODE *) first)->id;
+	int64_t	b = ((const OSM_NODE *) second)->id;
+
+	return (a > b) - (a < b);
+}
+
+static int compareWay (const void *first, const void *second){
+
+	return strcmp (((const OSM_WAY *) first)->name, ((const OSM_WAY *) second)->name);
+}
+
+/* findNode(): binary search of node table by id.
+ * Returns index or -1 when node is not in file.
+ */
+static int findNode (OSM_DATA *osm, int64_t id){
+
+	int	low = 0, high = osm->numNodes - 1, middle;
+
+	while (low <= high){
+
+		middle = low + (high - low) / 2;
+
+		if (osm->nodes[middle].id < id)
+			low = middle + 1;
+		else if (osm->nodes[middle].id > id)
+			high = middle - 1;
+		else
+			return middle;
+	}
+
+	return -1;
+}
+
+/* buildStreets(): makes streets from ways loaded: way node ids are turned
+ * into node table indexes - ids missing from file are dropped - and ways
+ * with the same name are joined.
+ */
+static int buildStreets (OSM_LOADER *loader){
+
+	OSM_DATA		*osm = loader->osm;
+	OSM_STREET	*street;
+	OSM_WAY		*way;
+	int			iCount, jCount, index;
+
+	if ( ! loader->nodesSorted )
+		qsort (osm->nodes, osm->numNodes, sizeof(OSM_NODE), compareNode);
+
+	for (iCount = 0; iCount < loader->refs.count; iCount++)
+
+		loader->refs.ids[iCount] = findNode (osm, loader->refs.ids[iCount]);
+
+	if (loader->numWays == 0)
+
+		return ztSuccess;
+
+	qsort (loader->ways, loader->numWays, sizeof(OSM_WAY), compareWay);
+
+	osm->streets = (OSM_STREET *) calloc (loader->numWays, sizeof(OSM_STREET));
+	if ( ! osm->streets )
+
+		return ztMemoryAllocate;
+
+	street = NULL;
+	for (iCount = 0; iCount < loader->numWays; iCount++){
+
+		way = &loader->ways[iCount];
+
+		if ( ! street || strcmp (street->name, way->name) != 0){
+
+			street = &osm->streets[osm->numStreets++];
+
+			street->name = way->name;
+			street->lowerName = lowerCopy (&osm->names, way->name);
+			if ( ! street->lowerName || initialNodeSet (&street->nodes, way->numRefs) != ztSuccess )
+
+				return ztMemoryAllocate;
+		}
+
+		for (jCount = 0; jCount < way->numRefs; jCount++){
+
+			index = (int) loader->refs.ids[way->firstRef + jCount];
+			if (index >= 0 && addNodeSet (&street->nodes, index) != ztSuccess)
+
+				return ztMemoryAllocate;
+		}
+	}
+
+	for (iCount = 0; iCount < osm->numStreets; iCount++)
+
+		sortNodeSet (&osm->streets[iCount].nodes);
+
+	return ztSuccess;
+}
+
+/* isOsmXml(): true when first element in [ptr, end) - after declaration
+ * and comments - is <osm>.
+ */
+static int isOsmXml (const char *ptr, const char *end){
+
+	while (ptr && ptr < end){
+
+		while (ptr < end && IS_XML_SPACE(*ptr))
+			ptr++;
+
+		if (end - ptr < 5 || *ptr != '<')
+
+			return 0;
+
+		if (ptr[1] != '?' && ptr[1] != '!')
+
+			return (memcmp (ptr, "<osm", 4) == 0 &&
+					 (IS_XML_SPACE(ptr[4]) || ptr[4] == '>'));
+
+		ptr = memchr (ptr, '>', end - ptr);
+		if (ptr)
+			ptr++;
+	}
+
+	return 0;
+}
+
+/* loadOsmFile(): reads OSM XML file filename into osm; see top of file.
+ * Returns ztSuccess, ztOpenFileError, ztInvalidArg for PBF file,
+ * ztMissFormatFile when file is not OSM XML, ztInvalidToken for bad number,
+ * ztUnexpectedEOF or ztMemoryAllocate.
+ *************************************************************************/
+int loadOsmFile (OSM_DATA *osm, char *filename){
+
+	MAPPED_FILE	mapped;
+	OSM_LOADER	loader;
+	const char	*ptr, *end, *tagEnd, *element;
+	size_t		elementLen;
+	int			closing, selfClosing;
+	int			stop = 0;
+	int			result;
+
+	ASSERTARGS (osm && filename);
+
+	memset (osm, 0, sizeof(OSM_DATA));
+	initialArena (&osm->names, 0);
+
+	if (strlen (filename) > 4 && strcmp (filename + strlen (filename) - 4, ".pbf") == 0){
+		fprintf (stderr, "loadOsmFile(): Error PBF file is not supported: <%s>\n", filename);
+		fprintf (stderr, " Convert it to OSM XML first, say with: osmium cat %s -o region.osm\n",
+				    filename);
+		return ztInvalidArg;
+	}
+
+	result = openMappedFile (&mapped, filename);
+	if (result != ztSuccess)
+
+		return result;
+
+	memset (&loader, 0, sizeof(OSM_LOADER));
+	loader.osm = osm;
+	loader.nodesSorted = 1;
+
+	result = initialNodeSet (&loader.refs, 1024 * 1024);
+	if (result != ztSuccess)
+
+		goto cleanup;
+
+	ptr = mapped.data;
+	end = mapped.data + mapped.size;
+
+	if ( ! isOsmXml (ptr, end) ){
+
+		fprintf (stderr, "loadOsmFile(): Error file is not OSM XML: <%s>\n", filename);
+		result = ztMissFormatFile;
+		goto cleanup;
+	}
+
+	while ( ! stop && (ptr = memchr (ptr, '<', end - ptr)) ){
+
+		tagEnd = memchr (ptr, '>', end - ptr);
+		if ( ! tagEnd ){
+			fprintf (stderr, "loadOsmFile(): Error unexpected end of file: <%s>\n", filename);
+			result = ztUnexpectedEOF;
+			goto cleanup;
+		}
+
+		ptr++;
+
+		if (*ptr == '?' || *ptr == '!'){ // declaration or comment
+			ptr = tagEnd + 1;
+			continue;
+		}
+
+		closing = (*ptr == '/');
+		if (closing)
+			ptr++;
+
+		selfClosing = (tagEnd[-1] == '/');
+
+		element = ptr;
+		while (ptr < tagEnd && *ptr != '/' && ! IS_XML_SPACE(*ptr))
+			ptr++;
+		elementLen = ptr - element;
+
+		result = loaderElement (&loader, element, elementLen, closing, selfClosing,
+				                ptr, tagEnd, &stop);
+		if (result != ztSuccess){
+			fprintf (stderr, "loadOsmFile(): Error reading <%.*s> element at byte %zu: %s\n",
+					    (int) elementLen, element, (size_t) (element - mapped.data),
+					    code2Msg (result));
+			goto cleanup;
+		}
+
+		ptr = tagEnd + 1;
+	}
+
+	result = buildStreets (&loader);
+	if (result != ztSuccess){
+		fprintf (stderr, "loadOsmFile(): Error allocating memory.\n");
+		goto cleanup;
+	}
+
+	printf ("loadOsmFile(): Loaded [ %d ] nodes, [ %d ] named highway ways, "
+			   "[ %d ] street names from: %s\n",
+			   osm->numNodes, loader.numWays, osm->numStreets, filename);
+
+cleanup:
+
+	closeMappedFile (&mapped);
+	zapNodeSet (&loader.refs);
+
+	if (loader.ways)
+		free (loader.ways);
+
+	if (result != ztSuccess)
+		zapOsmData (osm);
+
+	return result;
+}
+
+/* STREET_MATCH: nodes in bbox of all streets matching one query name */
+typedef struct STREET_MATCH_ {
+
+	char		*lowerName;
+	NODE_SET	nodes;
+
+} STREET_MATCH;
+
+/* matchStreet(): returns node set for road name in bbox - from matches when
+ * name was seen before, else made and added there. Name matches streets
+ * case insensitive as sub-string, as 'name'~'road', i does on the server
+ * for plain names. Returns NULL on memory error.
+ */
+static NODE_SET *matchStreet (OSM_DATA *osm, BBOX *bbox, char *road,
+		                       STREET_MATCH *matches, int *numMatches, ARENA *arena){
+
+	char			buffer[LONG_LINE];
+	char			*clean = buffer;
+	char			*lowerName;
+	STREET_MATCH	*match;
+	OSM_STREET	*street;
+	GPS			*gps;
+	int			iCount, jCount;
+
+	/* same white space clean up as xrdsFillTemplate() */
+	snprintf (buffer, sizeof(buffer), "%s", road);
+	removeSpaces (&clean);
+
+	for (lowerName = clean; *lowerName; lowerName++)
+		*lowerName = (char) tolower ((unsigned char) *lowerName);
+
+	for (iCount = 0; iCount < *numMatches; iCount++)
+
+		if (strcmp (matches[iCount].lowerName, clean) == 0)
+
+			return &matches[iCount].nodes;
+
+	match = &matches[*numMatches];
+
+	match->lowerName = arenaStrdup (arena, clean);
+	if ( ! match->lowerName || initialNodeSet (&match->nodes, 0) != ztSuccess )
+
+		return NULL;
+
+	(*numMatches)++;
+
+	for (iCount = 0; iCount < osm->numStreets; iCount++){
+
+		street = &osm->streets[iCount];
+
+		if ( ! strstr (street->lowerName, clean) )
+
+			continue;
+
+		for (jCount = 0; jCount < street->nodes.count; jCount++){
+
+			gps = &osm->nodes[street->nodes.ids[jCount]].gps;
+
+			if (gps->latE7 < bbox->sw.gps.latE7 || gps->latE7 > bbox->ne.gps.latE7 ||
+				gps->lonE7 < bbox->sw.gps.lonE7 || gps->lonE7 > bbox->ne.gps.lonE7)
+
+				continue;
+
+			if (addNodeSet (&match->nodes, street->nodes.ids[jCount]) != ztSuccess)
+
+				return NULL;
+		}
+	}
+
+	sortNodeSet (&match->nodes);
+
+	return &match->nodes;
+}
+
+/* osmGetXrdsDL(): fills GPS members for each XROADS in xrdsDL from osm.
+ * Node set for each road name is made once per call; cross roads are the
+ * nodes in both sets, first MAX_NODES by node id are kept - same nodes and
+ * order the server gives.
+ * done - when not NULL - is called with doneData as each XROADS is filled.
+ *************************************************************************/
+int osmGetXrdsDL (OSM_DATA *osm, DL_LIST *xrdsDL, BBOX *bbox,
+		           XRDS_DONE_FUNC done, void *doneData){
+
+	STREET_MATCH	*matches;
+	int			numMatches = 0;
+	ARENA		arena; // lower case road names
+	NODE_SET		*firstSet, *secondSet;
+	NODE_SET		shared;
+	DL_ELEM		*elem;
+	XROADS		*xrds;
+	int			iCount;
+	int			result;
+
+	ASSERTARGS (osm && xrdsDL && bbox);
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	matches = (STREET_MATCH *) calloc (2 * DL_SIZE(xrdsDL), sizeof(STREET_MATCH));
+	if ( ! matches ){
+		fprintf (stderr, "osmGetXrdsDL(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	initialArena (&arena, 0);
+
+	result = initialNodeSet (&shared, MAX_NODES);
+	if (result != ztSuccess)
+
+		goto cleanup;
+
+	for (elem = DL_HEAD(xrdsDL); elem; elem = DL_NEXT(elem)){
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		firstSet = matchStreet (osm, bbox, xrds->firstRD, matches, &numMatches, &arena);
+		secondSet = firstSet ?
+				      matchStreet (osm, bbox, xrds->secondRD, matches, &numMatches, &arena) : NULL;
+
+		if ( ! secondSet || intersectNodeSets (&shared, firstSet, secondSet) != ztSuccess ){
+			fprintf (stderr, "osmGetXrdsDL(): Error allocating memory.\n");
+			result = ztMemoryAllocate;
+			goto cleanup;
+		}
+
+		xrds->nodesNum = MIN(shared.count, MAX_NODES);
+
+		for (iCount = 0; iCount < xrds->nodesNum; iCount++)
+
+			*(xrds->nodesGPS[iCount]) = osm->nodes[shared.ids[iCount]].gps;
+
+		if (xrds->nodesNum){
+
+			gpsCentroid (xrds->midGps, xrds->nodesGPS, xrds->nodesNum);
+			xrds->point->gps = *(xrds->midGps);
+		}
+
+		xrds->status = XRDS_RESOLVED;
+
+		if (done)
+			done (xrds, doneData);
+	}
+
+	printf ("osmGetXrdsDL(): Resolved [ %d ] cross roads from [ %d ] road names.\n",
+			   DL_SIZE(xrdsDL), numMatches);
+
+cleanup:
+
+	for (iCount = 0; iCount < numMatches; iCount++)
+
+		zapNodeSet (&matches[iCount].nodes);
+
+	free (matches);
+	zapNodeSet (&shared);
+	zapArena (&arena);
+
+	return result;
+}
+
+/* zapOsmData(): frees all memory in osm. */
+void zapOsmData (OSM_DATA *osm){
+
+	int	iCount;
+
+	ASSERTARGS (osm);
+
+	if (osm->nodes)
+		free (osm->nodes);
+
+	if (osm->streets){
+
+		for (iCount = 0; iCount < osm->numStreets; iCount++)
+
+			zapNodeSet (&osm->streets[iCount].nodes);
+
+		free (osm->streets);
+	}
+
+	zapArena (&osm->names);
+
+	memset (osm, 0, sizeof(OSM_DATA));
+
+	return;
+}
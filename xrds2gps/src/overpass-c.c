@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <strings.h>
 
 #include "overpass-c.h"
 #include "util.h"
@@ -20,18 +22,30 @@
  * be written to that file. Declaration is in the overpass.h header file with:
  * and code in in curlGetXrdsGPS() function below. ***/
 
+/* nameFilter(): writes filter for ways named name into dst of size; exact
+ * match for canonical name, else case insensitive regular expression.
+ */
+static void nameFilter (char *dst, size_t size, const char *name, int exact){
+
+	snprintf (dst, size, exact ? "['name'='%s']" : "['name'~'%s', i]", name);
+
+	return;
+}
+
 /* xrdsFillTemplate(): fills query template given firstRD + secondRD && bbox
- * Allocates required memory for the string - this is the query part of URL.
+ * Allocates required memory for the string - this is the query part of URL -
+ * from arena; with NULL arena caller frees returned string. Names with exact
+ * bit set are matched exactly.
  * Returns char* for the query string or NULL on error.
 ************************************************************************ */
 
-char *xrdsFillTemplate (XROADS *xrds, BBOX *bbox){
+char *xrdsFillTemplate (XROADS *xrds, BBOX *bbox, ARENA *arena){
 
 	char			*queryTemplate =
 						"[out:csv(::lat,::lon,::count)]"
 						"[bbox:%10.7f,%10.7f,%10.7f,%10.7f];"
-						"(way['highway'!='service']['name'~'%s', i];>;)->.outNS;"
-						"(way['highway'!='service']['name'~'%s', i];>;)->.outEW;"
+						"(way['highway'!='service']%s;>;)->.outNS;"
+						"(way['highway'!='service']%s;>;)->.outEW;"
 						"node.outNS.outEW;"
 						//"out; out count;&";
 						"out; out count;";   // do not include the '&' at the end
@@ -39,7 +53,9 @@ char *xrdsFillTemplate (XROADS *xrds, BBOX *bbox){
 
 	char			tmpBuf[LONG_LINE * 2] = {0}; // large buffer
 	char			*retValue = NULL;
-	char			*cleanFirstRD, *cleanSecondRD;
+	char			firstBuf[LONG_LINE], secondBuf[LONG_LINE];
+	char			*cleanFirstRD = firstBuf, *cleanSecondRD = secondBuf;
+	char			firstFilter[LONG_LINE + 16], secondFilter[LONG_LINE + 16];
 	int			result;
 
 	ASSERTARGS (xrds && bbox);
@@ -47,13 +63,23 @@ char *xrdsFillTemplate (XROADS *xrds, BBOX *bbox){
 	// the two roads members should be set in the structure
 	ASSERTARGS(xrds->firstRD && xrds->secondRD);
 
-	// remove leading and trailing white space
-	cleanFirstRD = strdup (xrds->firstRD);
-	cleanSecondRD = strdup (xrds->secondRD);
+	/* remove leading and trailing white space - in our own copy; a name
+	 * truncated to fit is a different name, for query and cache key both.
+	 ********************************************************************/
+	if (snprintf (firstBuf, LONG_LINE, "%s", xrds->firstRD) >= LONG_LINE ||
+		snprintf (secondBuf, LONG_LINE, "%s", xrds->secondRD) >= LONG_LINE){
+
+		printf ("xrdsFillTemplate(): Error, road name is longer than "
+				"LONG_LINE buffer.\n");
+		return NULL;
+	}
 
 	removeSpaces (&cleanFirstRD);
 	removeSpaces (&cleanSecondRD);
 
+	nameFilter (firstFilter, sizeof(firstFilter), cleanFirstRD, xrds->exact & XRDS_EXACT_FIRST);
+	nameFilter (secondFilter, sizeof(secondFilter), cleanSecondRD, xrds->exact & XRDS_EXACT_SECOND);
+
 	if ( ! isBbox(bbox)){
 
 		printf("xrdsFillTemplate(): Error isBbox() return FALSE! "
@@ -69,9 +95,9 @@ char *xrdsFillTemplate (XROADS *xrds, BBOX *bbox){
 	 * truncated - partial copy is an error.
 	*******************************************************************/
 	result = (int) snprintf (tmpBuf, (LONG_LINE * 2), queryTemplate,
-					                      bbox->sw.gps.latitude,bbox->sw.gps.longitude,
-										  bbox->ne.gps.latitude, bbox->ne.gps.longitude,
-										  cleanFirstRD, cleanSecondRD);
+					                      E7_TO_DEGREES(bbox->sw.gps.latE7),E7_TO_DEGREES(bbox->sw.gps.lonE7),
+										  E7_TO_DEGREES(bbox->ne.gps.latE7), E7_TO_DEGREES(bbox->ne.gps.lonE7),
+										  firstFilter, secondFilter);
 
 	if (result > (LONG_LINE * 2) ){
 
@@ -81,14 +107,12 @@ char *xrdsFillTemplate (XROADS *xrds, BBOX *bbox){
 		return NULL;
 	}
 
-	retValue = (char *) malloc ((strlen(tmpBuf) + 1) * sizeof(char));
+	retValue = arenaStrdup (arena, tmpBuf);
 	if (retValue == NULL){
 		printf ("xrdsFillTemplate(): Error allocating memory.\n");
 		return retValue;
 	}
 
-	strcpy (retValue, tmpBuf);
-
 	return retValue;
 
 } //END xrdsFillTemplate()
@@ -109,7 +133,8 @@ int isOkResponse (char *response, char *header){
 	memStart = response;
 	chPtr = strchr (memStart, '\n');
 
-	chCount = (int) (chPtr - memStart);
+	/* one line or empty response - an error page may be either */
+	chCount = chPtr ? (int) (chPtr - memStart) : (int) strlen (memStart);
 
 	firstLine = (char *) malloc (sizeof(char) *  chCount + 1);
 	if ( ! firstLine ){
@@ -151,14 +176,14 @@ int isBbox(BBOX *bbox){
 	ASSERTARGS (bbox);
 
 	// maybe a lot of noise!?
-	if (bbox->sw.gps.longitude > bbox->ne.gps.longitude)
+	if (bbox->sw.gps.lonE7 > bbox->ne.gps.lonE7)
 		printf ("isBbox(): invalid member is: LONGITUDE.\n");
 
-	if (bbox->sw.gps.latitude > bbox->ne.gps.latitude)
+	if (bbox->sw.gps.latE7 > bbox->ne.gps.latE7)
 		printf ("isBbox(): invalid member is: LATITUDE.\n");
 
-	if ( (bbox->sw.gps.longitude < bbox->ne.gps.longitude) &&
-		  (bbox->sw.gps.latitude < bbox->ne.gps.latitude) )
+	if ( (bbox->sw.gps.lonE7 < bbox->ne.gps.lonE7) &&
+		  (bbox->sw.gps.latE7 < bbox->ne.gps.latE7) )
 
 		return TRUE;
 
@@ -166,11 +191,15 @@ int isBbox(BBOX *bbox){
 
 }
 
+/* namesFillTemplate(): fills query for names of all ways in bbox the cross
+ * roads query can match, one row for each way under header "name"; see
+ * nameIndex.c. Caller frees dst.
+ */
 int namesFillTemplate(char **dst, BBOX *bbox){
 
-	char		*qryTemplate = "[out:csv('name' ;false)];"
+	char		*qryTemplate = "[out:csv(name)];"
 										  "way(%10.7f ,%10.7f ,%10.7f ,%10.7f)"
-										  "[highway]; out;";
+										  "['highway'!='service'][name]; out;";
 	int		result;
 	char		tmpBuf[LONG_LINE * 2] = {0}; // large buffer
 
@@ -187,8 +216,8 @@ int namesFillTemplate(char **dst, BBOX *bbox){
 	}
 
 	result = snprintf (tmpBuf,  (LONG_LINE * 2), qryTemplate,
-				  	  	  	  	  bbox->sw.gps.latitude,bbox->sw.gps.longitude,
-								  bbox->ne.gps.latitude, bbox->ne.gps.longitude);
+				  	  	  	  	  E7_TO_DEGREES(bbox->sw.gps.latE7),E7_TO_DEGREES(bbox->sw.gps.lonE7),
+								  E7_TO_DEGREES(bbox->ne.gps.latE7), E7_TO_DEGREES(bbox->ne.gps.lonE7));
 
 	if (result > (LONG_LINE * 2) ){
 
@@ -208,6 +237,376 @@ int namesFillTemplate(char **dst, BBOX *bbox){
 	return ztSuccess;
 }
 
+/* appendQuery(): appends formatted string to query buffer in qry, growing
+ * buffer as needed. Used to build variable length queries.
+ ***************************************************************************/
+static int appendQuery (MEMORY_STRUCT *qry, const char *format, ...){
+
+	va_list		args;
+	int			needed;
+
+	ASSERTARGS (qry && format);
+
+	va_start (args, format);
+	needed = vsnprintf (NULL, 0, format, args);
+	va_end (args);
+
+	if (needed < 0)
+
+		return ztParseError;
+
+	if (growMemory (qry, needed) != ztSuccess){
+		printf ("appendQuery(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	va_start (args, format);
+	vsnprintf (qry->memory + qry->size, needed + 1, format, args);
+	va_end (args);
+
+	qry->size += needed;
+
+	return ztSuccess;
+}
+
+/* batchFillTemplate(): fills one query for all XROADS in xrdsDL with bbox.
+ * Named highway ways in bbox are fetched once into a set, each distinct street
+ * name - case insensitive - is filtered from that set once, then for each pair
+ * (in list order) common nodes are output followed by a count line. The count
+ * line closes the rows for its pair; parseBatchXrdsData() depends on this.
+ * Function allocates memory for the query string in dst.
+ * Return: ztSuccess, ztInvalidArg, ztListEmpty or ztMemoryAllocate.
+ ***************************************************************************/
+int batchFillTemplate (char **dst, DL_LIST *xrdsDL, BBOX *bbox){
+
+	char				*headTemplate =
+							"[out:csv(::lat,::lon,::count)]"
+							"[bbox:%10.7f,%10.7f,%10.7f,%10.7f];"
+							"way['highway'!='service']['name']->.all;";
+	char				*streetTemplate = "(way.all%s;>;)->.s%d;";
+	char				*pairTemplate = "node.s%d.s%d;out;out count;";
+
+	MEMORY_STRUCT	qry = {NULL, 0, 0};
+	char				**streets = NULL; // distinct cleaned names
+	int				*pairIndex = NULL; // two street indexes per pair
+	int				*streetExact = NULL; // exact bit per street
+	char				filter[LONG_LINE + 16];
+	int				numStreets = 0;
+	int				numPairs, iCount, jCount, side;
+	DL_ELEM			*elem;
+	XROADS			*xrds;
+	char				*names[2];
+	int				result = ztSuccess;
+
+	ASSERTARGS (dst && xrdsDL && bbox);
+
+	*dst = NULL;
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztListEmpty;
+
+	if ( ! isBbox(bbox) ){
+
+		printf("batchFillTemplate(): Error isBbox() return FALSE! "
+				   "Invalid BOUNDING BOX.\n");
+		return ztInvalidArg;
+	}
+
+	numPairs = DL_SIZE(xrdsDL);
+	streets = (char **) calloc (numPairs * 2, sizeof(char *));
+	pairIndex = (int *) malloc (sizeof(int) * numPairs * 2);
+	streetExact = (int *) malloc (sizeof(int) * numPairs * 2);
+	if ( ! streets || ! pairIndex || ! streetExact ){
+		printf ("batchFillTemplate(): Error allocating memory.\n");
+		result = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	/* collect distinct street names */
+	for (elem = DL_HEAD(xrdsDL), iCount = 0; elem; elem = DL_NEXT(elem), iCount++){
+
+		xrds = (XROADS *) DL_DATA(elem);
+		ASSERTARGS (xrds->firstRD && xrds->secondRD);
+
+		names[0] = xrds->firstRD;
+		names[1] = xrds->secondRD;
+
+		/* names are already white space clean from xrdsParseNames() */
+		for (side = 0; side < 2; side++){
+
+			for (jCount = 0; jCount < numStreets; jCount++)
+
+				if (strcasecmp(streets[jCount], names[side]) == 0)
+
+					break;
+
+			if (jCount == numStreets){
+
+				streetExact[numStreets] = xrds->exact & (side ? XRDS_EXACT_SECOND : XRDS_EXACT_FIRST);
+				streets[numStreets++] = names[side];
+			}
+
+			pairIndex[iCount * 2 + side] = jCount;
+		}
+	}
+
+	result = appendQuery (&qry, headTemplate,
+			                          E7_TO_DEGREES(bbox->sw.gps.latE7), E7_TO_DEGREES(bbox->sw.gps.lonE7),
+			                          E7_TO_DEGREES(bbox->ne.gps.latE7), E7_TO_DEGREES(bbox->ne.gps.lonE7));
+
+	for (jCount = 0; jCount < numStreets && result == ztSuccess; jCount++){
+
+		nameFilter (filter, sizeof(filter), streets[jCount], streetExact[jCount]);
+		result = appendQuery (&qry, streetTemplate, filter, jCount);
+	}
+
+	for (iCount = 0; iCount < numPairs && result == ztSuccess; iCount++)
+
+		result = appendQuery (&qry, pairTemplate,
+				                          pairIndex[iCount * 2], pairIndex[iCount * 2 + 1]);
+
+	if (result != ztSuccess){
+		printf ("batchFillTemplate(): Error returned from appendQuery().\n");
+		goto cleanup;
+	}
+
+	*dst = qry.memory;
+	qry.memory = NULL;
+
+cleanup:
+
+	if (qry.memory)
+		free (qry.memory);
+
+	if (streets)
+		free (streets);
+
+	if (pairIndex)
+		free (pairIndex);
+
+	if (streetExact)
+		free (streetExact);
+
+	return result;
+
+} // END batchFillTemplate()
+
+/* streetsFillTemplate(): fills one query for node ids of numStreets street
+ * names in bbox - same ways xrdsFillTemplate() asks for. For each street,
+ * in order, its node ids are output followed by a count line which closes
+ * the rows for that street. Only ids are sent unless withGps is set, then
+ * rows are "id<TAB>lat<TAB>lon<TAB>". exact - when not NULL - holds exact
+ * flag for each street, see nameFilter(); NULL matches all as regex.
+ * Function allocates memory for the query string in dst.
+ * Return: ztSuccess, ztInvalidArg, ztListEmpty or ztMemoryAllocate.
+ ***************************************************************************/
+int streetsFillTemplate (char **dst, char **streets, int *exact, int numStreets,
+		                   BBOX *bbox, int withGps){
+
+	char				*headTemplate =
+							"[out:csv(::id,%s::count)]"
+							"[bbox:%10.7f,%10.7f,%10.7f,%10.7f];"
+							"way['highway'!='service']['name']->.all;";
+	char				*streetTemplate = "way.all%s;node(w);out%s;out count;";
+
+	MEMORY_STRUCT	qry = {NULL, 0, 0};
+	char				filter[LONG_LINE + 16];
+	int				iCount;
+	int				result;
+
+	ASSERTARGS (dst && streets && bbox);
+
+	*dst = NULL;
+
+	if (numStreets < 1)
+
+		return ztListEmpty;
+
+	if ( ! isBbox(bbox) ){
+
+		printf("streetsFillTemplate(): Error isBbox() return FALSE! "
+				   "Invalid BOUNDING BOX.\n");
+		return ztInvalidArg;
+	}
+
+	result = appendQuery (&qry, headTemplate, withGps ? "::lat,::lon," : "",
+			                          E7_TO_DEGREES(bbox->sw.gps.latE7), E7_TO_DEGREES(bbox->sw.gps.lonE7),
+			                          E7_TO_DEGREES(bbox->ne.gps.latE7), E7_TO_DEGREES(bbox->ne.gps.lonE7));
+
+	for (iCount = 0; iCount < numStreets && result == ztSuccess; iCount++){
+
+		nameFilter (filter, sizeof(filter), streets[iCount], exact ? exact[iCount] : 0);
+		result = appendQuery (&qry, streetTemplate, filter, withGps ? "" : " ids");
+	}
+
+	if (result != ztSuccess){
+		printf ("streetsFillTemplate(): Error returned from appendQuery().\n");
+		if (qry.memory)
+			free (qry.memory);
+		return result;
+	}
+
+	*dst = qry.memory;
+
+	return ztSuccess;
+
+} // END streetsFillTemplate()
+
+/* nodesFillTemplate(): fills one query for coordinates of numIds nodes by
+ * id; answer rows are "id<TAB>lat<TAB>lon" in id order.
+ * Function allocates memory for the query string in dst.
+ * Return: ztSuccess, ztListEmpty or ztMemoryAllocate.
+ ***************************************************************************/
+int nodesFillTemplate (char **dst, int64_t *ids, int numIds){
+
+	MEMORY_STRUCT	qry = {NULL, 0, 0};
+	int				iCount;
+	int				result;
+
+	ASSERTARGS (dst && ids);
+
+	*dst = NULL;
+
+	if (numIds < 1)
+
+		return ztListEmpty;
+
+	result = appendQuery (&qry, "[out:csv(::id,::lat,::lon)];node(id:");
+
+	for (iCount = 0; iCount < numIds && result == ztSuccess; iCount++)
+
+		result = appendQuery (&qry, iCount ? ",%lld" : "%lld", (long long) ids[iCount]);
+
+	if (result == ztSuccess)
+		result = appendQuery (&qry, ");out;");
+
+	if (result != ztSuccess){
+		printf ("nodesFillTemplate(): Error returned from appendQuery().\n");
+		if (qry.memory)
+			free (qry.memory);
+		return result;
+	}
+
+	*dst = qry.memory;
+
+	return ztSuccess;
+
+} // END nodesFillTemplate()
+
+/* crossingsFillTemplate(): fills one query for all crossings of numStreets
+ * street names in bbox: every node a street shares with another named
+ * highway - same ways xrdsFillTemplate() asks for. For each street, in
+ * order, each crossing way is output as a row "way<TAB>id<TAB>name" followed
+ * by rows "node<TAB>id<TAB><TAB>lat<TAB>lon" for the shared nodes, then a
+ * count row closes the rows for that street.
+ * Function allocates memory for the query string in dst.
+ * Return: ztSuccess, ztInvalidArg, ztListEmpty or ztMemoryAllocate.
+ ***************************************************************************/
+int crossingsFillTemplate (char **dst, char **streets, int numStreets, BBOX *bbox){
+
+	char				*headTemplate =
+							"[out:csv(::type,::id,name,::lat,::lon,::count)]"
+							"[bbox:%10.7f,%10.7f,%10.7f,%10.7f];"
+							"way['highway'!='service']['name']->.all;";
+	char				*streetTemplate =
+							"way.all%s->.m;node(w.m)->.mn;"
+							"(way.all(bn.mn); - way.m;)->.o;"
+							"foreach.o->.w(.w out;node.mn(w.w);out;);"
+							".m out count;";
+
+	MEMORY_STRUCT	qry = {NULL, 0, 0};
+	char				filter[LONG_LINE + 16];
+	int				iCount;
+	int				result;
+
+	ASSERTARGS (dst && streets && bbox);
+
+	*dst = NULL;
+
+	if (numStreets < 1)
+
+		return ztListEmpty;
+
+	if ( ! isBbox(bbox) ){
+
+		printf("crossingsFillTemplate(): Error isBbox() return FALSE! "
+				   "Invalid BOUNDING BOX.\n");
+		return ztInvalidArg;
+	}
+
+	result = appendQuery (&qry, headTemplate,
+			                          E7_TO_DEGREES(bbox->sw.gps.latE7), E7_TO_DEGREES(bbox->sw.gps.lonE7),
+			                          E7_TO_DEGREES(bbox->ne.gps.latE7), E7_TO_DEGREES(bbox->ne.gps.lonE7));
+
+	for (iCount = 0; iCount < numStreets && result == ztSuccess; iCount++){
+
+		nameFilter (filter, sizeof(filter), streets[iCount], 0);
+		result = appendQuery (&qry, streetTemplate, filter);
+	}
+
+	if (result != ztSuccess){
+		printf ("crossingsFillTemplate(): Error returned from appendQuery().\n");
+		if (qry.memory)
+			free (qry.memory);
+		return result;
+	}
+
+	*dst = qry.memory;
+
+	return ztSuccess;
+
+} // END crossingsFillTemplate()
+
+/* getBatchXrdsGps(): one query for all XROADS in xrdsDL, fills their GPS
+ * members from the single response. See batchFillTemplate().
+ ***************************************************************************/
+int getBatchXrdsGps (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL, CURL *curlHandle){
+
+	MEMORY_STRUCT		*myDataStruct;
+	char		*query;
+	int		result;
+	char		*hdrSignature = "@lat	@lon	@count"; // no "\n" included
+
+	ASSERTARGS (xrdsDL && bbox && srvrURL && curlHandle);
+
+	myDataStruct = queryMemory (curlHandle);
+
+	result = batchFillTemplate (&query, xrdsDL, bbox);
+	if (result != ztSuccess){
+
+		printf("getBatchXrdsGps(): Error returned from batchFillTemplate().\n");
+		return result;
+	}
+
+	result = performQuery (myDataStruct, query, hdrSignature, srvrURL, curlHandle);
+	free (query);
+	if (result != ztSuccess){
+
+		fprintf (stderr, "getBatchXrdsGps(): Error returned from performQuery().\n");
+		return result;
+	}
+
+	if (rawDataFP) {
+
+		fprintf(rawDataFP, "Data for batch of [ %d ] cross roads:\n\n",
+				DL_SIZE(xrdsDL));
+
+		fprintf(rawDataFP, "%s", MEMORY_BYTES(myDataStruct));
+		fprintf(rawDataFP,
+				"\n ++++++++++++++++++++++++++++++++++++++++++++++++\n\n");
+		fflush(rawDataFP);
+	}
+
+	result = parseBatchXrdsData (xrdsDL, myDataStruct);
+
+	if (result != ztSuccess)
+		fprintf(stderr, "getBatchXrdsGps(): Error parsing batch response!\n"
+				" The error was: %s\n\n", code2Msg(result));
+
+	return result;
+}
+
 /* cpyXrds(): copies src XROADS structure to dest. client allocates dest.
  *********************************************************************/
 int cpyXrds (XROADS *dest, XROADS *src){
@@ -226,6 +625,7 @@ int cpyXrds (XROADS *dest, XROADS *src){
 	memcpy (dest->point, src->point, sizeof(POINT));
 
 	dest->nodesNum = src->nodesNum;
+	dest->exact = src->exact;
 
 	for (num = 0; num < src->nodesNum; num++)
 
@@ -313,26 +713,155 @@ void zapXrds (void **xrds){
 
 }
 
+/* initialXrdsBatch(): allocates batch with room for capacity XROADS and
+ * namesSize bytes of road names - including terminating zeros.
+ * Returns pointer to new batch or NULL on allocation error.
+ ************************************************************************/
+XRDS_BATCH * initialXrdsBatch (int capacity, size_t namesSize){
+
+	XRDS_BATCH	*batch;
+
+	ASSERTARGS (capacity > 0);
+
+	batch = (XRDS_BATCH *) calloc (1, sizeof(XRDS_BATCH));
+	if ( ! batch ){
+		fprintf(stderr, "initialXrdsBatch(): Error allocating memory.\n");
+		return NULL;
+	}
+
+	batch->xrds = (XROADS *) calloc (capacity, sizeof(XROADS));
+	batch->points = (POINT *) calloc (capacity, sizeof(POINT));
+	batch->nodes = (GPS *) calloc ((size_t) capacity * MAX_NODES, sizeof(GPS));
+	batch->midGps = (GPS *) calloc (capacity, sizeof(GPS));
+	batch->names = (char *) malloc (namesSize ? namesSize : 1);
+
+	if ( ! batch->xrds || ! batch->points || ! batch->nodes ||
+		 ! batch->midGps || ! batch->names ){
+		fprintf(stderr, "initialXrdsBatch(): Error allocating memory.\n");
+		zapXrdsBatch ((void **) &batch);
+		return NULL;
+	}
+
+	batch->namesSize = namesSize;
+	batch->capacity = capacity;
+
+	return batch;
+}
+
+/* batchName(): copies name into batch names arena, returns the copy */
+static char * batchName (XRDS_BATCH *batch, char *name){
+
+	char		*copy;
+	size_t	length = strlen (name) + 1;
+
+	if (batch->namesUsed + length > batch->namesSize)
+
+		return NULL;
+
+	copy = batch->names + batch->namesUsed;
+	memcpy (copy, name, length);
+	batch->namesUsed += length;
+
+	return copy;
+}
+
+/* batchNewXrds(): takes next XROADS from batch and wires its members to the
+ * batch arrays, copies firstRd and secondRd into the names arena.
+ * Returns pointer to the XROADS or NULL when batch is full.
+ ************************************************************************/
+XROADS * batchNewXrds (XRDS_BATCH *batch, char *firstRd, char *secondRd){
+
+	XROADS	*newXrd;
+	int		index;
+	int		num;
+
+	ASSERTARGS (batch && firstRd && secondRd);
+
+	if (batch->count == batch->capacity){
+		fprintf(stderr, "batchNewXrds(): Error batch is full.\n");
+		return NULL;
+	}
+
+	index = batch->count;
+	newXrd = &batch->xrds[index];
+
+	newXrd->firstRD = batchName (batch, firstRd);
+	newXrd->secondRD = batchName (batch, secondRd);
+	if ( ! newXrd->firstRD || ! newXrd->secondRD ){
+		fprintf(stderr, "batchNewXrds(): Error names arena is full.\n");
+		return NULL;
+	}
+
+	newXrd->point = &batch->points[index];
+
+	for (num = 0; num < MAX_NODES; num++)
+
+		newXrd->nodesGPS[num] = &batch->nodes[index * MAX_NODES + num];
+
+	newXrd->midGps = &batch->midGps[index];
+
+	batch->count++;
+
+	return newXrd;
+}
+
+/* zapXrdsBatch(): frees batch and every XROADS in it, matches destroyDL() */
+void zapXrdsBatch (void **batch){
+
+	XRDS_BATCH	*pBatch;
+
+	ASSERTARGS (batch);
+
+	pBatch = (XRDS_BATCH *) *batch;
+	if ( ! pBatch )
+
+		return;
+
+	if (pBatch->xrds)
+		free (pBatch->xrds);
+
+	if (pBatch->points)
+		free (pBatch->points);
+
+	if (pBatch->nodes)
+		free (pBatch->nodes);
+
+	if (pBatch->midGps)
+		free (pBatch->midGps);
+
+	if (pBatch->names)
+		free (pBatch->names);
+
+	free (pBatch);
+	*batch = NULL;
+
+	return;
+}
+
 int getXrdsGps (XROADS *xrds, BBOX *bbox, CURLU *srvrURL, CURL *curlHandle){
 
-	MEMORY_STRUCT		myDataStruct;
+	XRDS_PARSER	parser;
 	char		*query;
 	int		result;
-	char		*hdrSignature = "@lat	@lon	@count"; // no "\n" included
 
 	ASSERTARGS (xrds && bbox && srvrURL && curlHandle);
 
-	query = xrdsFillTemplate (xrds, bbox);
+	query = xrdsFillTemplate (xrds, bbox, NULL);
 	if (query == NULL){
 
 		printf("getXrdsGps(): Error returned from xrdsFillTemplate().\n");
 		return ztMemoryAllocate;
 	}
 
-	result = performQuery (&myDataStruct, query, srvrURL, curlHandle);
+	/* response is parsed as it arrives; no copy is kept unless raw data
+	 * file is set by client. */
+	initialXrdsParser (&parser, xrds, rawDataFP ? queryMemory (curlHandle) : NULL);
+
+	result = performQueryWrite (query, srvrURL, curlHandle, xrdsParserWrite, &parser);
+	free (query);
 	if (result != ztSuccess){
 
-		fprintf (stderr, "getXrdsGps(): Error returned from performQuery().\n");
+		fprintf (stderr, "getXrdsGps(): Error returned from performQueryWrite().\n");
 		return result;
 
 	}
@@ -343,48 +872,39 @@ int getXrdsGps (XROADS *xrds, BBOX *bbox, CURLU *srvrURL, CURL *curlHandle){
 	 ******************************************************************************/
 
 	/* write received data to client opened file if rawDataFP is set */
-	if (rawDataFP) {
-
-		fprintf(rawDataFP, "Data for cross roads: [ %s && %s ]\n\n",
-				xrds->firstRD, xrds->secondRD);
-
-		fprintf(rawDataFP, "%s", myDataStruct.memory);
-		fprintf(rawDataFP,
-				"\n ++++++++++++++++++++++++++++++++++++++++++++++++\n\n");
-		fflush(rawDataFP);
-
-	}
+	if (parser.raw)
+		xrdsWriteRawData (xrds, parser.raw);
 
-	/* the above function call and a successful result test ONLY tell us that
-	 * we received some response from the server. Is it what we want? Or
-	 * is it an error message - bad query, busy or down server, maybe we
-	 * got band by the server or ...? For Overpass server we get an HTML
-	 * page in case of an error, where in a successful response the first line
-	 * will be the HEADER we requested in our query by the following line from
-	 * our query template:
-	 * "[out:csv(::lat,::lon,::count)]"
-	 * The above line use the default of "true or yes" for the header, to
-	 * turn off header listing you have to change the above line to:
-	 * "[out:csv(::lat,::lon,::count ; false)]"
-	 *
-	 * So with this out of the way, we examine the first line and compare
-	 * it to the expected header before we proceed, an okay response is
-	 * one that has a header which matches our expected header.
-	 ************************************************************************/
-
-	result = isOkResponse(myDataStruct.memory, hdrSignature);
+	result = finishXrdsParser (&parser);
 	if (result != ztSuccess) {
-		fprintf(stderr, "getXrdsGPS(): Error returned from isOkResponse()!\n"
-				" The error was: %s\n\n", code2Msg(result));
-		return result;
-	}
-
-	result = parseCurlXrdsData(xrds, &myDataStruct);
-	if (result != ztSuccess) {
-		printf("getXrdsGps(): Error returned from parseCurlXrdsData()!\n"
+		printf("getXrdsGps(): Error returned from finishXrdsParser()!\n"
 				" The error was: %s\n\n", code2Msg(result));
 		return result;
 	}
 
 	return ztSuccess;
 }
+
+/* xrdsWriteRawData(): writes received data in answer for xrds to client
+ * opened rawDataFP file, does nothing when rawDataFP is not set.
+ * Split out of getXrdsGps() so batch callers can write raw data in input
+ * order regardless of the order responses arrive in.
+ *************************************************************************/
+void xrdsWriteRawData (XROADS *xrds, MEMORY_STRUCT *answer){
+
+	ASSERTARGS (xrds && answer);
+
+	if ( ! rawDataFP )
+
+		return;
+
+	fprintf(rawDataFP, "Data for cross roads: [ %s && %s ]\n\n",
+			xrds->firstRD, xrds->secondRD);
+
+	fprintf(rawDataFP, "%s", answer->memory);
+	fprintf(rawDataFP,
+			"\n ++++++++++++++++++++++++++++++++++++++++++++++++\n\n");
+	fflush(rawDataFP);
+
+	return;
+}
@@ -0,0 +1,355 @@
+/*
+ * resolve.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Functions to fill GPS members for a list of XROADS: one query per XROADS
+ * (serial or concurrent), one query for the whole list (batch), and
+ * resolveXrdsDL() which puts memo and cache in front of them - or of the
+ * street node ids engine in streetQuery.c or local OSM file engine in
+ * osmFile.c - and the street name dictionary from nameIndex.c in front of
+ * all.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <curl/curl.h>
+
+#include "resolve.h"
+#include "overpass-c.h"
+#include "curl_func.h"
+#include "multiQuery.h"
+#include "execQuery.h"
+#include "cache.h"
+#include "util.h"
+#include "ztError.h"
+
+/* curlGetXrdsDL(): fills GPS members for each XROADS in xrdsDL, one query
+ * per XROADS, by multiGetXrdsDL() - one job in schedule is serial. Failed
+ * queries are tried again, XROADS still failing are set XRDS_FAILED.
+ * done - when not NULL - is called with doneData as each XROADS is filled.
+ */
+int curlGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL,
+		            QUERY_SCHEDULE *schedule, XRDS_DONE_FUNC done, void *doneData){
+
+	//do not allow nulls
+	ASSERTARGS(xrdsDL && bbox && srvrURL && schedule);
+
+	if(DL_SIZE(xrdsDL) == 0) // not even a warning
+
+		return ztSuccess;
+
+	return multiGetXrdsDL (xrdsDL, bbox, srvrURL, schedule, done, doneData);
+
+} // END curlGetXrdsDL()
+
+/* batchGetXrdsDL(): fills GPS members for all XROADS in xrdsDL with one
+ * query to the server; see batchFillTemplate() in overpass-c.c
+ * done is called for each XROADS once the whole answer is parsed.
+ */
+int batchGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL,
+		             XRDS_DONE_FUNC done, void *doneData){
+
+	DL_ELEM	*elem;
+	int		result;
+
+	ASSERTARGS(xrdsDL && bbox && srvrURL);
+
+	if(DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	CURL	*myCurlHandle =  initialQuery (srvrURL);
+	if ( ! myCurlHandle){
+		fprintf(stderr, "batchGetXrdsDL(): Error returned from initialQuery().\n");
+		return ztGotNull;
+	}
+
+	result = getBatchXrdsGps (xrdsDL, bbox, srvrURL, myCurlHandle);
+	if (result != ztSuccess)
+		fprintf(stderr, "batchGetXrdsDL(): Error returned from getBatchXrdsGps() function\n\n");
+
+	else if (done)
+
+		for (elem = DL_HEAD(xrdsDL); elem; elem = DL_NEXT(elem))
+
+			done ((XROADS *) DL_DATA(elem), doneData);
+
+	closeQuery (myCurlHandle);
+
+	return result;
+
+} // END batchGetXrdsDL()
+
+/* resolveXrdsDL(): fills GPS members for all XROADS in xrdsDL as set in
+ * options. With names dictionary, XROADS with a street name not in bbox are
+ * resolved as not found without query, others get canonical names; when
+ * names can not be fetched the dictionary is dropped - options names is set
+ * to NULL - and the run goes on without it. XROADS
+ * resolved before in this run - same bbox and same pair in any order and
+ * case - are filled from the memo, a pair listed again while its query is
+ * pending is queried once and copied. With cache, XROADS found there are
+ * filled from it. Only the rest go to the server - or to local OSM file
+ * when options osm is set, srvrURL is not used then; new results are stored
+ * in both. Failed queries are not stored; the memo marks them failed so a
+ * pair listed again in a later list is queried again. When a query engine
+ * fails as a whole, XROADS it did not fill are set XRDS_FAILED; only memory
+ * error is returned.
+ */
+int resolveXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL, RESOLVE_OPTIONS *options){
+
+	DL_LIST		missDL; // XROADS to query, data pointers NOT owned
+	DL_LIST		dupDL;  // XROADS waiting on a query in missDL, NOT owned
+	DL_ELEM		*elem;
+	XROADS		*xrds;
+	CACHE_ENTRY	*entry;
+	char			*query;
+	uint64_t		*keys = NULL;      // cache keys, missDL order
+	uint64_t		*memoKeys = NULL;  // memo keys, missDL order
+	uint64_t		*dupKeys = NULL;   // memo keys, dupDL order
+	uint64_t		memoKey = 0;
+	ARENA		keyArena; // query strings for cache keys
+	int			numMiss = 0;
+	int			numMemo = 0;
+	int			numCache = 0;
+	int			numUnknown = 0;
+	int			numFailed = 0;
+	int			result = ztSuccess;
+
+	ASSERTARGS (xrdsDL && bbox && options && (srvrURL || options->osm || options->execPath));
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	if (options->names){
+
+		/* dictionary is only a short cut; go on without it */
+		result = loadNameIndex (options->names, bbox, srvrURL);
+		if (result != ztSuccess){
+			fprintf(stderr, "resolveXrdsDL(): Warning loadNameIndex() failed; street "
+					   "names are not checked for rest of run.\n");
+			zapNameIndex (options->names);
+			options->names = NULL;
+			result = ztSuccess;
+		}
+	}
+
+	initialDL (&missDL, NULL, NULL);
+	initialDL (&dupDL, NULL, NULL);
+	initialArena (&keyArena, 0);
+
+	keys = (uint64_t *) malloc (sizeof(uint64_t) * DL_SIZE(xrdsDL));
+	memoKeys = (uint64_t *) malloc (sizeof(uint64_t) * DL_SIZE(xrdsDL));
+	dupKeys = (uint64_t *) malloc (sizeof(uint64_t) * DL_SIZE(xrdsDL));
+	if ( ! keys || ! memoKeys || ! dupKeys ){
+		fprintf(stderr, "resolveXrdsDL(): Error allocating memory.\n");
+		result = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	for (elem = DL_HEAD(xrdsDL); elem; elem = DL_NEXT(elem)){
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		/* key on names as listed - before dictionary changes them - so
+		 * cache is good with or without dictionary */
+		if (options->cache){
+
+			query = xrdsFillTemplate (xrds, bbox, &keyArena);
+			if ( ! query ){
+				fprintf(stderr, "resolveXrdsDL(): Error returned from xrdsFillTemplate().\n");
+				result = ztInvalidArg;
+				goto cleanup;
+			}
+
+			keys[numMiss] = queryKey (query);
+			resetArena (&keyArena);
+		}
+
+		/* query can only give zero nodes */
+		if (options->names && ! checkXrdsNames (options->names, xrds)){
+			xrds->nodesNum = 0;
+			xrds->status = XRDS_RESOLVED;
+			numUnknown++;
+			if (options->done)
+				options->done (xrds, options->doneData);
+			continue;
+		}
+
+		if (options->memo){
+
+			memoKey = pairKey (xrds, bbox);
+
+			entry = cacheLookup (options->memo, memoKey);
+			if (entry && entry->stamp == CACHE_FAILED)
+				entry = NULL;
+
+			if (entry && entry->stamp == CACHE_PENDING){
+				dupKeys[DL_SIZE(&dupDL)] = memoKey;
+				insertNextDL (&dupDL, DL_TAIL(&dupDL), xrds);
+				numMemo++;
+				continue;
+			}
+			else if (entry){
+				cache2Xrds (xrds, entry);
+				numMemo++;
+				if (options->done)
+					options->done (xrds, options->doneData);
+				continue;
+			}
+		}
+
+		if (options->cache){
+
+			entry = options->refresh ? NULL : cacheLookup (options->cache, keys[numMiss]);
+			if (entry){
+				cache2Xrds (xrds, entry);
+				numCache++;
+				if (options->done)
+					options->done (xrds, options->doneData);
+				if (options->memo && cacheStore (options->memo, memoKey, xrds) != ztSuccess){
+					result = ztMemoryAllocate;
+					goto cleanup;
+				}
+				continue;
+			}
+		}
+
+		if (options->memo && cachePending (options->memo, memoKey) != ztSuccess){
+			result = ztMemoryAllocate;
+			goto cleanup;
+		}
+
+		memoKeys[numMiss] = memoKey;
+		insertNextDL (&missDL, DL_TAIL(&missDL), xrds);
+		numMiss++;
+	}
+
+	if (options->names)
+		printf ("resolveXrdsDL(): [ %d ] of [ %d ] cross roads have unknown street names.\n",
+				    numUnknown, DL_SIZE(xrdsDL));
+
+	if (options->memo)
+		printf ("resolveXrdsDL(): [ %d ] of [ %d ] cross roads are repeats.\n",
+				    numMemo, DL_SIZE(xrdsDL));
+
+	if (options->cache)
+		printf ("resolveXrdsDL(): [ %d ] of [ %d ] cross roads found in cache.\n",
+				    numCache, DL_SIZE(xrdsDL));
+
+	if (numMiss == 0)
+
+		goto cleanup;
+
+	if (options->osm)
+		result = osmGetXrdsDL (options->osm, &missDL, bbox, options->done, options->doneData);
+	else if (options->execPath)
+		result = execGetXrdsDL (&missDL, bbox, options->execPath, &options->schedule,
+				                  options->done, options->doneData);
+	else if (options->gridMode)
+		result = gridGetXrdsDL (&missDL, bbox, srvrURL, options->done, options->doneData);
+	else if (options->streets)
+		result = streetGetXrdsDL (&missDL, bbox, srvrURL, options->streets,
+				                   options->done, options->doneData);
+	else if (options->batchMode)
+		result = batchGetXrdsDL (&missDL, bbox, srvrURL, options->done, options->doneData);
+	else
+		result = curlGetXrdsDL (&missDL, bbox, srvrURL, &options->schedule,
+				                  options->done, options->doneData);
+
+	/* failed engine fails its XROADS not done yet, run goes on */
+	if (result != ztSuccess && result != ztMemoryAllocate){
+
+		fprintf(stderr, "resolveXrdsDL(): Warning query failed: %s; cross roads "
+				   "not done are set failed.\n", code2Msg (result));
+
+		for (elem = DL_HEAD(&missDL); elem; elem = DL_NEXT(elem)){
+
+			xrds = (XROADS *) DL_DATA(elem);
+			if (xrds->status != XRDS_PENDING)
+
+				continue;
+
+			xrds->nodesNum = 0;
+			xrds->status = XRDS_FAILED;
+			if (options->done)
+				options->done (xrds, options->doneData);
+		}
+
+		result = ztSuccess;
+	}
+
+	if (result != ztSuccess)
+
+		goto cleanup;
+
+	numMiss = 0;
+	for (elem = DL_HEAD(&missDL); elem; elem = DL_NEXT(elem), numMiss++){
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		if (xrds->status == XRDS_FAILED){
+
+			numFailed++;
+			if (options->memo)
+				result = cacheFailed (options->memo, memoKeys[numMiss]);
+		}
+		else {
+
+			if (options->cache)
+				result = cacheStore (options->cache, keys[numMiss], xrds);
+
+			if (result == ztSuccess && options->memo)
+				result = cacheStore (options->memo, memoKeys[numMiss], xrds);
+		}
+
+		if (result != ztSuccess){
+			fprintf(stderr, "resolveXrdsDL(): Error returned from cacheStore().\n");
+			goto cleanup;
+		}
+	}
+
+	/* repeats in this list get their copy now */
+	numMemo = 0;
+	for (elem = DL_HEAD(&dupDL); elem; elem = DL_NEXT(elem)){
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		entry = cacheLookup (options->memo, dupKeys[numMemo++]);
+		if (entry->stamp == CACHE_FAILED){
+			xrds->nodesNum = 0;
+			xrds->status = XRDS_FAILED;
+			numFailed++;
+		}
+		else
+			cache2Xrds (xrds, entry);
+
+		if (options->done)
+			options->done (xrds, options->doneData);
+	}
+
+	if (numFailed)
+		printf ("resolveXrdsDL(): [ %d ] of [ %d ] cross roads failed; not stored.\n",
+				    numFailed, DL_SIZE(xrdsDL));
+
+cleanup:
+
+	destroyDL (&missDL);
+	destroyDL (&dupDL);
+	zapArena (&keyArena);
+
+	if (keys)
+		free (keys);
+
+	if (memoKeys)
+		free (memoKeys);
+
+	if (dupKeys)
+		free (dupKeys);
+
+	return result;
+
+} // END resolveXrdsDL()
@@ -0,0 +1,479 @@
+/*
+ * sink.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Output sinks: terminal, text output file, WKT, mid-point WKT and bounding
+ * box WKT files. Each resolved XROADS is pushed once through every enabled
+ * sink as soon as all XROADS before it in the input are resolved; nothing is
+ * kept in lists until the end of the run. Files are block buffered.
+ * Output file may also be written as CSV, NDJSON or packed binary records
+ * for loading by other programs; see sink.h for binary layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "sink.h"
+#include "op_string.h"
+#include "coord.h"
+#include "util.h"
+#include "ztError.h"
+
+/* initialSinks(): sets sinks to empty */
+void initialSinks (OUTPUT_SINKS *sinks){
+
+	ASSERTARGS (sinks);
+
+	memset (sinks, 0, sizeof(OUTPUT_SINKS));
+
+	return;
+}
+
+/* coordinate layouts for formatGps(), see coord.h */
+static const COORD_FORMAT wktLineFormat = {"\"POINT ((", 10, " ", 10, "))\"\n", ""};
+static const COORD_FORMAT csvMidFormat = {"", 0, ",", 0, ",\"", ""};
+static const COORD_FORMAT csvNodeFormat = {"", 0, " ", 0, "", ";"};
+static const COORD_FORMAT jsonNodeFormat = {"[", 0, ",", 0, "]", ","};
+static const COORD_FORMAT jsonMidFormat = {"],\"mid\":[", 0, ",", 0, "]}\n", ""};
+
+/* longest text formatGpsArray() makes for nodes of one XROADS */
+#define NODES_TEXT_SIZE (MAX_NODES * (WKT_POINT_SIZE + 1))
+
+/* sinkKind(): returns SINK_KIND for format name given with --format option,
+ * zero for unknown name.
+ */
+SINK_KIND sinkKind (const char *name){
+
+	ASSERTARGS (name);
+
+	if (strcasecmp (name, "text") == 0)
+		return SINK_TEXT;
+
+	if (strcasecmp (name, "csv") == 0)
+		return SINK_CSV;
+
+	if (strcasecmp (name, "ndjson") == 0)
+		return SINK_NDJSON;
+
+	if (strcasecmp (name, "binary") == 0)
+		return SINK_BINARY;
+
+	return 0;
+}
+
+/* putLE32(): stores value at dest as 4 bytes little endian */
+static void putLE32 (unsigned char *dest, uint32_t value){
+
+	dest[0] = value & 0xFF;
+	dest[1] = (value >> 8) & 0xFF;
+	dest[2] = (value >> 16) & 0xFF;
+	dest[3] = (value >> 24) & 0xFF;
+
+	return;
+}
+
+/* writeBinHeader(): writes binary header with count and namesOffset */
+static void writeBinHeader (FILE *filePtr, uint32_t count, uint64_t namesOffset){
+
+	unsigned char	header[BIN_HEADER_SIZE] = {0};
+
+	memcpy (header, BIN_MAGIC, 8);
+	putLE32 (header + 8, BIN_RECORD_SIZE);
+	putLE32 (header + 12, MAX_NODES);
+	putLE32 (header + 16, count);
+	putLE32 (header + 24, (uint32_t) (namesOffset & 0xFFFFFFFF));
+	putLE32 (header + 28, (uint32_t) (namesOffset >> 32));
+
+	fwrite (header, 1, BIN_HEADER_SIZE, filePtr);
+
+	return;
+}
+
+/* writeBinRecord(): writes one binary record for xrds, names go to sink
+ * names section.
+ */
+static void writeBinRecord (XRDS_SINK *sink, XROADS *xrds){
+
+	unsigned char	record[BIN_RECORD_SIZE] = {0};
+	unsigned char	*ptr;
+	int				iCount;
+	int				result;
+
+	putLE32 (record, (uint32_t) sink->names.size);
+	result = appendMemory (&sink->names, xrds->firstRD, strlen (xrds->firstRD) + 1);
+
+	putLE32 (record + 4, (uint32_t) sink->names.size);
+	if (result == ztSuccess)
+		result = appendMemory (&sink->names, xrds->secondRD, strlen (xrds->secondRD) + 1);
+
+	if (result != ztSuccess){
+		fprintf(stderr, "writeBinRecord(): Error returned from appendMemory().\n");
+		sink->error = result;
+		return;
+	}
+
+	putLE32 (record + 8, (uint32_t) xrds->nodesNum);
+	putLE32 (record + 12, (uint32_t) xrds->status);
+
+	if (xrds->nodesNum){
+		putLE32 (record + 16, (uint32_t) xrds->midGps->lonE7);
+		putLE32 (record + 20, (uint32_t) xrds->midGps->latE7);
+	}
+
+	ptr = record + 24;
+	for (iCount = 0; iCount < xrds->nodesNum; iCount++, ptr += 8){
+
+		putLE32 (ptr, (uint32_t) xrds->nodesGPS[iCount]->lonE7);
+		putLE32 (ptr + 4, (uint32_t) xrds->nodesGPS[iCount]->latE7);
+	}
+
+	fwrite (record, 1, BIN_RECORD_SIZE, sink->filePtr);
+	sink->count++;
+
+	return;
+}
+
+/* writeCsvName(): writes name as quoted CSV field, quotes are doubled */
+static void writeCsvName (FILE *filePtr, const char *name){
+
+	fputc ('"', filePtr);
+
+	for ( ; *name; name++){
+
+		if (*name == '"')
+			fputc ('"', filePtr);
+
+		fputc (*name, filePtr);
+	}
+
+	fputc ('"', filePtr);
+
+	return;
+}
+
+/* writeCsv(): one row per XROADS:
+ *   first,second,nodes,midLongitude,midLatitude,"lon lat;lon lat;..."
+ * mid-point and node fields are empty when no node was found; nodes field
+ * is empty too when query failed.
+ */
+static void writeCsv (FILE *filePtr, XROADS *xrds){
+
+	char		buffer[NODES_TEXT_SIZE];
+
+	writeCsvName (filePtr, xrds->firstRD);
+	fputc (',', filePtr);
+	writeCsvName (filePtr, xrds->secondRD);
+	if (xrds->status == XRDS_FAILED){
+		fputs (",,,,\n", filePtr);
+		return;
+	}
+
+	fprintf (filePtr, ",%d,", xrds->nodesNum);
+
+	if (xrds->nodesNum == 0){
+		fputs (",,\n", filePtr);
+		return;
+	}
+
+	formatGps (buffer, sizeof(buffer), xrds->midGps, &csvMidFormat);
+	fputs (buffer, filePtr);
+
+	formatGpsArray (buffer, sizeof(buffer), xrds->nodesGPS, xrds->nodesNum, &csvNodeFormat);
+	fputs (buffer, filePtr);
+
+	fputs ("\"\n", filePtr);
+
+	return;
+}
+
+/* writeJsonName(): writes name as JSON string */
+static void writeJsonName (FILE *filePtr, const char *name){
+
+	fputc ('"', filePtr);
+
+	for ( ; *name; name++){
+
+		if (*name == '"' || *name == '\\')
+			fprintf (filePtr, "\\%c", *name);
+
+		else if ((unsigned char) *name < 0x20)
+			fprintf (filePtr, "\\u%04x", (unsigned char) *name);
+
+		else
+			fputc (*name, filePtr);
+	}
+
+	fputc ('"', filePtr);
+
+	return;
+}
+
+/* writeNdjson(): one object per line per XROADS:
+ *   {"first":"..","second":"..","nodes":[[lon,lat],..],"mid":[lon,lat]}
+ * mid is null when no node was found; "failed":true is added when query
+ * failed.
+ */
+static void writeNdjson (FILE *filePtr, XROADS *xrds){
+
+	char		buffer[NODES_TEXT_SIZE];
+
+	fputs ("{\"first\":", filePtr);
+	writeJsonName (filePtr, xrds->firstRD);
+	fputs (",\"second\":", filePtr);
+	writeJsonName (filePtr, xrds->secondRD);
+	fputs (",\"nodes\":[", filePtr);
+
+	formatGpsArray (buffer, sizeof(buffer), xrds->nodesGPS, xrds->nodesNum, &jsonNodeFormat);
+	fputs (buffer, filePtr);
+
+	if (xrds->nodesNum){
+		formatGps (buffer, sizeof(buffer), xrds->midGps, &jsonMidFormat);
+		fputs (buffer, filePtr);
+	}
+	else if (xrds->status == XRDS_FAILED)
+		fputs ("],\"mid\":null,\"failed\":true}\n", filePtr);
+	else
+		fputs ("],\"mid\":null}\n", filePtr);
+
+	return;
+}
+
+/* addSink(): adds filePtr as sink of kind to sinks; sink owns filePtr from
+ * here, closeSinks() closes it - stdout is never closed. WKT kinds get their
+ * "wkt;" first line now, CSV its header line and binary a header to be
+ * completed by closeSinks().
+ */
+int addSink (OUTPUT_SINKS *sinks, SINK_KIND kind, FILE *filePtr){
+
+	XRDS_SINK	*sink;
+
+	ASSERTARGS (sinks && filePtr);
+
+	if (kind == SINK_BINARY && filePtr == stdout){
+		fprintf(stderr, "addSink(): Error binary format needs an output file.\n");
+		return ztInvalidArg;
+	}
+
+	if (sinks->num == MAX_SINKS){
+		fprintf(stderr, "addSink(): Error too many sinks, max is %d.\n", MAX_SINKS);
+		return ztOutOfRangePara;
+	}
+
+	sink = &sinks->sink[sinks->num];
+	memset (sink, 0, sizeof(XRDS_SINK));
+	sink->kind = kind;
+	sink->filePtr = filePtr;
+	sink->error = ztSuccess;
+
+	if (filePtr != stdout){
+
+		/* must be set before first write on stream */
+		sink->buffer = (char *) malloc (SINK_BUFFER_SIZE);
+		if (sink->buffer)
+			setvbuf (filePtr, sink->buffer, _IOFBF, SINK_BUFFER_SIZE);
+	}
+
+	switch (kind){
+
+	case SINK_TEXT:
+	case SINK_NDJSON:
+		break;
+
+	case SINK_CSV:
+		fputs ("first,second,nodesNum,midLongitude,midLatitude,nodes\n", filePtr);
+		break;
+
+	case SINK_BINARY:
+		writeBinHeader (filePtr, 0, 0);
+		break;
+
+	default:
+		fputs ("wkt;\n", filePtr);
+		break;
+	}
+
+	sinks->num++;
+
+	return ztSuccess;
+}
+
+/* sinkXrds(): writes xrds to each sink that takes XROADS */
+void sinkXrds (OUTPUT_SINKS *sinks, XROADS *xrds){
+
+	XRDS_SINK	*sink;
+	char			wktBuf[NODES_TEXT_SIZE];
+	int			length;
+
+	ASSERTARGS (sinks && xrds);
+
+	for (sink = sinks->sink; sink < sinks->sink + sinks->num; sink++){
+
+		switch (sink->kind){
+
+		case SINK_TEXT:
+
+			writeXrds (sink->filePtr, xrds);
+			break;
+
+		case SINK_CSV:
+
+			writeCsv (sink->filePtr, xrds);
+			break;
+
+		case SINK_NDJSON:
+
+			writeNdjson (sink->filePtr, xrds);
+			break;
+
+		case SINK_BINARY:
+
+			writeBinRecord (sink, xrds);
+			break;
+
+		case SINK_WKT:
+
+			length = formatGpsArray (wktBuf, sizeof(wktBuf), xrds->nodesGPS,
+					                    xrds->nodesNum, &wktLineFormat);
+			if (length > 0)
+				fwrite (wktBuf, 1, length, sink->filePtr);
+			break;
+
+		case SINK_MIDGPS:
+
+			if (xrds->nodesNum){
+
+				length = formatGps (wktBuf, sizeof(wktBuf), xrds->midGps, &wktLineFormat);
+				if (length > 0)
+					fwrite (wktBuf, 1, length, sink->filePtr);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return;
+}
+
+/* sinkBbox(): writes bbox polygon to each bounding box sink */
+int sinkBbox (OUTPUT_SINKS *sinks, BBOX *bbox){
+
+	XRDS_SINK	*sink;
+	char			*wktStr = NULL;
+	int			result;
+
+	ASSERTARGS (sinks && bbox);
+
+	for (sink = sinks->sink; sink < sinks->sink + sinks->num; sink++){
+
+		if (sink->kind != SINK_BBOX)
+
+			continue;
+
+		if ( ! wktStr ){
+
+			result = formatBboxWKT (&wktStr, bbox, NULL);
+			if (result != ztSuccess)
+
+				return result;
+		}
+
+		fprintf (sink->filePtr, "%s\n", wktStr);
+	}
+
+	if (wktStr)
+		free (wktStr);
+
+	return ztSuccess;
+}
+
+/* closeSinks(): flushes all sinks, closes their files - not stdout - and
+ * frees buffers. Binary sink gets its names section and final header.
+ * Returns ztWriteError if any write failed.
+ */
+int closeSinks (OUTPUT_SINKS *sinks){
+
+	XRDS_SINK	*sink;
+	int			retCode = ztSuccess;
+
+	ASSERTARGS (sinks);
+
+	for (sink = sinks->sink; sink < sinks->sink + sinks->num; sink++){
+
+		if (sink->error != ztSuccess)
+			retCode = sink->error;
+
+		if (sink->kind == SINK_BINARY){
+
+			if (sink->names.size)
+				fwrite (sink->names.memory, 1, sink->names.size, sink->filePtr);
+
+			if (fseek (sink->filePtr, 0L, SEEK_SET) == 0)
+				writeBinHeader (sink->filePtr, sink->count,
+						           BIN_HEADER_SIZE + (uint64_t) sink->count * BIN_RECORD_SIZE);
+			else
+				retCode = ztWriteError;
+
+			zapMemory (&sink->names);
+		}
+
+		if (fflush (sink->filePtr) != 0 || ferror (sink->filePtr)){
+			fprintf(stderr, "closeSinks(): Error writing output file.\n");
+			retCode = ztWriteError;
+		}
+
+		if (sink->filePtr != stdout)
+			fclose (sink->filePtr);
+
+		if (sink->buffer)
+			free (sink->buffer);
+	}
+
+	sinks->num = 0;
+
+	return retCode;
+}
+
+/* startEmitter(): emitter writes XROADS from xrdsDL to sinks; xrdsDL must
+ * stay as is until every XROADS in it is resolved.
+ */
+void startEmitter (XRDS_EMITTER *emitter, OUTPUT_SINKS *sinks, DL_LIST *xrdsDL){
+
+	ASSERTARGS (emitter && sinks && xrdsDL);
+
+	emitter->sinks = sinks;
+	emitter->frontier = DL_HEAD(xrdsDL);
+
+	return;
+}
+
+/* emitDone(): XRDS_DONE_FUNC for query engines, data is XRDS_EMITTER.
+ * XROADS are done in any order; writes every resolved XROADS at frontier
+ * so output is in input order.
+ */
+void emitDone (XROADS *xrds, void *data){
+
+	XRDS_EMITTER	*emitter = (XRDS_EMITTER *) data;
+	XROADS		*next;
+
+	ASSERTARGS (xrds && emitter);
+
+	while (emitter->frontier){
+
+		next = (XROADS *) DL_DATA(emitter->frontier);
+		if (next->status == XRDS_PENDING)
+
+			break;
+
+		sinkXrds (emitter->sinks, next);
+
+		emitter->frontier = DL_NEXT(emitter->frontier);
+	}
+
+	return;
+}
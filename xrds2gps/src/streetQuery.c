@@ -0,0 +1,1127 @@
+/*
+ * streetQuery.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: wael
+ *
+ * Cross roads by street: instead of asking the server for common nodes of
+ * each pair, node ids for each distinct street name in bbox are fetched once
+ * - ids only, in one query - and kept for the run in STREET_CACHE. Common
+ * nodes for each pair are found here with sorted set intersection, then
+ * coordinates for all common nodes are fetched in one more query. Server work
+ * goes with number of distinct streets, not number of pairs; a street listed
+ * again - in the same file or another with the same bbox - is not fetched.
+ * Grid: for input made of north-south and east-west street lists, nodes with
+ * coordinates for each group are fetched in one query per group and the
+ * N x M table is made here; two queries for the whole grid.
+ * Crossings: for street names alone, every node each street shares with
+ * another named highway is fetched with the other street name in one query;
+ * cross roads are made here, one XROADS per crossing street name.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <curl/curl.h>
+
+#include "streetQuery.h"
+#include "overpass-c.h"
+#include "op_string.h"
+#include "curl_func.h"
+#include "cache.h"
+#include "coord.h"
+#include "util.h"
+#include "ztError.h"
+
+static char	*streetsHeader = "@id	@count";
+static char	*nodesHeader = "@id	@lat	@lon";
+static char	*gridHeader = "@id	@lat	@lon	@count";
+static char	*crossingsHeader = "@type	@id	name	@lat	@lon	@count";
+
+/* node coordinates from grid group and crossings queries */
+typedef struct NODE_GPS_ {
+
+	int64_t	id;
+	GPS		gps;
+	int		owner;	// crossings: XROADS index in batch
+
+} NODE_GPS;
+
+typedef struct NODE_TABLE_ {
+
+	NODE_GPS	*nodes;
+	int		count;
+	int		capacity;
+
+} NODE_TABLE;
+
+/* initialStreetCache(): sets streets to empty. */
+void initialStreetCache (STREET_CACHE *streets){
+
+	ASSERTARGS (streets);
+
+	memset (streets, 0, sizeof(STREET_CACHE));
+
+	return;
+}
+
+/* zapStreetCache(): frees all memory in streets, it is empty after. */
+void zapStreetCache (STREET_CACHE *streets){
+
+	int	iCount;
+
+	ASSERTARGS (streets);
+
+	for (iCount = 0; iCount < streets->count; iCount++)
+
+		zapNodeSet (&streets->entries[iCount].ids);
+
+	if (streets->entries)
+		free (streets->entries);
+
+	memset (streets, 0, sizeof(STREET_CACHE));
+
+	return;
+}
+
+/* streetKey(): key for name in bbox; case and white space do not matter.
+ * Exact name match is another street set than regex match of same name.
+ */
+static uint64_t streetKey (BBOX *bbox, const char *name, int exact){
+
+	char		buffer[LONG_LINE + 64];
+
+	snprintf (buffer, sizeof(buffer), "%d,%d,%d,%d %c%s",
+			     bbox->sw.gps.latE7, bbox->sw.gps.lonE7,
+			     bbox->ne.gps.latE7, bbox->ne.gps.lonE7, exact ? '=' : '~', name);
+
+	return queryKey (buffer);
+}
+
+/* findStreet(): returns index of entry with key in streets or -1. */
+static int findStreet (STREET_CACHE *streets, uint64_t key){
+
+	int	iCount;
+
+	for (iCount = 0; iCount < streets->count; iCount++)
+
+		if (streets->entries[iCount].key == key)
+
+			return iCount;
+
+	return -1;
+}
+
+/* newStreet(): adds empty entry for key to streets.
+ * Returns its index or -1 on memory error.
+ */
+static int newStreet (STREET_CACHE *streets, uint64_t key){
+
+	STREET_ENTRY	*newEntries;
+	int			newCapacity;
+
+	if (streets->count == streets->capacity){
+
+		newCapacity = streets->capacity ? streets->capacity * 2 : 64;
+
+		newEntries = (STREET_ENTRY *) realloc (streets->entries,
+				                                sizeof(STREET_ENTRY) * newCapacity);
+		if ( ! newEntries )
+
+			return -1;
+
+		streets->entries = newEntries;
+		streets->capacity = newCapacity;
+	}
+
+	if (initialNodeSet (&streets->entries[streets->count].ids, 0) != ztSuccess)
+
+		return -1;
+
+	streets->entries[streets->count].key = key;
+
+	return streets->count++;
+}
+
+/* nextLine(): returns next line in [*ptr, end) and its length without line
+ * feed and carriage return, moves *ptr past it; NULL at end.
+ */
+static const char *nextLine (const char **ptr, const char *end, size_t *length){
+
+	const char	*line = *ptr;
+	const char	*lineFeed;
+
+	if (line >= end)
+
+		return NULL;
+
+	lineFeed = memchr (line, '\n', end - line);
+	if (lineFeed){
+		*length = lineFeed - line;
+		*ptr = lineFeed + 1;
+	}
+	else {
+		*length = end - line;
+		*ptr = end;
+	}
+
+	if (*length && line[*length - 1] == '\r')
+		(*length)--;
+
+	return line;
+}
+
+/* scanNumber(): reads decimal number at start of line up to tab or end,
+ * leading tabs are skipped; *next is set after it.
+ * Returns 1 on success, 0 for no number.
+ */
+static int scanNumber (int64_t *number, const char *line, size_t length, const char **next){
+
+	const char	*end = line + length;
+	int64_t		value = 0;
+	int			numDigits = 0;
+
+	while (line < end && *line == '\t')
+		line++;
+
+	for ( ; line < end && *line >= '0' && *line <= '9'; line++, numDigits++)
+
+		value = value * 10 + (*line - '0');
+
+	if (numDigits == 0 || numDigits > 18 || (line < end && *line != '\t'))
+
+		return 0;
+
+	*number = value;
+	if (next)
+		*next = line;
+
+	return 1;
+}
+
+/* addNodeTable(): appends id with gps and owner to table. */
+static int addNodeTable (NODE_TABLE *table, int64_t id, GPS *gps, int owner){
+
+	NODE_GPS	*newNodes;
+	int		newCapacity;
+
+	if (table->count == table->capacity){
+
+		newCapacity = table->capacity ? table->capacity * 2 : 1024;
+
+		newNodes = (NODE_GPS *) realloc (table->nodes, sizeof(NODE_GPS) * newCapacity);
+		if ( ! newNodes )
+
+			return ztMemoryAllocate;
+
+		table->nodes = newNodes;
+		table->capacity = newCapacity;
+	}
+
+	table->nodes[table->count].id = id;
+	table->nodes[table->count].gps = *gps;
+	table->nodes[table->count].owner = owner;
+	table->count++;
+
+	return ztSuccess;
+}
+
+static int compareNodeGps (const void *first, const void *second){
+
+	int64_t	a = ((const NODE_GPS *) first)->id;
+	int64_t	b = ((const NODE_GPS *) second)->id;
+
+	return (a > b) - (a < b);
+}
+
+static int compareOwnerNode (const void *first, const void *second){
+
+	const NODE_GPS	*a = (const NODE_GPS *) first;
+	const NODE_GPS	*b = (const NODE_GPS *) second;
+
+	if (a->owner != b->owner)
+
+		return (a->owner > b->owner) - (a->owner < b->owner);
+
+	return (a->id > b->id) - (a->id < b->id);
+}
+
+/* parseStreetsData(): parses response for streetsFillTemplate() query with
+ * numStreets streets into sets - in the same order. For each street zero or
+ * more id lines then a count line "<TAB>count" closing it. Sets are sorted.
+ * With table - query made withGps - id lines have coordinates too, they are
+ * added to table; count line starts with three tabs then.
+ * Return: ztSuccess, ztGotNull, ztInvalidResponse, ztUnexpectedEOF,
+ * ztMemoryAllocate or parseGPSView() error.
+ */
+static int parseStreetsData (NODE_SET **sets, int numStreets, MEMORY_STRUCT *data,
+		                      NODE_TABLE *table){
+
+	const char	*ptr = MEMORY_BYTES(data);
+	const char	*end = ptr + MEMORY_LENGTH(data);
+	const char	*line, *next;
+	size_t		length;
+	int64_t		number;
+	GPS			gps;
+	int			current = 0;
+	int			numRows = 0;
+	int			result;
+
+	if ( ! nextLine (&ptr, end, &length) ) // header, checked by caller
+
+		return ztGotNull;
+
+	while ((line = nextLine (&ptr, end, &length))){
+
+		if (length == 0)
+
+			continue;
+
+		if (current == numStreets || ! scanNumber (&number, line, length, &next)){
+			printf ("parseStreetsData(): Error unexpected line: <%.*s>\n", (int) length, line);
+			return ztInvalidResponse;
+		}
+
+		if (line[0] != '\t'){ // id line
+
+			if (addNodeSet (sets[current], number) != ztSuccess)
+
+				return ztMemoryAllocate;
+
+			if (table){
+
+				if (next == line + length){
+					printf ("parseStreetsData(): Error missing coordinates: <%.*s>\n",
+							   (int) length, line);
+					return ztInvalidResponse;
+				}
+
+				next++; // tab after id
+
+				result = parseGPSView (&gps, next, length - (next - line));
+				if (result != ztSuccess)
+
+					return result;
+
+				if (addNodeTable (table, number, &gps, 0) != ztSuccess)
+
+					return ztMemoryAllocate;
+			}
+
+			numRows++;
+			continue;
+		}
+
+		if (number != numRows){
+			printf ("parseStreetsData(): Error count line <%.*s> does not match "
+					    "[ %d ] id lines.\n", (int) length, line, numRows);
+			return ztInvalidResponse;
+		}
+
+		sortNodeSet (sets[current]);
+
+		current++;
+		numRows = 0;
+	}
+
+	if (current < numStreets){
+		printf ("parseStreetsData(): Error response ended before all streets "
+				    "were parsed.\n");
+		return ztUnexpectedEOF;
+	}
+
+	return ztSuccess;
+}
+
+/* parseNodesData(): parses response for nodesFillTemplate() query; lines
+ * "id<TAB>lat<TAB>lon". GPS for ids[i] goes to gps[i], found[i] is set.
+ * Return: ztSuccess, ztGotNull, ztInvalidResponse or parseGPSView() error.
+ */
+static int parseNodesData (NODE_SET *ids, GPS *gps, char *found, MEMORY_STRUCT *data){
+
+	const char	*ptr = MEMORY_BYTES(data);
+	const char	*end = ptr + MEMORY_LENGTH(data);
+	const char	*line, *next;
+	size_t		length;
+	int64_t		number;
+	int			index;
+	int			result;
+
+	if ( ! nextLine (&ptr, end, &length) ) // header, checked by caller
+
+		return ztGotNull;
+
+	while ((line = nextLine (&ptr, end, &length))){
+
+		if (length == 0)
+
+			continue;
+
+		if ( ! scanNumber (&number, line, length, &next) || next == line + length ||
+			(index = findNodeSet (ids, number)) < 0 ){
+			printf ("parseNodesData(): Error unexpected line: <%.*s>\n", (int) length, line);
+			return ztInvalidResponse;
+		}
+
+		next++; // tab after id
+
+		result = parseGPSView (&gps[index], next, length - (next - line));
+		if (result != ztSuccess)
+
+			return result;
+
+		found[index] = 1;
+	}
+
+	return ztSuccess;
+}
+
+/* fetchQuery(): sends query, response must start with header; query is freed.
+ * Response is in queryMemory(handle). what is for raw data file.
+ */
+static int fetchQuery (char *query, char *header, CURLU *srvrURL, CURL *handle,
+		                const char *what, int count){
+
+	MEMORY_STRUCT	*answer = queryMemory (handle);
+	int				result;
+
+	result = performQuery (answer, query, header, srvrURL, handle);
+	free (query);
+	if (result != ztSuccess){
+		fprintf (stderr, "fetchQuery(): Error returned from performQuery().\n");
+		return result;
+	}
+
+	if (rawDataFP) {
+
+		fprintf (rawDataFP, "Data for %s of [ %d ]:\n\n", what, count);
+		fprintf (rawDataFP, "%s", MEMORY_BYTES(answer));
+		fprintf (rawDataFP,
+				"\n ++++++++++++++++++++++++++++++++++++++++++++++++\n\n");
+		fflush (rawDataFP);
+	}
+
+	return ztSuccess;
+}
+
+/* streetGetXrdsDL(): fills GPS members for each XROADS in xrdsDL; see top
+ * of file. Street node id sets not in streets are fetched in one query and
+ * added there, then coordinates of common nodes in one more. Same nodes -
+ * first MAX_NODES by node id - as xrdsFillTemplate() query gives.
+ * done - when not NULL - is called with doneData as each XROADS is filled.
+ ***************************************************************************/
+int streetGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL, STREET_CACHE *streets,
+		              XRDS_DONE_FUNC done, void *doneData){
+
+	CURL			*handle = NULL;
+	char			*query;
+	char			**names = NULL;	// distinct names, NOT owned
+	int			*nameEntry = NULL;	// streets entry index per name
+	int			*pairName = NULL;	// two names indexes per pair
+	char			**missNames = NULL;	// names to fetch
+	int			*missExact = NULL;	// exact flag per name to fetch
+	NODE_SET		**missSets = NULL;
+	int64_t		*pairIds = NULL;		// MAX_NODES per pair
+	int			*pairCount = NULL;
+	NODE_SET		shared, wanted;
+	GPS			*gps = NULL;			// wanted order
+	char			*found = NULL;
+	int			numPairs, numNames = 0, numMiss = 0;
+	int			oldCount;
+	int			iCount, jCount, side;
+	DL_ELEM		*elem;
+	XROADS		*xrds;
+	char			*pairNames[2];
+	int			pairExact[2];
+	int			*nameExact = NULL;	// exact flag per distinct name
+	uint64_t		key;
+	int			result = ztSuccess;
+
+	ASSERTARGS (xrdsDL && bbox && srvrURL && streets);
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	oldCount = streets->count;
+	numPairs = DL_SIZE(xrdsDL);
+
+	memset (&shared, 0, sizeof(NODE_SET));
+	memset (&wanted, 0, sizeof(NODE_SET));
+
+	names = (char **) malloc (sizeof(char *) * numPairs * 2);
+	nameEntry = (int *) malloc (sizeof(int) * numPairs * 2);
+	pairName = (int *) malloc (sizeof(int) * numPairs * 2);
+	nameExact = (int *) malloc (sizeof(int) * numPairs * 2);
+	missNames = (char **) malloc (sizeof(char *) * numPairs * 2);
+	missExact = (int *) malloc (sizeof(int) * numPairs * 2);
+	missSets = (NODE_SET **) malloc (sizeof(NODE_SET *) * numPairs * 2);
+	pairIds = (int64_t *) malloc (sizeof(int64_t) * numPairs * MAX_NODES);
+	pairCount = (int *) malloc (sizeof(int) * numPairs);
+
+	if ( ! names || ! nameEntry || ! pairName || ! nameExact || ! missNames ||
+		! missExact || ! missSets ||
+		! pairIds || ! pairCount ||
+		initialNodeSet (&shared, 0) != ztSuccess || initialNodeSet (&wanted, 0) != ztSuccess ){
+		fprintf (stderr, "streetGetXrdsDL(): Error allocating memory.\n");
+		result = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	/* distinct names - case insensitive, same exact flag - and their cache
+	 * entries; names are already white space clean from xrdsParseNames() */
+	for (elem = DL_HEAD(xrdsDL), iCount = 0; elem; elem = DL_NEXT(elem), iCount++){
+
+		xrds = (XROADS *) DL_DATA(elem);
+		ASSERTARGS (xrds->firstRD && xrds->secondRD);
+
+		pairNames[0] = xrds->firstRD;
+		pairNames[1] = xrds->secondRD;
+		pairExact[0] = (xrds->exact & XRDS_EXACT_FIRST) != 0;
+		pairExact[1] = (xrds->exact & XRDS_EXACT_SECOND) != 0;
+
+		for (side = 0; side < 2; side++){
+
+			for (jCount = 0; jCount < numNames; jCount++)
+
+				if (nameExact[jCount] == pairExact[side] &&
+					strcasecmp (names[jCount], pairNames[side]) == 0)
+
+					break;
+
+			if (jCount == numNames){
+
+				names[numNames] = pairNames[side];
+				nameExact[numNames] = pairExact[side];
+
+				key = streetKey (bbox, pairNames[side], pairExact[side]);
+				nameEntry[numNames] = findStreet (streets, key);
+
+				if (nameEntry[numNames] < 0){
+
+					nameEntry[numNames] = newStreet (streets, key);
+					if (nameEntry[numNames] < 0){
+						fprintf (stderr, "streetGetXrdsDL(): Error allocating memory.\n");
+						result = ztMemoryAllocate;
+						goto cleanup;
+					}
+
+					missExact[numMiss] = pairExact[side];
+					missNames[numMiss++] = pairNames[side];
+				}
+
+				numNames++;
+			}
+
+			pairName[iCount * 2 + side] = jCount;
+		}
+	}
+
+	/* entries do not move from here on */
+	for (iCount = 0; iCount < numMiss; iCount++)
+
+		missSets[iCount] = &streets->entries[oldCount + iCount].ids;
+
+	printf ("streetGetXrdsDL(): [ %d ] of [ %d ] street names to fetch.\n", numMiss, numNames);
+
+	handle = initialQuery (srvrURL);
+	if ( ! handle ){
+		fprintf (stderr, "streetGetXrdsDL(): Error returned from initialQuery().\n");
+		result = ztGotNull;
+		goto cleanup;
+	}
+
+	if (numMiss){
+
+		result = streetsFillTemplate (&query, missNames, missExact, numMiss, bbox, 0);
+		if (result == ztSuccess)
+			result = fetchQuery (query, streetsHeader, srvrURL, handle, "street node ids", numMiss);
+		if (result == ztSuccess)
+			result = parseStreetsData (missSets, numMiss, queryMemory (handle), NULL);
+
+		if (result != ztSuccess){
+			fprintf (stderr, "streetGetXrdsDL(): Error getting street node ids: %s\n",
+					    code2Msg (result));
+			goto cleanup;
+		}
+	}
+
+	/* common nodes per pair; keep first MAX_NODES, same as server */
+	for (iCount = 0; iCount < numPairs; iCount++){
+
+		result = intersectNodeSets (&shared,
+				                    &streets->entries[nameEntry[pairName[iCount * 2]]].ids,
+				                    &streets->entries[nameEntry[pairName[iCount * 2 + 1]]].ids);
+		if (result != ztSuccess)
+
+			goto cleanup;
+
+		pairCount[iCount] = MIN(shared.count, MAX_NODES);
+
+		for (jCount = 0; jCount < pairCount[iCount]; jCount++){
+
+			pairIds[iCount * MAX_NODES + jCount] = shared.ids[jCount];
+
+			result = addNodeSet (&wanted, shared.ids[jCount]);
+			if (result != ztSuccess)
+
+				goto cleanup;
+		}
+	}
+
+	sortNodeSet (&wanted);
+
+	if (wanted.count){
+
+		gps = (GPS *) malloc (sizeof(GPS) * wanted.count);
+		found = (char *) calloc (wanted.count, sizeof(char));
+		if ( ! gps || ! found ){
+			fprintf (stderr, "streetGetXrdsDL(): Error allocating memory.\n");
+			result = ztMemoryAllocate;
+			goto cleanup;
+		}
+
+		result = nodesFillTemplate (&query, wanted.ids, wanted.count);
+		if (result == ztSuccess)
+			result = fetchQuery (query, nodesHeader, srvrURL, handle, "node coordinates", wanted.count);
+		if (result == ztSuccess)
+			result = parseNodesData (&wanted, gps, found, queryMemory (handle));
+
+		for (iCount = 0; iCount < wanted.count && result == ztSuccess; iCount++)
+
+			if ( ! found[iCount] ){
+				printf ("streetGetXrdsDL(): Error node [ %lld ] is missing in response.\n",
+						   (long long) wanted.ids[iCount]);
+				result = ztInvalidResponse;
+			}
+
+		if (result != ztSuccess){
+			fprintf (stderr, "streetGetXrdsDL(): Error getting node coordinates: %s\n",
+					    code2Msg (result));
+			goto cleanup;
+		}
+	}
+
+	for (elem = DL_HEAD(xrdsDL), iCount = 0; elem; elem = DL_NEXT(elem), iCount++){
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		xrds->nodesNum = pairCount[iCount];
+
+		for (jCount = 0; jCount < xrds->nodesNum; jCount++)
+
+			*(xrds->nodesGPS[jCount]) =
+					gps[findNodeSet (&wanted, pairIds[iCount * MAX_NODES + jCount])];
+
+		if (xrds->nodesNum){
+
+			gpsCentroid (xrds->midGps, xrds->nodesGPS, xrds->nodesNum);
+			xrds->point->gps = *(xrds->midGps);
+		}
+
+		xrds->status = XRDS_RESOLVED;
+
+		if (done)
+			done (xrds, doneData);
+	}
+
+cleanup:
+
+	/* street sets not fetched are not kept */
+	if (result != ztSuccess){
+
+		for (iCount = oldCount; iCount < streets->count; iCount++)
+
+			zapNodeSet (&streets->entries[iCount].ids);
+
+		streets->count = oldCount;
+	}
+
+	if (handle)
+		closeQuery (handle);
+
+	zapNodeSet (&shared);
+	zapNodeSet (&wanted);
+
+	if (names)
+		free (names);
+
+	if (nameEntry)
+		free (nameEntry);
+
+	if (pairName)
+		free (pairName);
+
+	if (nameExact)
+		free (nameExact);
+
+	if (missNames)
+		free (missNames);
+
+	if (missExact)
+		free (missExact);
+
+	if (missSets)
+		free (missSets);
+
+	if (pairIds)
+		free (pairIds);
+
+	if (pairCount)
+		free (pairCount);
+
+	if (gps)
+		free (gps);
+
+	if (found)
+		free (found);
+
+	return result;
+
+} // END streetGetXrdsDL()
+
+/* distinctNames(): collects distinct names - case insensitive, same exact
+ * flag - from side of each XROADS in xrdsDL - 0 for firstRD, 1 for
+ * secondRD - into names and their exact flags into exact; index[i] is set
+ * to names index of pair i. Returns number of names.
+ */
+static int distinctNames (char **names, int *exact, int *index, DL_LIST *xrdsDL, int side){
+
+	DL_ELEM	*elem;
+	XROADS	*xrds;
+	char		*name;
+	int		isExact;
+	int		numNames = 0;
+	int		iCount, jCount;
+
+	for (elem = DL_HEAD(xrdsDL), iCount = 0; elem; elem = DL_NEXT(elem), iCount++){
+
+		xrds = (XROADS *) DL_DATA(elem);
+		name = side ? xrds->secondRD : xrds->firstRD;
+		isExact = (xrds->exact & (side ? XRDS_EXACT_SECOND : XRDS_EXACT_FIRST)) != 0;
+
+		for (jCount = 0; jCount < numNames; jCount++)
+
+			if (exact[jCount] == isExact && strcasecmp (names[jCount], name) == 0)
+
+				break;
+
+		if (jCount == numNames){
+
+			exact[numNames] = isExact;
+			names[numNames++] = name;
+		}
+
+		index[iCount] = jCount;
+	}
+
+	return numNames;
+}
+
+/* gridGetXrdsDL(): fills GPS members for each XROADS in xrdsDL with two
+ * queries: one for nodes - with coordinates - of every distinct firstRD
+ * street, one for every distinct secondRD street; common nodes for each pair
+ * are found here. Made for grid input - north-south streets by east-west
+ * streets - but works for any list; same nodes as xrdsFillTemplate() query.
+ * done - when not NULL - is called with doneData as each XROADS is filled.
+ ***************************************************************************/
+int gridGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL,
+		            XRDS_DONE_FUNC done, void *doneData){
+
+	CURL			*handle = NULL;
+	char			*query;
+	char			**names[2] = {NULL, NULL};	// distinct names per side, NOT owned
+	int			*pairName[2] = {NULL, NULL};	// names index per pair per side
+	int			*nameExact[2] = {NULL, NULL};	// exact flag per name per side
+	NODE_SET		*sets[2] = {NULL, NULL};
+	NODE_SET		**setPtrs = NULL;
+	int			numNames[2] = {0, 0};
+	NODE_TABLE	table = {NULL, 0, 0};
+	NODE_SET		shared;
+	NODE_GPS		key, *found;
+	int			numPairs;
+	int			iCount, side;
+	DL_ELEM		*elem;
+	XROADS		*xrds;
+	int			result = ztSuccess;
+
+	ASSERTARGS (xrdsDL && bbox && srvrURL);
+
+	if (DL_SIZE(xrdsDL) == 0)
+
+		return ztSuccess;
+
+	numPairs = DL_SIZE(xrdsDL);
+
+	memset (&shared, 0, sizeof(NODE_SET));
+
+	setPtrs = (NODE_SET **) malloc (sizeof(NODE_SET *) * numPairs);
+	if ( ! setPtrs ){
+		fprintf (stderr, "gridGetXrdsDL(): Error allocating memory.\n");
+		return ztMemoryAllocate;
+	}
+
+	handle = initialQuery (srvrURL);
+	if ( ! handle ){
+		fprintf (stderr, "gridGetXrdsDL(): Error returned from initialQuery().\n");
+		result = ztGotNull;
+		goto cleanup;
+	}
+
+	for (side = 0; side < 2; side++){
+
+		names[side] = (char **) malloc (sizeof(char *) * numPairs);
+		pairName[side] = (int *) malloc (sizeof(int) * numPairs);
+		nameExact[side] = (int *) malloc (sizeof(int) * numPairs);
+		if ( ! names[side] || ! pairName[side] || ! nameExact[side] ){
+			fprintf (stderr, "gridGetXrdsDL(): Error allocating memory.\n");
+			result = ztMemoryAllocate;
+			goto cleanup;
+		}
+
+		numNames[side] = distinctNames (names[side], nameExact[side], pairName[side], xrdsDL, side);
+
+		sets[side] = (NODE_SET *) calloc (numNames[side], sizeof(NODE_SET));
+		if ( ! sets[side] ){
+			fprintf (stderr, "gridGetXrdsDL(): Error allocating memory.\n");
+			result = ztMemoryAllocate;
+			goto cleanup;
+		}
+
+		for (iCount = 0; iCount < numNames[side]; iCount++)
+
+			setPtrs[iCount] = &sets[side][iCount];
+
+		result = streetsFillTemplate (&query, names[side], nameExact[side], numNames[side], bbox, 1);
+		if (result == ztSuccess)
+			result = fetchQuery (query, gridHeader, srvrURL, handle, "grid streets", numNames[side]);
+		if (result == ztSuccess)
+			result = parseStreetsData (setPtrs, numNames[side], queryMemory (handle), &table);
+
+		if (result != ztSuccess){
+			fprintf (stderr, "gridGetXrdsDL(): Error getting street nodes: %s\n",
+					    code2Msg (result));
+			goto cleanup;
+		}
+	}
+
+	printf ("gridGetXrdsDL(): [ %d ] x [ %d ] streets grid for [ %d ] cross roads.\n",
+			   numNames[0], numNames[1], numPairs);
+
+	qsort (table.nodes, table.count, sizeof(NODE_GPS), compareNodeGps);
+
+	for (elem = DL_HEAD(xrdsDL), iCount = 0; elem; elem = DL_NEXT(elem), iCount++){
+
+		xrds = (XROADS *) DL_DATA(elem);
+
+		result = intersectNodeSets (&shared, &sets[0][pairName[0][iCount]],
+				                    &sets[1][pairName[1][iCount]]);
+		if (result != ztSuccess)
+
+			goto cleanup;
+
+		for (xrds->nodesNum = 0; xrds->nodesNum < MIN(shared.count, MAX_NODES); xrds->nodesNum++){
+
+			key.id = shared.ids[xrds->nodesNum];
+			found = (NODE_GPS *) bsearch (&key, table.nodes, table.count,
+					                       sizeof(NODE_GPS), compareNodeGps);
+
+			*(xrds->nodesGPS[xrds->nodesNum]) = found->gps; // both sets came from table
+		}
+
+		if (xrds->nodesNum){
+
+			gpsCentroid (xrds->midGps, xrds->nodesGPS, xrds->nodesNum);
+			xrds->point->gps = *(xrds->midGps);
+		}
+
+		xrds->status = XRDS_RESOLVED;
+
+		if (done)
+			done (xrds, doneData);
+	}
+
+cleanup:
+
+	if (handle)
+		closeQuery (handle);
+
+	for (side = 0; side < 2; side++){
+
+		if (sets[side]){
+
+			for (iCount = 0; iCount < numNames[side]; iCount++)
+
+				zapNodeSet (&sets[side][iCount]);
+
+			free (sets[side]);
+		}
+
+		if (names[side])
+			free (names[side]);
+
+		if (pairName[side])
+			free (pairName[side]);
+
+		if (nameExact[side])
+			free (nameExact[side]);
+	}
+
+	if (table.nodes)
+		free (table.nodes);
+
+	zapNodeSet (&shared);
+	free (setPtrs);
+
+	return result;
+
+} // END gridGetXrdsDL()
+
+/* isRowType(): TRUE when line starts with type then a tab. */
+static int isRowType (const char *line, size_t length, const char *type){
+
+	size_t	typeLength = strlen (type);
+
+	return length > typeLength && line[typeLength] == '\t' &&
+			memcmp (line, type, typeLength) == 0;
+}
+
+/* parseCrossingsData(): parses response for crossingsFillTemplate() query
+ * with numStreets streets. A way row starts a crossing: XROADS for street
+ * and way name is taken from batch - or made when this street has none with
+ * that name yet, case insensitive - and inserted in xrdsDL. Node rows after
+ * it are added to table with that XROADS index as owner. Count row closes
+ * the rows for current street.
+ * Return: ztSuccess, ztGotNull, ztInvalidResponse, ztUnexpectedEOF,
+ * ztMemoryAllocate or parseGPSView() error.
+ */
+static int parseCrossingsData (XRDS_BATCH *batch, DL_LIST *xrdsDL, char **streets,
+		                        int numStreets, MEMORY_STRUCT *data, NODE_TABLE *table){
+
+	const char	*ptr = MEMORY_BYTES(data);
+	const char	*end = ptr + MEMORY_LENGTH(data);
+	const char	*line, *next, *tab;
+	size_t		length, nameLength;
+	char			name[LONG_LINE];
+	int64_t		number;
+	GPS			gps;
+	XROADS		*xrds;
+	int			current = 0;
+	int			first = 0;	// batch index of first XROADS for current street
+	int			owner = -1;
+	int			result;
+
+	if ( ! nextLine (&ptr, end, &length) ) // header, checked by caller
+
+		return ztGotNull;
+
+	while ((line = nextLine (&ptr, end, &length))){
+
+		if (length == 0)
+
+			continue;
+
+		if (current < numStreets && isRowType (line, length, "way")){
+
+			if ( ! scanNumber (&number, line + 4, length - 4, &next) || next == line + length )
+
+				goto badLine;
+
+			next++; // tab after id
+			tab = memchr (next, '\t', line + length - next);
+			nameLength = (tab ? tab : line + length) - next;
+			if (nameLength == 0 || nameLength >= LONG_LINE)
+
+				goto badLine;
+
+			memcpy (name, next, nameLength);
+			name[nameLength] = '\0';
+
+			for (owner = first; owner < batch->count; owner++)
+
+				if (strcasecmp (batch->xrds[owner].secondRD, name) == 0)
+
+					break;
+
+			if (owner == batch->count){
+
+				xrds = batchNewXrds (batch, streets[current], name);
+				if ( ! xrds )
+
+					return ztMemoryAllocate;
+
+				insertNextDL (xrdsDL, DL_TAIL(xrdsDL), xrds);
+			}
+		}
+		else if (owner >= 0 && isRowType (line, length, "node")){
+
+			if ( ! scanNumber (&number, line + 5, length - 5, &next) || next == line + length )
+
+				goto badLine;
+
+			// skip node name field
+			next = memchr (next + 1, '\t', line + length - next - 1);
+			if ( ! next )
+
+				goto badLine;
+
+			next++;
+
+			result = parseGPSView (&gps, next, length - (next - line));
+			if (result != ztSuccess)
+
+				return result;
+
+			if (addNodeTable (table, number, &gps, owner) != ztSuccess)
+
+				return ztMemoryAllocate;
+		}
+		else if (current < numStreets && isRowType (line, length, "count")){
+
+			current++;
+			first = batch->count;
+			owner = -1;
+		}
+		else
+
+			goto badLine;
+	}
+
+	if (current < numStreets){
+		printf ("parseCrossingsData(): Error response ended before all streets "
+				    "were parsed.\n");
+		return ztUnexpectedEOF;
+	}
+
+	return ztSuccess;
+
+badLine:
+
+	printf ("parseCrossingsData(): Error unexpected line: <%.*s>\n", (int) length, line);
+
+	return ztInvalidResponse;
+}
+
+/* crossingsGetXrdsDL(): finds every crossing of numStreets street names in
+ * bbox with one query; see crossingsFillTemplate(). One XROADS is made for
+ * each street and crossing street name - streets order, then crossing way
+ * order in response - with first MAX_NODES shared nodes by node id; each is
+ * resolved and inserted in xrdsDL. batch is made here sized for the answer,
+ * caller frees it with zapXrdsBatch(); on error it is NULL and xrdsDL is
+ * emptied.
+ ***************************************************************************/
+int crossingsGetXrdsDL (XRDS_BATCH **batch, DL_LIST *xrdsDL, char **streets, int numStreets,
+		                 BBOX *bbox, CURLU *srvrURL){
+
+	CURL			*handle = NULL;
+	char			*query;
+	MEMORY_STRUCT	*answer;
+	const char	*ptr, *end, *line;
+	size_t		length, maxLength = 0;
+	int			numWays = 0;
+	NODE_TABLE	table = {NULL, 0, 0};
+	NODE_GPS		*node;
+	XROADS		*xrds;
+	int			iCount;
+	int			result;
+
+	ASSERTARGS (batch && xrdsDL && streets && bbox && srvrURL);
+
+	*batch = NULL;
+
+	handle = initialQuery (srvrURL);
+	if ( ! handle ){
+		fprintf (stderr, "crossingsGetXrdsDL(): Error returned from initialQuery().\n");
+		return ztGotNull;
+	}
+
+	result = crossingsFillTemplate (&query, streets, numStreets, bbox);
+	if (result == ztSuccess)
+		result = fetchQuery (query, crossingsHeader, srvrURL, handle, "street crossings", numStreets);
+
+	if (result != ztSuccess){
+		fprintf (stderr, "crossingsGetXrdsDL(): Error getting street crossings: %s\n",
+				    code2Msg (result));
+		goto cleanup;
+	}
+
+	answer = queryMemory (handle);
+
+	/* way rows bound number of XROADS; each copies its way name - from the
+	 * answer - and one street name */
+	ptr = MEMORY_BYTES(answer);
+	end = ptr + MEMORY_LENGTH(answer);
+	while ((line = nextLine (&ptr, end, &length)))
+
+		if (isRowType (line, length, "way"))
+
+			numWays++;
+
+	for (iCount = 0; iCount < numStreets; iCount++)
+
+		maxLength = MAX(maxLength, strlen (streets[iCount]));
+
+	*batch = initialXrdsBatch (MAX(numWays, 1), MEMORY_LENGTH(answer) + numWays * (maxLength + 2));
+	if ( ! *batch ){
+		result = ztMemoryAllocate;
+		goto cleanup;
+	}
+
+	result = parseCrossingsData (*batch, xrdsDL, streets, numStreets, answer, &table);
+	if (result != ztSuccess){
+		fprintf (stderr, "crossingsGetXrdsDL(): Error parsing street crossings: %s\n",
+				    code2Msg (result));
+		goto cleanup;
+	}
+
+	/* nodes by XROADS then id; same node from two ways of one name once */
+	if (table.count)
+		qsort (table.nodes, table.count, sizeof(NODE_GPS), compareOwnerNode);
+
+	for (iCount = 0; iCount < table.count; iCount++){
+
+		node = &table.nodes[iCount];
+		xrds = &(*batch)->xrds[node->owner];
+
+		if (iCount && node->owner == node[-1].owner && node->id == node[-1].id)
+
+			continue;
+
+		if (xrds->nodesNum < MAX_NODES)
+			*(xrds->nodesGPS[xrds->nodesNum++]) = node->gps;
+	}
+
+	for (iCount = 0; iCount < (*batch)->count; iCount++){
+
+		xrds = &(*batch)->xrds[iCount];
+
+		if (xrds->nodesNum){
+
+			gpsCentroid (xrds->midGps, xrds->nodesGPS, xrds->nodesNum);
+			xrds->point->gps = *(xrds->midGps);
+		}
+
+		xrds->status = XRDS_RESOLVED;
+	}
+
+	printf ("crossingsGetXrdsDL(): [ %d ] crossings found for [ %d ] streets.\n",
+			   (*batch)->count, numStreets);
+
+cleanup:
+
+	if (result != ztSuccess && *batch){
+
+		destroyDL (xrdsDL); // holds XROADS from batch
+
+		zapXrdsBatch ((void **) batch);
+	}
+
+	closeQuery (handle);
+
+	if (table.nodes)
+		free (table.nodes);
+
+	return result;
+
+} // END crossingsGetXrdsDL()
@@ -20,6 +20,7 @@
 #include <sys/time.h>   /* gettimeofday() */
 #include <ctype.h>	//toupper()
 #include <sys/wait.h>
+#include <fcntl.h>
 
 #include "util.h"
 #include "ztError.h"
@@ -510,14 +511,13 @@ char* myFgets(char *strDest, int count, FILE *fPtr, int *lineNum){
 	char 	SPACE = '\040';
 	char 	TAB   = '\t';
 	//char *rvalue;
-	char 	*str;
+	char 	*str = strDest;
 
-	str = (char *) malloc(sizeof(char) * LONG_LINE);
-	memset (str, 0, LONG_LINE);
+	/* read one line at a time, if we fail, then file ends prematurely;
+	 * read straight into strDest, no buffer of our own */
+	while(fgets(strDest, count, fPtr)) {
 
-
-	/* read one line at a time, if we fail, then file ends prematurely */
-	while(fgets(str, count, fPtr)) {
+		str = strDest;
 
 		(*lineNum)++; // increment line count
 
@@ -558,7 +558,9 @@ char* myFgets(char *strDest, int count, FILE *fPtr, int *lineNum){
 	}
 *****************************************************************/
 
-	strcpy (strDest, str);
+	if (str != strDest)
+
+		memmove (strDest, str, strlen(str) + 1);
 
 	return strDest;
 
@@ -686,6 +688,70 @@ int spawnWait (char *prog, char **argsList){
 	}
 }
 
+/* spawnPipes(): like mySpawn() with child stdin and stdout on pipes; toChild
+ * is set to write end of child stdin, fromChild to read end of child stdout,
+ * both non blocking for use with poll(). Pipe ends are closed on exec, so
+ * children do not hold pipes of each other. Child leads its own process
+ * group; kill(-pid) stops it with all it started. Child exits with 127 when
+ * execv fails. Returns child PID or -1 on error - pipes are closed then.
+ * *************************************************************************/
+pid_t spawnPipes (char *prgName, char **argLst, int *toChild, int *fromChild){
+
+	pid_t	childPID;
+	int		inPipe[2], outPipe[2];
+
+	ASSERTARGS (prgName && argLst && toChild && fromChild);
+
+	if (pipe (inPipe) != 0)
+
+		return -1;
+
+	if (pipe (outPipe) != 0){
+		close (inPipe[0]);
+		close (inPipe[1]);
+		return -1;
+	}
+
+	fcntl (inPipe[0], F_SETFD, FD_CLOEXEC);
+	fcntl (inPipe[1], F_SETFD, FD_CLOEXEC);
+	fcntl (outPipe[0], F_SETFD, FD_CLOEXEC);
+	fcntl (outPipe[1], F_SETFD, FD_CLOEXEC);
+
+	childPID = fork();
+
+	if (childPID == 0){   /* this is the child process */
+
+		setpgid (0, 0);
+
+		if (dup2 (inPipe[0], STDIN_FILENO) < 0 || dup2 (outPipe[1], STDOUT_FILENO) < 0)
+
+			_exit (127);
+
+		execv (prgName, argLst);
+
+		fprintf (stderr, "spawnPipes(): an error occurred in execv for <%s>: %s\n",
+				    prgName, strerror (errno));
+		_exit (127);
+	}
+
+	close (inPipe[0]);
+	close (outPipe[1]);
+
+	if (childPID < 0){
+		close (inPipe[1]);
+		close (outPipe[0]);
+		return -1;
+	}
+
+	fcntl (inPipe[1], F_SETFL, fcntl (inPipe[1], F_GETFL) | O_NONBLOCK);
+	fcntl (outPipe[0], F_SETFL, fcntl (outPipe[0], F_GETFL) | O_NONBLOCK);
+
+	*toChild = inPipe[1];
+	*fromChild = outPipe[0];
+
+	return childPID;
+}
+
 /* myGetDirDL() function to read directory and place entries in sorted list.
  * The returned list WILL INCLUDE the full entry path.
  * This function will NOT include the dot OR double dot entries.
@@ -939,3 +1005,133 @@ FILE* openOutputFile (char *filename){
 	return fPtr;
 
 } // END openOutputFile()
+
+/* initialArena(): initials arena, blocks are allocated on first use.
+ * blockSize zero uses ARENA_BLOCK_SIZE.
+ *************************************************************************/
+void initialArena (ARENA *arena, size_t blockSize){
+
+	ASSERTARGS (arena);
+
+	arena->head = NULL;
+	arena->blockSize = blockSize ? blockSize : ARENA_BLOCK_SIZE;
+
+	return;
+}
+
+#define ARENA_ROUND(n) (((n) + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1))
+
+/* arenaAlloc(): returns size bytes from arena - aligned to ARENA_ALIGN -
+ * adding a new block when head block is full. With NULL arena, this is
+ * malloc(). Returns NULL on allocation error.
+ *************************************************************************/
+void *arenaAlloc (ARENA *arena, size_t size){
+
+	ARENA_BLOCK	*block;
+	size_t		blockSize;
+	void			*ptr;
+
+	if ( ! arena )
+
+		return malloc (size);
+
+	size = ARENA_ROUND(size ? size : 1);
+
+	block = arena->head;
+	if ( ! block || block->used + size > block->size ){
+
+		blockSize = MAX(arena->blockSize, size);
+
+		block = (ARENA_BLOCK *) malloc (ARENA_ROUND(sizeof(ARENA_BLOCK)) + blockSize);
+		if ( ! block ){
+			fprintf(stderr, "arenaAlloc(): Error allocating memory.\n");
+			return NULL;
+		}
+
+		block->size = blockSize;
+		block->used = 0;
+		block->next = arena->head;
+		arena->head = block;
+	}
+
+	ptr = (char *) block + ARENA_ROUND(sizeof(ARENA_BLOCK)) + block->used;
+	block->used += size;
+
+	return ptr;
+}
+
+/* arenaStrdup(): strdup() into arena, strdup() with NULL arena */
+char *arenaStrdup (ARENA *arena, const char *str){
+
+	char		*copy;
+	size_t	length;
+
+	ASSERTARGS (str);
+
+	if ( ! arena )
+
+		return strdup (str);
+
+	length = strlen (str) + 1;
+
+	copy = (char *) arenaAlloc (arena, length);
+	if (copy)
+		memcpy (copy, str, length);
+
+	return copy;
+}
+
+/* resetArena(): releases all memory taken from arena in one shot; keeps
+ * one block for reuse. Pointers from arena are no good after this.
+ *************************************************************************/
+void resetArena (ARENA *arena){
+
+	ARENA_BLOCK	*block;
+
+	ASSERTARGS (arena);
+
+	if ( ! arena->head )
+
+		return;
+
+	/* keep the oldest block - last in chain */
+	while (arena->head->next){
+
+		block = arena->head;
+		arena->head = block->next;
+		free (block);
+	}
+
+	arena->head->used = 0;
+
+	return;
+}
+
+/* zapArena(): frees all arena blocks */
+void zapArena (ARENA *arena){
+
+	ARENA_BLOCK	*block;
+
+	ASSERTARGS (arena);
+
+	while (arena->head){
+
+		block = arena->head;
+		arena->head = block->next;
+		free (block);
+	}
+
+	return;
+}
+
+/* nowMs(): monotonic clock in milliseconds; for timing and waits only, it
+ * has nothing to do with time of day.
+ */
+double nowMs (void){
+
+	struct timespec	now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+
+	return (double) now.tv_sec * 1000.0 + (double) now.tv_nsec / 1.0e6;
+}
@@ -25,13 +25,20 @@
 #include "curl_func.h"
 #include "op_string.h"
 #include "help.h"
+#include "multiQuery.h"
+#include "cache.h"
+#include "sink.h"
+#include "osmFile.h"
+#include "streetQuery.h"
+#include "nameIndex.h"
+#include "endpoint.h"
+#include "adaptive.h"
 
 // prog_name is global
 const char *prog_name;
 FILE *rawDataFP = NULL;
 
 // function prototype
-static int appendToDL (DL_LIST *dest, DL_LIST *src);
 
 int main(int argc, char* const argv[]) {
 
@@ -40,13 +47,32 @@ int main(int argc, char* const argv[]) {
 				progDir[PATH_MAX] = {0}; // program output directory
 
 	// getopt_long() variables
-	const 	char*	const	shortOptions = "ho:r:W:f";
+	const 	char*	const	shortOptions = "ho:r:W:fj:q:bnRt:F:O:sgcdS:C:T:D:HAE:";
 	const	struct	option	longOptions[] = {
 			{"help", 		0, NULL, 'h'},
 			{"output", 	1, NULL, 'o'},
 			{"raw-data", 1, NULL, 'r'},
 			{"WKT", 1, NULL, 'W'},
 			{"force", 0, NULL, 'f'},
+			{"jobs", 1, NULL, 'j'},
+			{"rate", 1, NULL, 'q'},
+			{"batch", 0, NULL, 'b'},
+			{"no-cache", 0, NULL, 'n'},
+			{"refresh", 0, NULL, 'R'},
+			{"cache-ttl", 1, NULL, 't'},
+			{"format", 1, NULL, 'F'},
+			{"osm-file", 1, NULL, 'O'},
+			{"streets", 0, NULL, 's'},
+			{"grid", 0, NULL, 'g'},
+			{"crossings", 0, NULL, 'c'},
+			{"dictionary", 0, NULL, 'd'},
+			{"server", 1, NULL, 'S'},
+			{"servers", 1, NULL, 'C'},
+			{"timeout", 1, NULL, 'T'},
+			{"deadline", 1, NULL, 'D'},
+			{"hedge", 0, NULL, 'H'},
+			{"adaptive", 0, NULL, 'A'},
+			{"exec", 1, NULL, 'E'},
 			{NULL, 0, NULL, 0}
 
 	};
@@ -55,27 +81,43 @@ int main(int argc, char* const argv[]) {
 	char			**argvPtr;
 	int			nextOption;
 	int			overWrite = 0;	  // do not over write existing file
+	char			*endPtr;
+	double		seconds;
+	int			jobsGiven = 0;
+
+	RESOLVE_OPTIONS	resolveOpts = {.schedule.jobs = 1, .done = emitDone};
+	XRDS_CACHE		cache;
+	XRDS_CACHE		memo;
+	int				useCache = 1;
+	long				cacheDays = CACHE_TTL_DAYS;
+	char				*cacheFileName = NULL;
 
 	char			*outputFileName = NULL;
 	char			*rawDataFileName = NULL;
 	char			*wktFileName = NULL;
-
-	char			*service_url,
-					*serverOnly,
-					*proto,
-					*ipBuf;
-	int			reachable;
+	char			*osmFileName = NULL;
+	OSM_DATA		osmData;
+	STREET_CACHE	streetCache;
+	NAME_INDEX	nameIndex;
+	int			crossingsMode = 0;
+	char			**streetNames; // crossings mode input
+	int			numStreets;
+	ARENA		namesArena;
+
+	ENDPOINT_POOL	endpoints; // Overpass servers
+	CURLU		*url = NULL; // server for single queries, owned by endpoints
 
 	char				*infile;
-	DL_LIST		*infileList; // data pointer in element is to LINE_INFO
-	DL_ELEM		*elem;
-	LINE_INFO	*lineInfo;
-	char				*myString;
+	MAPPED_FILE	mappedFile = {0};
+	LINE_VIEW	lineView;
+	int			numLines;
 	BBOX			bbox;
 	XROADS		*xrds;
-	DL_LIST		*xrdsList; // data pointer in element is to XROADS
-	DL_LIST		*xrdsSessionDL; // session list of XROADS
-	DL_LIST		*wktDL;
+	DL_LIST		*xrdsList = NULL; // data pointer in element is to XROADS
+	XRDS_BATCH	*xrdsBatch = NULL; // owns XROADS of current file
+	OUTPUT_SINKS	sinks; // terminal and output files
+	XRDS_EMITTER	emitter;
+	SINK_KIND	outputFormat = SINK_TEXT;
 
 	FILE		*outputFilePtr = NULL;
 	FILE		*wktFilePtr = NULL;
@@ -84,19 +126,17 @@ int main(int argc, char* const argv[]) {
 
 	char		*wktNameOnly;
 	char 	*wktMidGpsName = NULL;
-	char		*wktBboxName;
+	char		*wktBboxName = NULL;
 	char		tmpBuf[PATH_MAX];
 	FILE		*wktMidGpsFilePtr = NULL;
 	FILE		*wktBboxFilePtr = NULL;
-	DL_LIST	*bboxWktDL;
-	DL_LIST	*mgWktList;
-//	DL_LIST	*mgWktSessionList;
-
-	char		*bboxWktStr;
 
 	/* set prog_name .. lastOfPath() might get called with a path */
 	prog_name = lastOfPath (argv[0]);
 
+	initialEndpointPool (&endpoints);
+	initialSinks (&sinks);
+
 	/* missing required argument - show usage, exit with ztMissingArgError */
 	if (argc < 2)
 
@@ -131,7 +171,7 @@ int main(int argc, char* const argv[]) {
 		case 'h': // show help and exit.
 
 			printHelp(stdout);
-			return ztSuccess;
+			goto cleanup;
 			break;
 
 /*		case 'v':
@@ -143,6 +183,159 @@ int main(int argc, char* const argv[]) {
 			overWrite = 1;
 			break;
 
+		case 'b':
+
+			resolveOpts.batchMode = 1;
+			break;
+
+		case 's':
+
+			initialStreetCache (&streetCache);
+			resolveOpts.streets = &streetCache;
+			break;
+
+		case 'g':
+
+			resolveOpts.gridMode = 1;
+			break;
+
+		case 'c':
+
+			crossingsMode = 1;
+			break;
+
+		case 'd':
+
+			initialNameIndex (&nameIndex);
+			resolveOpts.names = &nameIndex;
+			break;
+
+		case 'n':
+
+			useCache = 0;
+			break;
+
+		case 'R':
+
+			resolveOpts.refresh = 1;
+			break;
+
+		case 't':
+
+			cacheDays = strtol (optarg, &endPtr, 10);
+			if (*endPtr != '\0' || cacheDays < 0){
+				fprintf (stderr, "%s: Error invalid cache time to live in days: <%s>\n",
+						    prog_name, optarg);
+				retCode = ztInvalidArg;
+				goto cleanup;
+			}
+			break;
+
+		case 'j':
+
+			resolveOpts.schedule.jobs = (int) strtol (optarg, &endPtr, 10);
+			if (*endPtr != '\0' || resolveOpts.schedule.jobs < 1 ||
+				resolveOpts.schedule.jobs > MAX_JOBS){
+				fprintf (stderr, "%s: Error invalid number of jobs: <%s>; "
+						    "expected a number from 1 to %d.\n",
+						    prog_name, optarg, MAX_JOBS);
+				retCode = ztInvalidArg;
+				goto cleanup;
+			}
+			jobsGiven = 1;
+			break;
+
+		case 'q':
+
+			resolveOpts.schedule.rate = strtod (optarg, &endPtr);
+			if (*endPtr != '\0' || resolveOpts.schedule.rate <= 0 ||
+				resolveOpts.schedule.rate > MAX_RATE){
+				fprintf (stderr, "%s: Error invalid query rate: <%s>; "
+						    "expected queries per second more than 0 up to %d.\n",
+						    prog_name, optarg, MAX_RATE);
+				retCode = ztInvalidArg;
+				goto cleanup;
+			}
+			break;
+
+		case 'T':
+
+			seconds = strtod (optarg, &endPtr);
+			if (*endPtr != '\0' || seconds < 0 || seconds > MAX_QUERY_SECONDS){
+				fprintf (stderr, "%s: Error invalid query timeout: <%s>; "
+						    "expected seconds from 0 - no limit - up to %d.\n",
+						    prog_name, optarg, MAX_QUERY_SECONDS);
+				retCode = ztInvalidArg;
+				goto cleanup;
+			}
+			setQueryTimeout ((long) (seconds * 1000));
+			break;
+
+		case 'D':
+
+			seconds = strtod (optarg, &endPtr);
+			if (*endPtr != '\0' || seconds <= 0){
+				fprintf (stderr, "%s: Error invalid run deadline: <%s>; "
+						    "expected seconds more than 0.\n", prog_name, optarg);
+				retCode = ztInvalidArg;
+				goto cleanup;
+			}
+			/* run time starts now */
+			resolveOpts.schedule.deadline = nowMs () + seconds * 1000;
+			break;
+
+		case 'H':
+
+			resolveOpts.schedule.hedge = 1;
+			break;
+
+		case 'A':
+
+			resolveOpts.schedule.adaptive = 1;
+			break;
+
+		case 'E':
+
+			resolveOpts.execPath = optarg;
+			break;
+
+		case 'F':
+
+			outputFormat = sinkKind (optarg);
+			if ( ! outputFormat ){
+				fprintf (stderr, "%s: Error invalid output format: <%s>; "
+						    "expected text, csv, ndjson or binary.\n",
+						    prog_name, optarg);
+				retCode = ztInvalidArg;
+				goto cleanup;
+			}
+			break;
+
+		case 'S':
+
+			result = addEndpoint (&endpoints, optarg);
+			if (result != ztSuccess){
+				fprintf (stderr, "%s: Error invalid server: <%s>\n", prog_name, optarg);
+				retCode = result;
+				goto cleanup;
+			}
+			break;
+
+		case 'C':
+
+			result = readEndpointFile (&endpoints, optarg);
+			if (result != ztSuccess){
+				fprintf (stderr, "%s: Error reading servers file: <%s>\n", prog_name, optarg);
+				retCode = result;
+				goto cleanup;
+			}
+			break;
+
+		case 'O':
+
+			osmFileName = optarg;
+			break;
+
 		case 'o':
 
 			/* optarg points at output file name; note that more testing
@@ -234,19 +427,9 @@ int main(int argc, char* const argv[]) {
 		shortUsage(stderr, ztMissingArgError);
 	}
 
-	/* No server -> no service! I do this after getopt_long() to enable the help
-	 * option when we do not have a connection to server!
-	 * Can we connect to Overpass server?
-	 * parse the SERVICE_URL
-	 * Note that there is a libcurl function doing the same thing!
-	 * curl_url_get() was added in version 7.62.0
-	 */
-	service_url = strdup (SERVICE_URL);
-	if ( ! service_url ){
-		fprintf(stderr, "%s error: Got NULL from strdup() function.\n", prog_name);
-		retCode = ztGotNull;
-		goto cleanup;
-	}
+	/* jobs is the most in flight with adaptive */
+	if (resolveOpts.schedule.adaptive && ! jobsGiven)
+		resolveOpts.schedule.jobs = ADAPT_DEFAULT_JOBS;
 
 	/* use CURL parser. initial curl session checks version number */
 	result = initialSession();
@@ -256,52 +439,58 @@ int main(int argc, char* const argv[]) {
 		goto cleanup;
 	}
 
-	CURLU *url = initialURL (service_url);
-	CURLUcode rc;
-
-	if (  ! url ){
-		fprintf(stderr, "%s error: Got NULL from initialURL() function.\n", prog_name);
-		retCode = ztGotNull;
-		goto cleanup;
-	}
+	/* local query program answers pair queries only; other modes query
+	 * the server themselves */
+	if (resolveOpts.execPath){
 
-	/* get serverOnly and proto */
-	rc = curl_url_get (url, CURLUPART_HOST, &serverOnly, 0);
-	if (rc != CURLUE_OK){
+		if (osmFileName || resolveOpts.batchMode || resolveOpts.streets ||
+			resolveOpts.gridMode || crossingsMode || resolveOpts.names){
+			fprintf (stderr, "%s: Error exec option can not be used with --osm-file, --batch, "
+					    "--streets, --grid, --crossings or --dictionary.\n", prog_name);
+			retCode = ztInvalidArg;
+			goto cleanup;
+		}
 
-		fprintf(stderr, "%s: Could get server name, curl_url_get() failed: %s\n",
-				      prog_name, curl_url_strerror(rc));
-		retCode = ztParseError;
-		goto cleanup;
+		if (access (resolveOpts.execPath, X_OK) != 0){
+			fprintf (stderr, "%s: Error query program <%s> is not executable: %s\n",
+					    prog_name, resolveOpts.execPath, strerror (errno));
+			retCode = ztInvalidArg;
+			goto cleanup;
+		}
 	}
 
-	rc = curl_url_get (url, CURLUPART_SCHEME, &proto, 0);
-	if (rc != CURLUE_OK){
+	/* No server -> no service! I do this after getopt_long() to enable the help
+	 * option when we do not have a connection to server!
+	 * Can we connect to Overpass server(s)? Servers are from server and
+	 * servers options, SERVICE_URL when none is given. Unreachable ones
+	 * start ejected, see endpoint.c
+	 * With local OSM file or query program there is no server to check.
+	 */
+	if ( ! osmFileName && ! resolveOpts.execPath ){
 
-		fprintf(stderr, "%s: Could get proto, curl_url_get() failed: %s\n",
-				      prog_name, curl_url_strerror(rc));
-		retCode = ztParseError;
-		goto cleanup;
-	}
+		if (endpoints.count == 0){
 
-	result = checkURL (serverOnly , proto, &ipBuf); /* network.c */
-	reachable = (result == ztSuccess);
-	if ( ! reachable ){
+			result = addEndpoint (&endpoints, SERVICE_URL);
+			if (result != ztSuccess){
+				fprintf(stderr, "%s error: Could not use server URL: %s\n", prog_name, SERVICE_URL);
+				retCode = result;
+				goto cleanup;
+			}
+		}
 
-		fprintf(stderr, "%s: Error SERVER: (%s) is NOT reachable.\n",
-				     prog_name, serverOnly);
-		fprintf(stderr, " The error was: %s\n", code2Msg(result));
+		result = checkEndpoints (&endpoints);
+		if (result != ztSuccess){
 
-		retCode = result;
-		goto cleanup;
-	}
+			fprintf(stderr, "%s: Error no SERVER is reachable.\n", prog_name);
+			fprintf(stderr, " The error was: %s\n", code2Msg(result));
 
-	if (ipBuf)
-		free(ipBuf); // it was needed just for function call.
+			retCode = result;
+			goto cleanup;
+		}
+
+		resolveOpts.schedule.pool = &endpoints;
 
-	/* no longer need both serverOnly and proto */
-	curl_free(serverOnly);
-	curl_free(proto);
+	} // end if ( ! osmFileName && ! execPath )
 
 	// do not over write existing output file, unless force was used
 	if ( outputFileName &&
@@ -326,30 +515,88 @@ int main(int argc, char* const argv[]) {
 			fprintf(stderr, "%s error: input file <%s> is Not usable file!\n",
 					    prog_name, *argvPtr);
 			fprintf(stderr, " The error was: %s\n", code2Msg(result));
-			return result;
+			retCode = result;
+			goto cleanup;
 		}
 
 		/* do not overwrite an INPUT file ANYTIME */
 		if (outputFileName && (strcmp(*argvPtr, outputFileName) == 0)){
 			fprintf(stderr, "%s Error: Can not write output to an input file: <%s>\n\n",
 					prog_name, *argvPtr);
-			return ztInvalidArg;
+			retCode = ztInvalidArg;
+			goto cleanup;
 		}
 		if (rawDataFileName && (strcmp(*argvPtr, rawDataFileName) == 0)){
 			fprintf(stderr, "%s Error: Can not write raw data to an input file: <%s>\n\n",
 					prog_name, *argvPtr);
-			return ztInvalidArg;
+			retCode = ztInvalidArg;
+			goto cleanup;
 		}
 		if (wktFileName && (strcmp(*argvPtr, wktFileName) == 0)){
 			fprintf(stderr, "%s Error: Can not write WKT to an input file: <%s>\n\n",
 					prog_name, *argvPtr);
-			return ztInvalidArg;
+			retCode = ztInvalidArg;
+			goto cleanup;
 		}
 
 		argvPtr++; // move to next argv
 
 	} // end  while () check all files
 
+	/* progress lines are written to stdout, so only text goes there */
+	if (outputFormat != SINK_TEXT && ! outputFileName){
+		fprintf (stderr, "%s: Error %s format needs output file; use --output option.\n",
+				    prog_name, outputFormat == SINK_BINARY ? "binary" :
+				    (outputFormat == SINK_CSV ? "csv" : "ndjson"));
+		retCode = ztInvalidArg;
+		goto cleanup;
+	}
+
+	/* local OSM file answers all queries; cache is keyed by server query
+	 * and raw data is server response - neither is used with it */
+	if (osmFileName){
+
+		if (rawDataFileName){
+			fprintf (stderr, "%s: Error raw data option can not be used with --osm-file.\n",
+					    prog_name);
+			retCode = ztInvalidArg;
+			goto cleanup;
+		}
+
+		result = IsArgUsableFile (osmFileName);
+		if (result != ztSuccess){
+			fprintf(stderr, "%s error: OSM file <%s> is Not usable file!\n",
+					    prog_name, osmFileName);
+			fprintf(stderr, " The error was: %s\n", code2Msg(result));
+			retCode = result;
+			goto cleanup;
+		}
+
+		result = loadOsmFile (&osmData, osmFileName);
+		if (result != ztSuccess){
+			fprintf (stderr, "%s: Error failed loadOsmFile(): %s\n", prog_name, osmFileName);
+			retCode = result;
+			goto cleanup;
+		}
+
+		resolveOpts.osm = &osmData;
+		useCache = 0;
+
+		/* names are checked by OSM file engine itself */
+		if (resolveOpts.names){
+			zapNameIndex (resolveOpts.names);
+			resolveOpts.names = NULL;
+		}
+	}
+
+	/* crossings are found by server query, not from pairs */
+	if (crossingsMode && (osmFileName || resolveOpts.gridMode)){
+		fprintf (stderr, "%s: Error crossings option can not be used with --osm-file "
+				    "or --grid.\n", prog_name);
+		retCode = ztInvalidArg;
+		goto cleanup;
+	}
+
 	// open output file(s) for writing when name is set
 
 	if (outputFileName) {
@@ -358,7 +605,8 @@ int main(int argc, char* const argv[]) {
 		if ( ! outputFilePtr) {
 			fprintf (stderr, "%s: Error opening output file: <%s>\n",
 					      prog_name, outputFileName);
-			return ztOpenFileError;
+			retCode = ztOpenFileError;
+			goto cleanup;
 		}
 	}
 
@@ -376,28 +624,32 @@ int main(int argc, char* const argv[]) {
 
 			fprintf(stderr, "%s Error: Same file name used for output option and wktFileName: <%s>\n\n",
 					prog_name, wktFileNameExt);
-			return ztInvalidArg;
+			retCode = ztInvalidArg;
+			goto cleanup;
 		}
 
 		wktFilePtr = openOutputFile (wktFileNameExt);
 		if ( ! wktFilePtr) {
 			fprintf (stderr, "%s: Error opening WKT output file: <%s>\n",
 			             prog_name, wktFileName);
-			return ztOpenFileError;
+			retCode = ztOpenFileError;
+			goto cleanup;
 		}
 
 		wktBboxFilePtr = openOutputFile (wktBboxName);
 		if ( ! wktBboxFilePtr) {
 			fprintf (stderr, "%s: Error opening WKT output file: <%s>\n",
 			             prog_name, wktBboxName);
-			return ztOpenFileError;
+			retCode = ztOpenFileError;
+			goto cleanup;
 		}
 
 		wktMidGpsFilePtr = openOutputFile (wktMidGpsName);
 		if ( ! wktMidGpsFilePtr) {
 			fprintf (stderr, "%s: Error opening WKT output file: <%s>\n",
 			             prog_name, wktMidGpsName);
-			return ztOpenFileError;
+			retCode = ztOpenFileError;
+			goto cleanup;
 		}
 
 	}
@@ -408,76 +660,96 @@ int main(int argc, char* const argv[]) {
 		if ( ! rawDataFP ) {
 			fprintf (stderr, "%s: Error opening raw data output file: <%s>\n",
 					     prog_name, rawDataFileName);
-			return ztOpenFileError;
+			retCode = ztOpenFileError;
+			goto cleanup;
 		}
 	}
 
-	/* initial a list for the session - this is a XROADS list,
-	 * data in element is a pointer to XROADS */
-	xrdsSessionDL = (DL_LIST *) malloc(sizeof(DL_LIST));
-	if (xrdsSessionDL == NULL){
-		fprintf(stderr, "%s: Error allocating memory.\n", prog_name);
-		return ztMemoryAllocate;
-	}
-	initialDL (xrdsSessionDL, zapXrds, NULL);
+	/* result cache lives in program output directory */
+	if (useCache){
 
-	if (wktFilePtr){
+		result = initialCache (&cache, CACHE_INITIAL_SIZE,
+				                        (time_t) cacheDays * SECONDS_PER_DAY);
+		if (result != ztSuccess){
+			fprintf (stderr, "%s: Error failed initialCache().\n", prog_name);
+			retCode = result;
+			goto cleanup;
+		}
 
-		bboxWktDL = (DL_LIST *) malloc(sizeof(DL_LIST));
-		if ( ! bboxWktDL ){
-			fprintf(stderr, "%s: Error allocating memory for bboxWktDL.\n",
-					prog_name);
-			return ztMemoryAllocate;
+		resolveOpts.cache = &cache;
+
+		mkOutputFile (&cacheFileName, CACHE_FILE_NAME, progDir);
+
+		result = openCacheFile (&cache, cacheFileName);
+		if (result != ztSuccess){
+			fprintf (stderr, "%s: Error opening cache file: <%s>\n",
+					    prog_name, cacheFileName);
+			retCode = result;
+			goto cleanup;
 		}
-		initialDL (bboxWktDL, zapString, NULL);
-		/* insert wkt; as first line */
-		insertNextDL (bboxWktDL, DL_TAIL(bboxWktDL), "wkt;");
 
 	}
 
+	/* results from this run, for pairs repeated in or across input files */
+	result = initialCache (&memo, CACHE_INITIAL_SIZE, 0);
+	if (result != ztSuccess){
+		fprintf (stderr, "%s: Error failed initialCache().\n", prog_name);
+		retCode = result;
+		goto cleanup;
+	}
+
+	resolveOpts.memo = &memo;
+
+	/* each XROADS is written to all outputs as soon as it and all XROADS
+	 * before it are resolved; result is always shown in terminal, as text
+	 * when output file is used */
+	if (outputFilePtr){
+		addSink (&sinks, SINK_TEXT, stdout);
+		addSink (&sinks, outputFormat, outputFilePtr);
+	}
+	else
+		addSink (&sinks, outputFormat, stdout);
+
+	if (wktFilePtr){
+		addSink (&sinks, SINK_WKT, wktFilePtr);
+		addSink (&sinks, SINK_BBOX, wktBboxFilePtr);
+		addSink (&sinks, SINK_MIDGPS, wktMidGpsFilePtr);
+	}
+
+	/* sinks close their files now */
+	outputFilePtr = wktFilePtr = wktBboxFilePtr = wktMidGpsFilePtr = NULL;
+
+	resolveOpts.doneData = &emitter;
+
 	/* done setting & parsing, now process each input file */
 	argvPtr = (char **) (argv + optind);
 
 	while (*argvPtr){
 
 		infile = *argvPtr;
-		/* initial file list - this is a string list (LineInfo really),
-		 * data pointer in element is a pointer to LineInfo structure */
-		infileList = (DL_LIST *) malloc(sizeof(DL_LIST));
-		if (infileList == NULL){
-			fprintf(stderr, "%s: Error allocating memory.\n", prog_name);
-			return ztMemoryAllocate;
-		}
 
-		initialDL (infileList, zapLineInfo, NULL);
-
-		/* file2List() function fills the list with lines from text file,
-		   ignoring lines starting with # and ; */
-		result = file2List(infileList, infile);
+		/* input file is mapped into memory and read in place, lines are
+		 * returned as views - no copy of the file is made. Blank lines
+		 * and lines starting with # and ; are skipped */
+		result = openMappedFile (&mappedFile, infile);
 		if (result != ztSuccess){
-			fprintf(stderr, "%s: Error failed file2List(): %s \n",
+			fprintf(stderr, "%s: Error failed openMappedFile(): %s \n",
 					prog_name, infile);
-			fprintf (stderr, " The error from file2List() was: %s ... Exiting.\n",
+			fprintf (stderr, " The error from openMappedFile() was: %s ... Exiting.\n",
 					    code2Msg(result));
-			return result;
+			retCode = result;
+			goto cleanup;
 		}
 
-		// input file should have at least 2 lines: bbox + one cross road pair
-		if (DL_SIZE(infileList) < 2){
+		/* get bounding box line and parse it */
+		if ( ! nextLineView (&mappedFile, &lineView) ){
 			fprintf(stderr, "%s: Error empty or incomplete input file.\n", prog_name);
 			fprintf (stderr, "Please see input file format in help with: %s --help\n", prog_name);
 			retCode = ztMissFormatFile;
 			goto cleanup;
 		}
 
-		/* get bounding box string and parse it */
-		elem = DL_HEAD(infileList);
-		lineInfo = (LINE_INFO *) elem->data;
-
-		// get our own copy, since it gets mangled by strtok()
-		myString = strdup (lineInfo->string);
-
-		result = parseBbox (&bbox, myString);
+		result = parseBboxView (&bbox, &lineView);
 		if (result != ztSuccess){
 			fprintf(stderr, "%s: Error parsing BBOX!\n\n", prog_name);
 			fprintf(stderr, "Expected bounding box format:\n"
@@ -487,10 +759,11 @@ int main(int argc, char* const argv[]) {
 			goto cleanup;
 		}
 
-		if (wktBboxFilePtr){
-
-			formatBboxWKT(&bboxWktStr, &bbox);
-			insertNextDL (bboxWktDL, DL_TAIL(bboxWktDL), bboxWktStr);
+		result = sinkBbox (&sinks, &bbox);
+		if (result != ztSuccess){
+			fprintf(stderr, "%s: Error failed sinkBbox()!\n", prog_name);
+			retCode = result;
+			goto cleanup;
 		}
 
 		/* get cross road strings, parse them && stuff'em in a list */
@@ -501,326 +774,210 @@ int main(int argc, char* const argv[]) {
 			goto cleanup;
 		}
 
-		initialDL (xrdsList, zapXrds, NULL);
+		initialDL (xrdsList, NULL, NULL); // batch owns XROADS
+
+		/* single queries go to least busy healthy server */
+		if (resolveOpts.schedule.pool)
+			url = endpointURL (resolveOpts.schedule.pool);
 
-		// point at second line - this is the INPUT FILE list
-		elem = DL_NEXT(elem);
-		while (elem) {
+		if (crossingsMode){
 
-			lineInfo = (LINE_INFO*) elem->data;
+			/* street names only, XROADS are made from server answer */
+			initialArena (&namesArena, 0);
 
-			xrds = initialXrds(NULL, NULL); /* no street names yet */
-			if ( ! xrds ){
-				fprintf(stderr, "%s: Error failed initialXrds()!\n", prog_name);
+			result = namesParseFile (&streetNames, &numStreets, &namesArena, &mappedFile);
+			if (result == ztSuccess){
+
+				result = crossingsGetXrdsDL (&xrdsBatch, xrdsList, streetNames, numStreets,
+						                      &bbox, url);
+
+				/* failed query drops this file only, not the run */
+				if (result != ztSuccess && result != ztMemoryAllocate){
+					fprintf(stderr, "%s: Warning no street crossings for file: %s; "
+							   "going on with next file.\n", prog_name, infile);
+					retCode = result;
+					result = ztSuccess;
+				}
+			}
+
+			if (streetNames)
+				free (streetNames);
+			zapArena (&namesArena);
+
+			if (result != ztSuccess){
+				fprintf(stderr, "%s: Error failed to get street crossings !!!\n", prog_name);
+				retCode = result;
 				goto cleanup;
 			}
+		}
+		else if (resolveOpts.gridMode){
 
-			myString = strdup(lineInfo->string);
-			result = xrdsParseNames(xrds, myString);
-			if (result != ztSuccess) {
-				fprintf(stderr, "%s: Error parsing cross roads line # %d "
-						"from function xrdsParseNames().\n", prog_name,
-						lineInfo->originalNum);
-				return result;
+			/* grid input: NS and EW street lists, XROADS for every pair */
+			result = gridParseFile (&xrdsBatch, xrdsList, &mappedFile);
+			if (result != ztSuccess){
+				fprintf(stderr, "%s: Error parsing grid input file from function "
+						"gridParseFile().\n", prog_name);
+				retCode = result;
+				goto cleanup;
 			}
+		}
+		else {
 
-			// insert next to the end of the list
-			insertNextDL (xrdsList, DL_TAIL(xrdsList), xrds);
+			/* one batch holds all XROADS in this file; sized for every line
+			 * in file, names need at most whole file plus 2 terminating zeros
+			 * per line */
+			numLines = mappedLineCount (&mappedFile);
+			xrdsBatch = initialXrdsBatch (numLines, mappedFile.size + 2 * numLines);
+			if ( ! xrdsBatch ){
+				fprintf(stderr, "%s: Error failed initialXrdsBatch()!\n", prog_name);
+				retCode = ztMemoryAllocate;
+				goto cleanup;
+			}
 
-			elem = DL_NEXT(elem);
-		}// End while(elem)
+			// rest of the lines are cross roads
+			while (nextLineView (&mappedFile, &lineView)) {
 
-		result = curlGetXrdsDL (xrdsList, &bbox, url);
-		if (result != ztSuccess){
-			fprintf(stderr, "%s: Error failed curlGetXrdsDL() !!!\n", prog_name);
-			fprintf(stderr, "See FIRST error above ^^^^  exiting\n\n");
-			retCode = result;
+				result = xrdsParseView(&xrds, xrdsBatch, &lineView);
+				if (result != ztSuccess) {
+					fprintf(stderr, "%s: Error parsing cross roads line # %d "
+							"from function xrdsParseView().\n", prog_name,
+							lineView.lineNum);
+					retCode = result;
+					goto cleanup;
+				}
+
+				// insert next to the end of the list
+				insertNextDL (xrdsList, DL_TAIL(xrdsList), xrds);
+
+			}// End while(nextLineView)
+		}
+
+		closeMappedFile (&mappedFile);
+
+		// input file should have at least 2 lines: bbox + one cross road pair
+		if (DL_SIZE(xrdsList) == 0 && ! crossingsMode){
+			fprintf(stderr, "%s: Error empty or incomplete input file.\n", prog_name);
+			fprintf (stderr, "Please see input file format in help with: %s --help\n", prog_name);
+			retCode = ztMissFormatFile;
 			goto cleanup;
 		}
 
-		// append this file list to session list
-		result = appendToDL (xrdsSessionDL, xrdsList);
+		startEmitter (&emitter, &sinks, xrdsList);
+
+		/* crossings are resolved already, write them all */
+		if (crossingsMode && DL_SIZE(xrdsList))
+			emitDone ((XROADS *) DL_DATA(DL_HEAD(xrdsList)), &emitter);
+		else if ( ! crossingsMode )
+			result = resolveXrdsDL (xrdsList, &bbox, url, &resolveOpts);
+
 		if (result != ztSuccess){
-			fprintf(stderr, "%s: Error failed appendToDL() !!!\n", prog_name);
+			fprintf(stderr, "%s: Error failed to get cross roads GPS !!!\n", prog_name);
 			fprintf(stderr, "See FIRST error above ^^^^  exiting\n\n");
 			retCode = result;
 			goto cleanup;
 		}
 
+		// all XROADS in this file are written now
 		destroyDL (xrdsList);
 		free (xrdsList);
+		xrdsList = NULL;
+		zapXrdsBatch ((void **) &xrdsBatch);
 
 		argvPtr++; // next input file?
 
 	} // end  while (*argvPtr)
 
+	result = closeSinks (&sinks);
+	if (result != ztSuccess)
 
-	if (outputFilePtr) /* still show result in terminal */
-		writeDL (NULL, xrdsSessionDL, writeXrds);
-
-	writeDL (outputFilePtr, xrdsSessionDL, writeXrds);
-
-	if (wktFileName && wktFilePtr){
-
-		wktDL = (DL_LIST *) malloc (sizeof(DL_LIST));
-		initialDL(wktDL, zapString, NULL);
-		xrds2WKT_DL (wktDL, xrdsSessionDL);
-		writeDL (wktFilePtr, wktDL, writeString2FP);
+		retCode = result;
 
-		// should destroy list and free memory
+	if (wktFileName)
 		fprintf (stdout, "Wrote Well Known Text to file: %s\n", wktFileNameExt);
-		fclose (wktFilePtr);
-
-	}
-
-	if (outputFilePtr) {
 
+	if (outputFileName)
 		fprintf (stdout, "Wrote output to file: %s\n", outputFileName);
-		fclose (outputFilePtr);
-	}
-
-	if (wktMidGpsName && wktMidGpsFilePtr){
-
-		mgWktList = (DL_LIST *) malloc(sizeof(DL_LIST));
-		if ( ! mgWktList ){
-			fprintf(stderr, "%s: Error allocating memory for mgWktList.\n",
-					prog_name);
-			return ztMemoryAllocate;
-		}
-		initialDL (mgWktList, zapString, NULL);
-
-		midGps2WKT_DL (mgWktList, xrdsSessionDL);
-
-		writeDL (wktMidGpsFilePtr, mgWktList, writeString2FP);
 
+	if (wktFileName){
 		fprintf (stdout, "Wrote Mid-Point GPS Well Known Text to file: %s\n",
 				     wktMidGpsName);
-		fclose (wktMidGpsFilePtr);
-	}
-
-	if (wktBboxFilePtr){
-
-		writeDL (wktBboxFilePtr, bboxWktDL, writeString2FP);
-		// should destroy list and free memory too now
-		fclose (wktBboxFilePtr);
-
 		fprintf (stdout, "Wrote Bounding Box Polygon Well Known Text to file: %s\n",
 				     wktBboxName);
 	}
 
-	if (rawDataFP) {
-
+	if (rawDataFP)
 		fprintf (stdout, "Wrote raw data to file: %s\n", rawDataFileName);
-		fclose (rawDataFP);
-	}
 
-	closeSession(); /* close curl session */
+	if (endpoints.count > 1)
+		printEndpoints (&endpoints);
 
 cleanup:
-	if (home) {
-		free(home);
-		home = NULL;
-	}
-
-	if (outputFileName) {
-		free(outputFileName);
-		outputFileName = NULL;
-	}
-	if (service_url) {
-		free(service_url);
-		service_url = NULL;
-	}
-	if (myString) {
-		free(myString);
-		myString = NULL;
-	}
-	if (url) {
-		curl_url_cleanup(url);
-		url = NULL;
+	/* reached from any point above; releases only what was set up */
+	if (xrdsList){
+		destroyDL (xrdsList);
+		free (xrdsList);
 	}
+	zapXrdsBatch ((void **) &xrdsBatch);
+	closeMappedFile (&mappedFile);
 
-	return retCode;
-
-} // END main()
-
-/* srcDL is a double linked list with XROADS* as data pointer in ELEM,
- * error to be empty!
- * dstDL : initialed by caller.
- */
-int xrds2WKT_DL (DL_LIST *dstDL, DL_LIST *srcDL){
-
-	DL_ELEM	*elem;
-	XROADS	*xrds;
-	char			**wktStrArray;
-	char			**strMover;
-	char			*wktMaker = "wkt;";
-
-	ASSERTARGS (dstDL && srcDL);
-
-	if (DL_SIZE(srcDL) == 0)
-
-		return ztListEmpty;
-
-	// start the list with wkt maker
-	insertNextDL (dstDL, DL_TAIL(dstDL), wktMaker);
-
-	elem = DL_HEAD(srcDL);
-	while(elem){
-
-		xrds = (XROADS *) elem->data;
-		wktStrArray = (char **) malloc ((sizeof(char *)) * (xrds->nodesNum + 1));
-		if ( ! wktStrArray){
-			fprintf (stderr, "xrds2WKT_DL() Error: memory allocate!\n");
-			return ztMemoryAllocate;
-		}
-
-		xrds2WKT (wktStrArray, xrds); //check result TODO
-
-		strMover = wktStrArray;
-		while (*strMover){
-
-			insertNextDL (dstDL, DL_TAIL(dstDL), *strMover);
-			strMover++;
-		}
-
-		elem = DL_NEXT(elem);
-
-	} // end while(elem)
-
-	return ztSuccess;
-
-} // END xrds2WKT_DL()
-
-/* midGps2WKT_DL(): function formats midGps member into Well Known Text
- * from xrdsList and stores formatted string into destList. Caller initials destList.
- */
-int midGps2WKT_DL (DL_LIST *destList, DL_LIST *xrdsList){
-
-	DL_ELEM	*elem;
-	XROADS	*xrds;
-	char			*wktString;
-	char			*wktMaker = "wkt;";
-
-	ASSERTARGS (destList && xrdsList);
-
-	if (DL_SIZE(xrdsList) == 0)
-
-		return ztListEmpty;
-
-	// start the list with wkt maker
-	insertNextDL (destList, DL_TAIL(destList), wktMaker);
-
-	elem = DL_HEAD(xrdsList);
-	while(elem){
-
-		xrds = (XROADS *) elem->data;
-
-		if (xrds->nodesNum){
-
-			wktString = gps2WKT (xrds->midGps);
-			if ( ! wktString ){
-
-				fprintf(stderr, "midGps2WKT_DL(): Error retuned from gps2WKT(). Exit.\n");
-				return ztUnknownError;
-			}
-
-			insertNextDL (destList, DL_TAIL(destList), wktString);
-		}
-
-		elem = DL_NEXT(elem);
-
-	} // end while(elem)
+	if (sinks.num)
+		closeSinks (&sinks);
 
+	/* files opened before sinks were set up */
+	if (outputFilePtr)
+		fclose (outputFilePtr);
+	if (wktFilePtr)
+		fclose (wktFilePtr);
+	if (wktBboxFilePtr)
+		fclose (wktBboxFilePtr);
+	if (wktMidGpsFilePtr)
+		fclose (wktMidGpsFilePtr);
 
-	return ztSuccess;
-}
-
-/* appendDL () appends src list to dest list - assumes the data pointer in
- * element is for character string, no checking for that is done! */
-static int appendToDL (DL_LIST *dest, DL_LIST *src){
-
-	DL_ELEM	*srcElem;
-	XROADS	*srcXrds;
-	XROADS	*newXrds;
-	int			result;
-
-	ASSERTARGS (dest && src);
-
-	if (DL_SIZE(src) == 0)
-
-		return ztSuccess;
-
-	srcElem = DL_HEAD(src);
-	while (srcElem){
-
-		srcXrds = (XROADS *) DL_DATA(srcElem);
-
-		newXrds = initialXrds(NULL, NULL);
-		if ( ! newXrds ){
-			fprintf(stderr, "%s : appendToDL(): Error failed initialXrds().\n", prog_name);
-			return ztMemoryAllocate;
-		}
-
-		result = cpyXrds(newXrds, srcXrds);
-		if (result != ztSuccess){
-			fprintf(stderr, "%s : appendToDL(): Failed call to cpyXrds().\n", prog_name);
-			return result;
-		}
-
-		result = insertNextDL (dest, DL_TAIL(dest), newXrds);
-		if (result != ztSuccess){
-			fprintf(stderr, "%s : appendToDL(): Error returned from insertNextDL().\n", prog_name);
-			return result;
-		}
-
-		srcElem = DL_NEXT(srcElem);
-
+	if (rawDataFP) {
+		fclose (rawDataFP);
+		rawDataFP = NULL;
 	}
 
-	return ztSuccess;
-}
+	closeSession(); /* close curl session */
 
-int curlGetXrdsDL (DL_LIST *xrdsDL, BBOX *bbox, CURLU *srvrURL){
+	if (resolveOpts.cache)
+		closeCache (resolveOpts.cache);
 
-	DL_ELEM		*elem;
-	XROADS		*xrds;
-	int				result;
+	if (resolveOpts.memo)
+		closeCache (resolveOpts.memo);
 
-	//do not allow nulls
-	ASSERTARGS(xrdsDL && bbox && srvrURL);
+	if (resolveOpts.osm)
+		zapOsmData (resolveOpts.osm);
 
-	if(DL_SIZE(xrdsDL) == 0) // not even a warning
+	if (resolveOpts.streets)
+		zapStreetCache (resolveOpts.streets);
 
-		return ztSuccess;
+	if (resolveOpts.names)
+		zapNameIndex (resolveOpts.names);
 
-	/* one curl easy_handle being reused for the whole list. */
-	CURL	*myCurlHandle =  initialQuery (srvrURL);
-	if ( ! myCurlHandle){
-		fprintf(stderr, "curlGetXrdsDL(): Error returned from initialQuery().\n");
-		return ztGotNull;
+	if (home) {
+		free(home);
+		home = NULL;
 	}
 
-	elem = DL_HEAD(xrdsDL);
-	while(elem){
-
-		xrds = (XROADS *) elem->data;
-
-		/* getXrdsGps() fills GPS members in xrds structure */
-		result = getXrdsGps (xrds, bbox, srvrURL, myCurlHandle);
-		if (result != ztSuccess){
-			fprintf(stderr, "curlGetXrdsDL(): Error returned from getXrdsGps() function\n\n");
-			return result;
-		}
-//printXrds(xrds);
-
-		elem = DL_NEXT(elem);
-
-	} //end while(elem)
-
-	easyCleanup (myCurlHandle);
+	if (outputFileName) {
+		free(outputFileName);
+		outputFileName = NULL;
+	}
 
-	return ztSuccess;
+	if (cacheFileName)
+		free (cacheFileName);
+	if (rawDataFileName)
+		free (rawDataFileName);
+	if (wktFileName)
+		free (wktFileName);
+	if (wktMidGpsName)
+		free (wktMidGpsName);
+	if (wktBboxName)
+		free (wktBboxName);
 
-} // END curlGetXrdsDL()
+	zapEndpointPool (&endpoints);
 
+	return retCode;
 
+} // END main()